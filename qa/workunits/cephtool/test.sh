@@ -2346,6 +2346,12 @@ function test_mon_osd_pool_set()
   ceph osd pool set $TEST_POOL_GETSET compression_required_ratio 0
   ceph osd pool get $TEST_POOL_GETSET compression_required_ratio | expect_false grep '.'
 
+  # no zstd dictionaries are loaded by the monitors
+  expect_false ceph osd pool set $TEST_POOL_GETSET compression_dict_id foo
+  expect_false ceph osd pool set $TEST_POOL_GETSET compression_dict_id -1
+  expect_false ceph osd pool set $TEST_POOL_GETSET compression_dict_id 4242
+  ceph osd pool set $TEST_POOL_GETSET compression_dict_id 0
+
   ceph osd pool get $TEST_POOL_GETSET csum_type | expect_false grep '.'
   ceph osd pool set $TEST_POOL_GETSET csum_type crc32c
   ceph osd pool get $TEST_POOL_GETSET csum_type | grep 'crc32c'
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+set -ex
+
+# this test uses fault injection to fail bucket index prepares during
+# 'radosgw-admin object rewrite'
+
+#assume working ceph environment (radosgw-admin in path) and rgw on localhost:80
+# localhost::443 for ssl
+
+mydir=`dirname $0`
+
+python3 -m venv $mydir
+source $mydir/bin/activate
+pip install pip --upgrade
+pip install boto3
+
+## run test
+$mydir/bin/python3 $mydir/test_rgw_overlap_prepare.py
+
+deactivate
+echo OK.
+
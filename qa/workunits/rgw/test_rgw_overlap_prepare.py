@@ -0,0 +1,136 @@
+#!/usr/bin/python3
+
+import errno
+import logging as log
+import subprocess
+import json
+import boto3
+import botocore.exceptions
+
+"""
+Rgw overlapped bucket index prepare testing against a running instance
+"""
+
+log.basicConfig(format = '%(message)s', level=log.DEBUG)
+log.getLogger('botocore').setLevel(log.CRITICAL)
+log.getLogger('boto3').setLevel(log.CRITICAL)
+log.getLogger('urllib3').setLevel(log.CRITICAL)
+
+""" Constants """
+USER = 'tester'
+DISPLAY_NAME = 'Testing'
+ACCESS_KEY = 'NX5QOQKC6BH2IDN8HC7A'
+SECRET_KEY = 'LnEsqNNqZIpkzauboDcLXLcYaWwLQ3Kop0zAnKIn'
+BUCKET_NAME = 'overlap-prepare'
+OBJ_NAME = 'obj'
+OBJ_DATA = b'x' * 1024 * 1024
+
+def exec_cmd(cmd, **kwargs):
+    check_retcode = kwargs.pop('check_retcode', True)
+    kwargs['shell'] = True
+    kwargs['stdout'] = subprocess.PIPE
+    proc = subprocess.Popen(cmd, **kwargs)
+    log.info(proc.args)
+    out, _ = proc.communicate()
+    if check_retcode:
+        assert(proc.returncode == 0)
+        return out
+    return (out, proc.returncode)
+
+def set_overlap_index_prepare(enabled):
+    exec_cmd('radosgw-admin zone placement modify --rgw-zone default '
+             '--placement-id default-placement --overlap-index-prepare={}'.format(
+                 'true' if enabled else 'false'))
+
+def get_bucket_num_objects(bucket_name):
+    json_op = json.loads(exec_cmd('radosgw-admin bucket stats --bucket {}'.format(bucket_name)))
+    if len(json_op['usage']) == 0:
+        return 0
+    return json_op['usage']['rgw.main']['num_objects']
+
+def main():
+    """
+    execute object rewrites whose overlapped index prepare fails
+    """
+    # create user
+    _, ret = exec_cmd('radosgw-admin user create --uid {} --display-name {} --access-key {} --secret {}'.format(USER, DISPLAY_NAME, ACCESS_KEY, SECRET_KEY), check_retcode=False)
+    assert ret in (0, errno.EEXIST)
+
+    def boto_connect(portnum, ssl, proto):
+        endpoint = proto + '://localhost:' + portnum
+        conn = boto3.resource('s3',
+                              aws_access_key_id=ACCESS_KEY,
+                              aws_secret_access_key=SECRET_KEY,
+                              use_ssl=ssl,
+                              endpoint_url=endpoint,
+                              verify=False,
+                              config=None,
+                              )
+        try:
+            list(conn.buckets.limit(1)) # just verify we can list buckets
+        except botocore.exceptions.ConnectionError as e:
+            print(e)
+            raise
+        print('connected to', endpoint)
+        return conn
+
+    try:
+        connection = boto_connect('80', False, 'http')
+    except botocore.exceptions.ConnectionError:
+        try: # retry on non-privileged http port
+            connection = boto_connect('8000', False, 'http')
+        except botocore.exceptions.ConnectionError:
+            # retry with ssl
+            connection = boto_connect('443', True, 'https')
+
+    bucket = connection.create_bucket(Bucket=BUCKET_NAME)
+    connection.Object(BUCKET_NAME, OBJ_NAME).put(Body=OBJ_DATA)
+
+    set_overlap_index_prepare(True)
+    try:
+        # TESTCASE 'overlap-prepare','object','rewrite','prepare fails after the head write','succeeds'
+        log.debug('TEST: rewrite an object whose overlapped index prepare fails\n')
+        for err in [errno.EIO, errno.ETIMEDOUT]:
+            exec_cmd('radosgw-admin object rewrite --bucket {} --object {} '
+                     '--rgw-inject-index-prepare-err {}'.format(BUCKET_NAME, OBJ_NAME, err))
+
+            # the prepare was retried, so the object is still listed, readable
+            # and accounted once
+            keys = [o.key for o in bucket.objects.all()]
+            assert keys == [OBJ_NAME]
+            assert connection.Object(BUCKET_NAME, OBJ_NAME).get()['Body'].read() == OBJ_DATA
+            assert get_bucket_num_objects(BUCKET_NAME) == 1
+            exec_cmd('radosgw-admin bucket check --bucket {} --check-objects'.format(BUCKET_NAME))
+
+        # TESTCASE 'overlap-prepare','object','rewrite','prepare and its retry fail','fails, keeps the object'
+        log.debug('TEST: rewrite an object whose overlapped and retried index prepares fail\n')
+        for err in [errno.EIO, errno.ECANCELED]:
+            _, ret = exec_cmd('radosgw-admin object rewrite --bucket {} --object {} '
+                              '--rgw-inject-index-prepare-err {} '
+                              '--rgw-inject-index-prepare-retry-err {}'.format(
+                                  BUCKET_NAME, OBJ_NAME, err, err),
+                              check_retcode=False)
+            assert ret != 0
+
+            # the failed rewrite neither removed the object nor its data
+            keys = [o.key for o in bucket.objects.all()]
+            assert keys == [OBJ_NAME]
+            assert connection.Object(BUCKET_NAME, OBJ_NAME).get()['Body'].read() == OBJ_DATA
+            assert get_bucket_num_objects(BUCKET_NAME) == 1
+            exec_cmd('radosgw-admin bucket check --bucket {} --check-objects'.format(BUCKET_NAME))
+
+        # the next write fixes the index entry
+        exec_cmd('radosgw-admin object rewrite --bucket {} --object {}'.format(BUCKET_NAME, OBJ_NAME))
+        assert connection.Object(BUCKET_NAME, OBJ_NAME).get()['Body'].read() == OBJ_DATA
+        assert get_bucket_num_objects(BUCKET_NAME) == 1
+    finally:
+        set_overlap_index_prepare(False)
+
+    # Clean up
+    log.debug("Deleting bucket {}".format(BUCKET_NAME))
+    bucket.objects.all().delete()
+    bucket.delete()
+
+
+main()
+log.info("Completed overlapped index prepare tests")
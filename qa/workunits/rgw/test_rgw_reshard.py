@@ -159,6 +159,51 @@ def test_bucket_reshard(conn, name, **fault):
         bucket.delete()
 
 
+def get_object_shard(object_name, num_shards):
+    cmd = exec_cmd('radosgw-admin bucket object shard --object {} --num-shards {}'.format(object_name, num_shards))
+    return json.loads(cmd)['shard']
+
+def test_bucket_listing_refill(conn, name):
+    """
+    list a bucket whose entries are mostly in one index shard, so that the
+    ordered listing has to refill that shard while merging
+    """
+    num_shards = 7
+    bucket = conn.create_bucket(Bucket=name)
+    exec_cmd('radosgw-admin bucket reshard --bucket {} --num-shards {} --yes-i-really-mean-it'.format(name, num_shards))
+    assert get_bucket_stats(name).num_shards == num_shards
+
+    keys = []
+    others = 0
+    i = 0
+    while len(keys) < 120:
+        key = 'key-{:05d}'.format(i)
+        i += 1
+        if get_object_shard(key, num_shards) == 0:
+            keys.append(key)
+        elif others < 10:
+            keys.append(key)
+            others += 1
+    for key in keys:
+        bucket.put_object(Key=key, Body=b"some_data")
+
+    listed = []
+    page_size = 25
+    kwargs = {'Bucket': name, 'MaxKeys': page_size}
+    while True:
+        res = conn.meta.client.list_objects_v2(**kwargs)
+        page = [obj['Key'] for obj in res.get('Contents', [])]
+        listed += page
+        if not res['IsTruncated']:
+            break
+        # a page is only short if the whole listing ends
+        assert len(page) == page_size
+        kwargs['ContinuationToken'] = res['NextContinuationToken']
+    assert listed == sorted(keys)
+
+    bucket.objects.all().delete()
+    bucket.delete()
+
 def main():
     """
     execute manual and dynamic resharding commands
@@ -252,6 +297,11 @@ def main():
     log.debug('TEST: reshard bucket with abort at set_target_layout\n')
     test_bucket_reshard(connection, 'abort-at-set-target-layout', abort_at='set_target_layout')
 
+    log.debug('TEST: reshard bucket with EIO injected at logrecord_writes\n')
+    test_bucket_reshard(connection, 'error-at-logrecord-writes', error_at='logrecord_writes')
+    log.debug('TEST: reshard bucket with abort at logrecord_writes\n')
+    test_bucket_reshard(connection, 'abort-at-logrecord-writes', abort_at='logrecord_writes')
+
     log.debug('TEST: reshard bucket with EIO injected at block_writes\n')
     test_bucket_reshard(connection, 'error-at-block-writes', error_at='block_writes')
     log.debug('TEST: reshard bucket with abort at block_writes\n')
@@ -278,6 +328,10 @@ def main():
     ver_bucket_stats = get_bucket_stats(VER_BUCKET_NAME)
     assert ver_bucket_stats.num_shards == num_shards_expected
 
+    # TESTCASE 'ordered listing','bucket','list','entries mostly in one index shard','returns full pages in order'
+    log.debug(' test: ordered listing refills an exhausted index shard')
+    test_bucket_listing_refill(connection, 'skewed-listing')
+
     # TESTCASE 'check acl'
     new_bucket_acl = connection.BucketAcl(BUCKET_NAME).load()
     assert new_bucket_acl == bucket_acl
@@ -54,13 +54,15 @@ CLS_NAME(rgw)
 #define BI_BUCKET_LOG_INDEX           1
 #define BI_BUCKET_OBJ_INSTANCE_INDEX  2
 #define BI_BUCKET_OLH_DATA_INDEX      3
+#define BI_BUCKET_RESHARD_LOG_INDEX   4
 
-#define BI_BUCKET_LAST_INDEX          4
+#define BI_BUCKET_LAST_INDEX          5
 
 static std::string bucket_index_prefixes[] = { "", /* special handling for the objs list index */
 					       "0_",     /* bucket log index */
 					       "1000_",  /* obj instance index */
 					       "1001_",  /* olh data index */
+					       "2001_",  /* reshard log index */
 
 					       /* this must be the last index */
 					       "9999_",};
@@ -139,6 +141,12 @@ static void bi_log_prefix(string& key)
   key.append(bucket_index_prefixes[BI_BUCKET_LOG_INDEX]);
 }
 
+static void reshard_log_prefix(string& key)
+{
+  key = BI_PREFIX_CHAR;
+  key.append(bucket_index_prefixes[BI_BUCKET_RESHARD_LOG_INDEX]);
+}
+
 static void bi_log_index_key(cls_method_context_t hctx, string& key, string& id, uint64_t index_ver)
 {
   bi_log_prefix(key);
@@ -476,6 +484,32 @@ static int read_bucket_header(cls_method_context_t hctx,
   return 0;
 }
 
+/*
+ * While a shard is being resharded, the index entries of the objects modified
+ * after the reshard started listing it may already have been copied to the
+ * target shards. Record the names of these objects, so that the reshard can
+ * copy their entries again once it blocks writes to the shard.
+ */
+static int reshard_log_add(cls_method_context_t hctx,
+                           const rgw_bucket_dir_header& header,
+                           const string& name)
+{
+  if (!header.resharding()) {
+    return 0;
+  }
+  string key;
+  reshard_log_prefix(key);
+  key.append(name);
+
+  bufferlist empty;
+  int rc = cls_cxx_map_set_val(hctx, key, &empty);
+  if (rc < 0) {
+    CLS_LOG(1, "ERROR: %s: failed to record %s, rc=%d", __func__,
+            escape_str(name).c_str(), rc);
+  }
+  return rc;
+}
+
 int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
 {
   CLS_LOG(10, "entered %s", __func__);
@@ -1117,6 +1151,17 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     return -EINVAL;
   }
 
+  rc = reshard_log_add(hctx, header, op.key.name);
+  if (rc < 0) {
+    return rc;
+  }
+  for (const auto& remove_key : op.remove_objs) {
+    rc = reshard_log_add(hctx, header, remove_key.name);
+    if (rc < 0) {
+      return rc;
+    }
+  }
+
   rgw_bucket_dir_entry entry;
   bool ondisk = true;
 
@@ -1728,9 +1773,21 @@ static int rgw_bucket_link_olh(cls_method_context_t hctx, bufferlist *in, buffer
     return -EINVAL;
   }
 
+  rgw_bucket_dir_header header;
+  int ret = read_bucket_header(hctx, &header);
+  if (ret < 0) {
+    CLS_LOG(1, "ERROR: rgw_bucket_link_olh(): failed to read header\n");
+    return ret;
+  }
+
+  ret = reshard_log_add(hctx, header, op.key.name);
+  if (ret < 0) {
+    return ret;
+  }
+
   /* read instance entry */
   BIVerObjEntry obj(hctx, op.key);
-  int ret = obj.init(op.delete_marker);
+  ret = obj.init(op.delete_marker);
 
   /* NOTE: When a delete is issued, a key instance is always provided,
    * either the one for which the delete is requested or a new random
@@ -1913,12 +1970,6 @@ static int rgw_bucket_link_olh(cls_method_context_t hctx, bufferlist *in, buffer
    return 0;
   }
 
-  rgw_bucket_dir_header header;
-  ret = read_bucket_header(hctx, &header);
-  if (ret < 0) {
-    CLS_LOG(1, "ERROR: rgw_bucket_link_olh(): failed to read header\n");
-    return ret;
-  }
   if (header.syncstopped) {
     return 0;
   }
@@ -1968,10 +2019,22 @@ static int rgw_bucket_unlink_instance(cls_method_context_t hctx, bufferlist *in,
     dest_key.instance.clear();
   }
 
+  rgw_bucket_dir_header header;
+  int ret = read_bucket_header(hctx, &header);
+  if (ret < 0) {
+    CLS_LOG(1, "ERROR: rgw_bucket_unlink_instance(): failed to read header\n");
+    return ret;
+  }
+
+  ret = reshard_log_add(hctx, header, dest_key.name);
+  if (ret < 0) {
+    return ret;
+  }
+
   BIVerObjEntry obj(hctx, dest_key);
   BIOLHEntry olh(hctx, dest_key);
 
-  int ret = obj.init();
+  ret = obj.init();
   if (ret == -ENOENT) {
     return 0; /* already removed */
   }
@@ -2079,12 +2142,6 @@ static int rgw_bucket_unlink_instance(cls_method_context_t hctx, bufferlist *in,
     return 0;
   }
 
-  rgw_bucket_dir_header header;
-  ret = read_bucket_header(hctx, &header);
-  if (ret < 0) {
-    CLS_LOG(1, "ERROR: rgw_bucket_unlink_instance(): failed to read header\n");
-    return ret;
-  }
   if (header.syncstopped) {
     return 0;
   }
@@ -2191,6 +2248,17 @@ static int rgw_bucket_trim_olh_log(cls_method_context_t hctx, bufferlist *in, bu
     return -ECANCELED;
   }
 
+  rgw_bucket_dir_header header;
+  ret = read_bucket_header(hctx, &header);
+  if (ret < 0) {
+    CLS_LOG(1, "ERROR: rgw_bucket_trim_olh_log(): failed to read header\n");
+    return ret;
+  }
+  ret = reshard_log_add(hctx, header, op.olh.name);
+  if (ret < 0) {
+    return ret;
+  }
+
   /* remove all versions up to and including ver from the pending map */
   auto& log = olh_data_entry.pending_log;
   auto liter = log.begin();
@@ -2228,11 +2296,22 @@ static int rgw_bucket_clear_olh(cls_method_context_t hctx, bufferlist *in, buffe
     return -EINVAL;
   }
 
+  rgw_bucket_dir_header header;
+  int ret = read_bucket_header(hctx, &header);
+  if (ret < 0) {
+    CLS_LOG(1, "ERROR: rgw_bucket_clear_olh(): failed to read header\n");
+    return ret;
+  }
+  ret = reshard_log_add(hctx, header, op.key.name);
+  if (ret < 0) {
+    return ret;
+  }
+
   /* read olh entry */
   rgw_bucket_olh_entry olh_data_entry;
   string olh_data_key;
   encode_olh_data_key(op.key, &olh_data_key);
-  int ret = read_index_entry(hctx, olh_data_key, &olh_data_entry);
+  ret = read_index_entry(hctx, olh_data_key, &olh_data_entry);
   if (ret < 0 && ret != -ENOENT) {
     CLS_LOG(0, "ERROR: read_index_entry() olh_key=%s ret=%d", olh_data_key.c_str(), ret);
     return ret;
@@ -2357,6 +2436,11 @@ int rgw_dir_suggest_changes(cls_method_context_t hctx,
       continue;
     }
 
+    ret = reshard_log_add(hctx, header, cur_change.key.name);
+    if (ret < 0) {
+      return ret;
+    }
+
     if (cur_disk_bl.length()) {
       auto cur_disk_iter = cur_disk_bl.cbegin();
       try {
@@ -4525,7 +4609,8 @@ static int rgw_guard_bucket_resharding(cls_method_context_t hctx, bufferlist *in
     return rc;
   }
 
-  if (header.resharding()) {
+  // writes go on while the modified entries are only recorded
+  if (header.resharding() && !header.resharding_in_logrecord()) {
     return op.ret_err;
   }
 
@@ -4561,6 +4646,71 @@ static int rgw_get_bucket_resharding(cls_method_context_t hctx,
   return 0;
 }
 
+static int rgw_reshard_log_list(cls_method_context_t hctx,
+				bufferlist *in, bufferlist *out)
+{
+  CLS_LOG(10, "entered %s", __func__);
+  cls_rgw_reshard_log_list_op op;
+
+  auto in_iter = in->cbegin();
+  try {
+    decode(op, in_iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG(1, "ERROR: %s: failed to decode entry", __func__);
+    return -EINVAL;
+  }
+
+  string prefix;
+  reshard_log_prefix(prefix);
+  const string start_after = prefix + op.marker;
+  constexpr uint32_t MAX_RESHARD_LOG_LIST_ENTRIES = 1000;
+  const uint32_t max = std::min(op.max, MAX_RESHARD_LOG_LIST_ENTRIES);
+
+  map<string, bufferlist> keys;
+  cls_rgw_reshard_log_list_ret op_ret;
+  int rc = cls_cxx_map_get_vals(hctx, start_after, prefix, max, &keys,
+                                &op_ret.is_truncated);
+  if (rc < 0) {
+    return rc;
+  }
+  for (const auto& k : keys) {
+    op_ret.names.push_back(k.first.substr(prefix.size()));
+  }
+
+  encode(op_ret, *out);
+  return 0;
+}
+
+static int rgw_reshard_log_trim(cls_method_context_t hctx,
+				bufferlist *in, bufferlist *out)
+{
+  CLS_LOG(10, "entered %s", __func__);
+
+  string key_begin;
+  reshard_log_prefix(key_begin);
+  string key_end = BI_PREFIX_CHAR;
+  key_end.append(bucket_index_prefixes[BI_BUCKET_RESHARD_LOG_INDEX + 1]);
+
+  // list a single key to detect whether the log is empty
+  std::set<std::string> keys;
+  bool more = false;
+  int rc = cls_cxx_map_get_keys(hctx, key_begin, 1, &keys, &more);
+  if (rc < 0) {
+    CLS_LOG(1, "ERROR: cls_cxx_map_get_keys failed rc=%d", rc);
+    return rc;
+  }
+  if (keys.empty() || key_end <= *keys.begin()) {
+    return -ENODATA;
+  }
+
+  rc = cls_cxx_map_remove_range(hctx, *keys.begin(), key_end);
+  if (rc < 0) {
+    CLS_LOG(1, "ERROR: cls_cxx_map_remove_range failed rc=%d", rc);
+    return rc;
+  }
+  return 0;
+}
+
 CLS_INIT(rgw)
 {
   CLS_LOG(1, "Loaded rgw class!");
@@ -4612,6 +4762,8 @@ CLS_INIT(rgw)
   cls_method_handle_t h_rgw_clear_bucket_resharding;
   cls_method_handle_t h_rgw_guard_bucket_resharding;
   cls_method_handle_t h_rgw_get_bucket_resharding;
+  cls_method_handle_t h_rgw_reshard_log_list;
+  cls_method_handle_t h_rgw_reshard_log_trim;
 
   cls_register(RGW_CLASS, &h_class);
 
@@ -4682,6 +4834,10 @@ CLS_INIT(rgw)
 			  rgw_guard_bucket_resharding, &h_rgw_guard_bucket_resharding);
   cls_register_cxx_method(h_class, RGW_GET_BUCKET_RESHARDING, CLS_METHOD_RD ,
 			  rgw_get_bucket_resharding, &h_rgw_get_bucket_resharding);
+  cls_register_cxx_method(h_class, RGW_RESHARD_LOG_LIST, CLS_METHOD_RD,
+			  rgw_reshard_log_list, &h_rgw_reshard_log_list);
+  cls_register_cxx_method(h_class, RGW_RESHARD_LOG_TRIM, CLS_METHOD_RD | CLS_METHOD_WR,
+			  rgw_reshard_log_trim, &h_rgw_reshard_log_trim);
 
   return;
 }
@@ -1204,3 +1204,43 @@ int CLSRGWIssueSetBucketResharding::issue_op(const int shard_id, const string& o
 {
   return issue_set_bucket_resharding(io_ctx, shard_id, oid, entry, &manager);
 }
+
+int cls_rgw_reshard_log_list(librados::IoCtx& io_ctx, const string& oid,
+                             const string& marker, uint32_t max,
+                             list<string> *names, bool *is_truncated)
+{
+  bufferlist in, out;
+  cls_rgw_reshard_log_list_op call;
+  call.marker = marker;
+  call.max = max;
+  encode(call, in);
+  int r = io_ctx.exec(oid, RGW_CLASS, RGW_RESHARD_LOG_LIST, in, out);
+  if (r < 0)
+    return r;
+
+  cls_rgw_reshard_log_list_ret op_ret;
+  auto iter = out.cbegin();
+  try {
+    decode(op_ret, iter);
+  } catch (ceph::buffer::error& err) {
+    return -EIO;
+  }
+
+  names->swap(op_ret.names);
+  *is_truncated = op_ret.is_truncated;
+
+  return 0;
+}
+
+void cls_rgw_reshard_log_trim(librados::ObjectWriteOperation& op)
+{
+  bufferlist in;
+  op.exec(RGW_CLASS, RGW_RESHARD_LOG_TRIM, in);
+}
+
+int CLSRGWIssueReshardLogTrim::issue_op(const int shard_id, const string& oid)
+{
+  librados::ObjectWriteOperation op;
+  cls_rgw_reshard_log_trim(op);
+  return manager.aio_operate(io_ctx, shard_id, oid, &op);
+}
@@ -58,6 +58,38 @@ namespace PriorityCache
     return val;
   }
 
+  void balance_by_hits(double total_ratio,
+                       std::map<std::string, HitShare>& shares)
+  {
+    // Hit density is a cheap stand-in for the marginal hit ratio: memory
+    // moves towards the caches where it currently does the most work.  A
+    // floor keeps every cache warm enough to keep reporting hits, and
+    // blending with the previous ratio avoids oscillation.
+    if (shares.empty()) {
+      return;
+    }
+    double floor_ratio = total_ratio * 0.05 / shares.size();
+    std::map<std::string, double> density;
+    double total_density = 0;
+    for (auto& [name, s] : shares) {
+      uint64_t delta = s.hits - s.last_hits;
+      s.last_hits = s.hits;
+      // don't let a (nearly) empty cache look infinitely dense
+      int64_t committed = std::max<int64_t>(s.committed, 64ul*1024*1024);
+      density[name] = (double)(delta + 1) / committed;
+      total_density += density[name];
+    }
+    double sum = 0;
+    for (auto& [name, s] : shares) {
+      double target = total_ratio * density[name] / total_density;
+      s.ratio = std::max(floor_ratio, (s.ratio + target) / 2);
+      sum += s.ratio;
+    }
+    for (auto& [name, s] : shares) {
+      s.ratio *= total_ratio / sum;
+    }
+  }
+
   Manager::Manager(CephContext *c,
                    uint64_t min,
                    uint64_t max,
@@ -229,6 +261,14 @@ namespace PriorityCache
               "total bytes committed,", "c",
               PerfCountersBuilder::PRIO_USEFUL, unit_t(UNIT_BYTES));
 
+    b.add_u64_counter(cur_index + Extra::E_HITS, "hits",
+              "cache lookup hits", "h",
+              PerfCountersBuilder::PRIO_USEFUL);
+
+    b.add_u64_counter(cur_index + Extra::E_MISSES, "misses",
+              "cache lookup misses", "m",
+              PerfCountersBuilder::PRIO_USEFUL);
+
     for (int i = 0; i < Extra::E_LAST+1; i++) {
       indexes[name][i] = cur_index + i;
     }
@@ -310,6 +350,9 @@ namespace PriorityCache
 
       l.second->set(indexes[it->first][Extra::E_RESERVED], committed - alloc);
       l.second->set(indexes[it->first][Extra::E_COMMITTED], committed);
+      l.second->set(indexes[it->first][Extra::E_HITS], it->second->get_hits());
+      l.second->set(indexes[it->first][Extra::E_MISSES],
+                    it->second->get_misses());
     }
   }
 
@@ -16,6 +16,7 @@
 #define CEPH_PRIORITY_CACHE_H
 
 #include <stdint.h>
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -57,11 +58,28 @@ namespace PriorityCache {
   enum Extra {
     E_RESERVED = Priority::LAST+1,
     E_COMMITTED,
-    E_LAST = E_COMMITTED,
+    E_HITS,
+    E_MISSES,
+    E_LAST = E_MISSES,
   };
 
   int64_t get_chunk(uint64_t usage, uint64_t total_bytes);
 
+  // A cache whose share of some memory follows its hit rate, see
+  // balance_by_hits().
+  struct HitShare {
+    uint64_t hits = 0;       // cumulative lookup hits of the cache
+    int64_t committed = 0;   // bytes currently committed to the cache
+    uint64_t last_hits = 0;  // hits at the previous balance
+    double ratio = 0;        // share of the memory
+  };
+
+  // Split total_ratio between the caches according to how many hits each
+  // committed byte earned since the previous balance, and update their
+  // ratio and last_hits.
+  void balance_by_hits(double total_ratio,
+                       std::map<std::string, HitShare>& shares);
+
   struct PriCache {
     virtual ~PriCache();
 
@@ -112,6 +130,15 @@ namespace PriorityCache {
 
     // Get bins
     virtual uint64_t get_bins(PriorityCache::Priority pri) const = 0;
+
+    // Get the cumulative number of lookup hits/misses (if the cache tracks
+    // them).
+    virtual uint64_t get_hits() const {
+      return 0;
+    }
+    virtual uint64_t get_misses() const {
+      return 0;
+    }
   };
 
   class Manager {
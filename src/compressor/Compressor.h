@@ -90,11 +90,18 @@ public:
   CompressionAlgorithm get_type() const {
     return alg;
   }
+  // compressor_message carries algorithm specific parameters (zlib window
+  // size, zstd dictionary id) that must be handed back to decompress().
+  // Some compressors also accept a requested value on input.
   virtual int compress(const ceph::bufferlist &in, ceph::bufferlist &out, std::optional<int32_t> &compressor_message) = 0;
   virtual int decompress(const ceph::bufferlist &in, ceph::bufferlist &out, std::optional<int32_t> compressor_message) = 0;
   // this is a bit weird but we need non-const iterator to be in
   // alignment with decode methods
   virtual int decompress(ceph::bufferlist::const_iterator &p, size_t compressed_len, ceph::bufferlist &out, std::optional<int32_t> compressor_message) = 0;
+  // whether the dictionary with the given id can be used
+  virtual bool has_dictionary(uint32_t id) {
+    return false;
+  }
 
   static CompressorRef create(CephContext *cct, const std::string &type);
   static CompressorRef create(CephContext *cct, int alg);
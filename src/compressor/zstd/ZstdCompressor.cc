@@ -0,0 +1,224 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * Copyright (C) 2015 Haomai Wang <haomaiwang@gmail.com>
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include <filesystem>
+
+#include "common/debug.h"
+#include "ZstdCompressor.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_compressor
+#undef dout_prefix
+#define dout_prefix *_dout << "ZstdCompressor: "
+
+namespace fs = std::filesystem;
+
+ZstdCompressor::~ZstdCompressor()
+{
+  for (auto& [id, d] : dicts) {
+    ZSTD_freeCDict(d.cdict);
+    ZSTD_freeDDict(d.ddict);
+  }
+}
+
+void ZstdCompressor::load_dictionaries()
+{
+  auto dir = cct->_conf.get_val<std::string>("compressor_zstd_dict_dir");
+  if (dir.empty()) {
+    return;
+  }
+  std::error_code ec;
+  for (auto& de : fs::directory_iterator(dir, ec)) {
+    if (!de.is_regular_file()) {
+      continue;
+    }
+    ceph::buffer::list bl;
+    std::string err;
+    if (bl.read_file(de.path().c_str(), &err) < 0) {
+      lderr(cct) << __func__ << " failed to read " << de.path()
+		 << ": " << err << dendl;
+      continue;
+    }
+    const char *buf = bl.c_str();
+    unsigned id = ZSTD_getDictID_fromDict(buf, bl.length());
+    if (id == 0) {
+      ldout(cct, 1) << __func__ << " " << de.path()
+		    << " is not a zstd dictionary, skipping" << dendl;
+      continue;
+    }
+    if (dicts.count(id)) {
+      lderr(cct) << __func__ << " duplicate dictionary id " << id
+		 << " in " << de.path() << ", skipping" << dendl;
+      continue;
+    }
+    dictionary_t d;
+    d.cdict = ZSTD_createCDict(buf, bl.length(),
+			       cct->_conf->compressor_zstd_level);
+    d.ddict = ZSTD_createDDict(buf, bl.length());
+    if (!d.cdict || !d.ddict) {
+      lderr(cct) << __func__ << " failed to load dictionary " << de.path()
+		 << dendl;
+      ZSTD_freeCDict(d.cdict);
+      ZSTD_freeDDict(d.ddict);
+      continue;
+    }
+    ldout(cct, 5) << __func__ << " loaded dictionary " << id
+		  << " from " << de.path() << dendl;
+    dicts[id] = d;
+  }
+  if (ec) {
+    lderr(cct) << __func__ << " unable to list " << dir << ": "
+	       << ec.message() << dendl;
+  }
+}
+
+const ZstdCompressor::dictionary_t *ZstdCompressor::get_dictionary(uint32_t id)
+{
+  std::call_once(dicts_loaded, [this] { load_dictionaries(); });
+  auto p = dicts.find(id);
+  if (p == dicts.end()) {
+    return nullptr;
+  }
+  return &p->second;
+}
+
+bool ZstdCompressor::has_dictionary(uint32_t id)
+{
+  return get_dictionary(id) != nullptr;
+}
+
+int ZstdCompressor::compress(const ceph::buffer::list &src, ceph::buffer::list &dst, std::optional<int32_t> &compressor_message)
+{
+  uint32_t dict_id = compressor_message ?
+    *compressor_message :
+    cct->_conf.get_val<uint64_t>("compressor_zstd_dict_id");
+  const dictionary_t *dict = nullptr;
+  if (dict_id) {
+    dict = get_dictionary(dict_id);
+    if (!dict) {
+      ldout(cct, 10) << __func__ << " dictionary " << dict_id
+		     << " not loaded, compressing without it" << dendl;
+      dict_id = 0;
+    }
+  }
+
+  ZSTD_CStream *s = ZSTD_createCStream();
+  ZSTD_initCStream_srcSize(s, cct->_conf->compressor_zstd_level, src.length());
+  if (dict) {
+    ZSTD_CCtx_refCDict(s, dict->cdict);
+  }
+  auto p = src.begin();
+  size_t left = src.length();
+
+  size_t const out_max = ZSTD_compressBound(left);
+  ceph::buffer::ptr outptr = ceph::buffer::create_small_page_aligned(out_max);
+  ZSTD_outBuffer_s outbuf;
+  outbuf.dst = outptr.c_str();
+  outbuf.size = outptr.length();
+  outbuf.pos = 0;
+
+  while (left) {
+    ceph_assert(!p.end());
+    struct ZSTD_inBuffer_s inbuf;
+    inbuf.pos = 0;
+    inbuf.size = p.get_ptr_and_advance(left, (const char**)&inbuf.src);
+    left -= inbuf.size;
+    ZSTD_EndDirective const zed = (left==0) ? ZSTD_e_end : ZSTD_e_continue;
+    size_t r = ZSTD_compressStream2(s, &outbuf, &inbuf, zed);
+    if (ZSTD_isError(r)) {
+      ZSTD_freeCStream(s);
+      return -EINVAL;
+    }
+  }
+  ceph_assert(p.end());
+
+  ZSTD_freeCStream(s);
+
+  // prefix with decompressed length
+  ceph::encode((uint32_t)src.length(), dst);
+  dst.append(outptr, 0, outbuf.pos);
+  if (dict_id) {
+    compressor_message = dict_id;
+  } else {
+    compressor_message.reset();
+  }
+  return 0;
+}
+
+int ZstdCompressor::decompress(const ceph::buffer::list &src, ceph::buffer::list &dst, std::optional<int32_t> compressor_message)
+{
+  auto i = std::cbegin(src);
+  return decompress(i, src.length(), dst, compressor_message);
+}
+
+int ZstdCompressor::decompress(ceph::buffer::list::const_iterator &p,
+			       size_t compressed_len,
+			       ceph::buffer::list &dst,
+			       std::optional<int32_t> compressor_message)
+{
+  if (compressed_len < 4) {
+    return -1;
+  }
+  compressed_len -= 4;
+  uint32_t dst_len;
+  ceph::decode(dst_len, p);
+
+  uint32_t dict_id = 0;
+  if (compressor_message) {
+    dict_id = *compressor_message;
+  } else {
+    // no out-of-band reference (e.g. on-wire frames); peek at the frame header
+    char hdr[ZSTD_FRAMEHEADERSIZE_MAX];
+    size_t hdr_len = std::min(compressed_len, sizeof(hdr));
+    auto q = p;
+    q.copy(hdr_len, hdr);
+    dict_id = ZSTD_getDictID_fromFrame(hdr, hdr_len);
+  }
+  const dictionary_t *dict = nullptr;
+  if (dict_id) {
+    dict = get_dictionary(dict_id);
+    if (!dict) {
+      lderr(cct) << __func__ << " dictionary " << dict_id
+		 << " required but not loaded" << dendl;
+      return -ENOENT;
+    }
+  }
+
+  ceph::buffer::ptr dstptr(dst_len);
+  ZSTD_outBuffer_s outbuf;
+  outbuf.dst = dstptr.c_str();
+  outbuf.size = dstptr.length();
+  outbuf.pos = 0;
+  ZSTD_DStream *s = ZSTD_createDStream();
+  ZSTD_initDStream(s);
+  if (dict) {
+    ZSTD_DCtx_refDDict(s, dict->ddict);
+  }
+  while (compressed_len > 0) {
+    if (p.end()) {
+      ZSTD_freeDStream(s);
+      return -1;
+    }
+    ZSTD_inBuffer_s inbuf;
+    inbuf.pos = 0;
+    inbuf.size = p.get_ptr_and_advance(compressed_len,
+				       (const char**)&inbuf.src);
+    ZSTD_decompressStream(s, &outbuf, &inbuf);
+    compressed_len -= inbuf.size;
+  }
+  ZSTD_freeDStream(s);
+
+  dst.append(dstptr, 0, outbuf.pos);
+  return 0;
+}
@@ -18,90 +18,52 @@
 #define ZSTD_STATIC_LINKING_ONLY
 #include "zstd/lib/zstd.h"
 
+#include <map>
+#include <mutex>
+
 #include "include/buffer.h"
 #include "include/encoding.h"
 #include "compressor/Compressor.h"
 
+/**
+ * zstd compressor with optional trained dictionaries
+ *
+ * Dictionaries are loaded once from compressor_zstd_dict_dir and
+ * indexed by the dictionary id zstd embeds in them.  On compress,
+ * an incoming compressor_message selects the dictionary id to use
+ * (0 disables dictionaries); when it is unset we fall back to
+ * compressor_zstd_dict_id.  The id actually used is returned in
+ * compressor_message and is also recorded in the zstd frame header,
+ * so readers that do not persist compressor_message (e.g. msgr
+ * on-wire compression) can still find the right dictionary.
+ */
 class ZstdCompressor : public Compressor {
  public:
   ZstdCompressor(CephContext *cct) : Compressor(COMP_ALG_ZSTD, "zstd"), cct(cct) {}
+  ~ZstdCompressor() override;
 
-  int compress(const ceph::buffer::list &src, ceph::buffer::list &dst, std::optional<int32_t> &compressor_message) override {
-    ZSTD_CStream *s = ZSTD_createCStream();
-    ZSTD_initCStream_srcSize(s, cct->_conf->compressor_zstd_level, src.length());
-    auto p = src.begin();
-    size_t left = src.length();
-
-    size_t const out_max = ZSTD_compressBound(left);
-    ceph::buffer::ptr outptr = ceph::buffer::create_small_page_aligned(out_max);
-    ZSTD_outBuffer_s outbuf;
-    outbuf.dst = outptr.c_str();
-    outbuf.size = outptr.length();
-    outbuf.pos = 0;
-
-    while (left) {
-      ceph_assert(!p.end());
-      struct ZSTD_inBuffer_s inbuf;
-      inbuf.pos = 0;
-      inbuf.size = p.get_ptr_and_advance(left, (const char**)&inbuf.src);
-      left -= inbuf.size;
-      ZSTD_EndDirective const zed = (left==0) ? ZSTD_e_end : ZSTD_e_continue;
-      size_t r = ZSTD_compressStream2(s, &outbuf, &inbuf, zed);
-      if (ZSTD_isError(r)) {
-	return -EINVAL;
-      }
-    }
-    ceph_assert(p.end());
-
-    ZSTD_freeCStream(s);
-
-    // prefix with decompressed length
-    ceph::encode((uint32_t)src.length(), dst);
-    dst.append(outptr, 0, outbuf.pos);
-    return 0;
-  }
-
-  int decompress(const ceph::buffer::list &src, ceph::buffer::list &dst, std::optional<int32_t> compressor_message) override {
-    auto i = std::cbegin(src);
-    return decompress(i, src.length(), dst, compressor_message);
-  }
-
+  int compress(const ceph::buffer::list &src, ceph::buffer::list &dst, std::optional<int32_t> &compressor_message) override;
+  int decompress(const ceph::buffer::list &src, ceph::buffer::list &dst, std::optional<int32_t> compressor_message) override;
   int decompress(ceph::buffer::list::const_iterator &p,
 		 size_t compressed_len,
 		 ceph::buffer::list &dst,
-		 std::optional<int32_t> compressor_message) override {
-    if (compressed_len < 4) {
-      return -1;
-    }
-    compressed_len -= 4;
-    uint32_t dst_len;
-    ceph::decode(dst_len, p);
-
-    ceph::buffer::ptr dstptr(dst_len);
-    ZSTD_outBuffer_s outbuf;
-    outbuf.dst = dstptr.c_str();
-    outbuf.size = dstptr.length();
-    outbuf.pos = 0;
-    ZSTD_DStream *s = ZSTD_createDStream();
-    ZSTD_initDStream(s);
-    while (compressed_len > 0) {
-      if (p.end()) {
-	return -1;
-      }
-      ZSTD_inBuffer_s inbuf;
-      inbuf.pos = 0;
-      inbuf.size = p.get_ptr_and_advance(compressed_len,
-					 (const char**)&inbuf.src);
-      ZSTD_decompressStream(s, &outbuf, &inbuf);
-      compressed_len -= inbuf.size;
-    }
-    ZSTD_freeDStream(s);
+		 std::optional<int32_t> compressor_message) override;
+  bool has_dictionary(uint32_t id) override;
 
-    dst.append(dstptr, 0, outbuf.pos);
-    return 0;
-  }
  private:
+  struct dictionary_t {
+    ZSTD_CDict *cdict = nullptr;
+    ZSTD_DDict *ddict = nullptr;
+  };
+
   CephContext *const cct;
+
+  std::once_flag dicts_loaded;
+  // populated once under dicts_loaded, read-only afterwards
+  std::map<uint32_t, dictionary_t> dicts;
+
+  void load_dictionaries();
+  const dictionary_t *get_dictionary(uint32_t id);
 };
 
 #endif
@@ -367,6 +367,11 @@ public:
     return nullptr;
   }
 
+  /// prefixes whose column families have a block cache of their own
+  virtual std::vector<std::string> get_cache_prefixes() const {
+    return {};
+  }
+
 
 
   virtual ~KeyValueDB() {}
@@ -517,6 +517,16 @@ err:
     return nullptr;
   }
 
+  virtual std::vector<std::string> get_cache_prefixes() const override {
+    std::vector<std::string> prefixes;
+    for (auto& [prefix, opts] : cf_bbt_opts) {
+      if (opts.block_cache && opts.block_cache != bbt_opts.block_cache) {
+        prefixes.push_back(prefix);
+      }
+    }
+    return prefixes;
+  }
+
   WholeSpaceIterator get_wholespace_iterator(IteratorOpts opts = 0) override;
 private:
   WholeSpaceIterator get_default_cf_iterator();
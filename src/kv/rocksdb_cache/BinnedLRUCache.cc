@@ -314,6 +314,9 @@ rocksdb::Cache::Handle* BinnedLRUCacheShard::Lookup(const rocksdb::Slice& key, u
     }
     e->refs++;
     e->SetHit();
+    hits_++;
+  } else {
+    misses_++;
   }
   return reinterpret_cast<rocksdb::Cache::Handle*>(e);
 }
@@ -498,6 +501,16 @@ void BinnedLRUCacheShard::set_bin_count(uint32_t count) {
   age_bins.set_capacity(count);
 }
 
+uint64_t BinnedLRUCacheShard::get_hits() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return hits_;
+}
+
+uint64_t BinnedLRUCacheShard::get_misses() const {
+  std::lock_guard<std::mutex> l(mutex_);
+  return misses_;
+}
+
 std::string BinnedLRUCacheShard::GetPrintableOptions() const {
   const int kBufferSize = 200;
   char buffer[kBufferSize];
@@ -696,6 +709,22 @@ void BinnedLRUCache::set_bin_count(uint32_t count) {
   }
 }
 
+uint64_t BinnedLRUCache::get_hits() const {
+  uint64_t hits = 0;
+  for (int s = 0; s < num_shards_; s++) {
+    hits += shards_[s].get_hits();
+  }
+  return hits;
+}
+
+uint64_t BinnedLRUCache::get_misses() const {
+  uint64_t misses = 0;
+  for (int s = 0; s < num_shards_; s++) {
+    misses += shards_[s].get_misses();
+  }
+  return misses;
+}
+
 std::shared_ptr<rocksdb::Cache> NewBinnedLRUCache(
     CephContext *c, 
     size_t capacity,
@@ -244,6 +244,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Get the byte counts for a range of age bins
   uint64_t sum_bins(uint32_t start, uint32_t end) const;
 
+  // Get the number of lookup hits/misses
+  uint64_t get_hits() const;
+  uint64_t get_misses() const;
+
  private:
   CephContext *cct;
   void LRU_Remove(BinnedLRUHandle* e);
@@ -313,6 +317,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
 
   // Circular buffer of byte counters for age binning
   boost::circular_buffer<std::shared_ptr<uint64_t>> age_bins;
+
+  // Lookup statistics
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
 };
 
 class BinnedLRUCache : public ShardedCache {
@@ -350,6 +358,8 @@ class BinnedLRUCache : public ShardedCache {
   uint64_t sum_bins(uint32_t start, uint32_t end) const;
   uint32_t get_bin_count() const;
   void set_bin_count(uint32_t count);
+  virtual uint64_t get_hits() const;
+  virtual uint64_t get_misses() const;
 
   virtual std::string get_cache_name() const {
     return "RocksDB Binned LRU Cache";
@@ -285,6 +285,13 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
     plb.add_u64_counter(l_librbd_resize, "resize", "Resizes");
     plb.add_u64_counter(l_librbd_readahead, "readahead", "Read ahead");
     plb.add_u64_counter(l_librbd_readahead_bytes, "readahead_bytes", "Data size in read ahead", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_librbd_prefetch_hit, "prefetch_hit", "Reads served from prefetch cache");
+    plb.add_u64_counter(l_librbd_prefetch_miss, "prefetch_miss", "Sequential reads missing prefetch cache");
+    plb.add_u64_counter(l_librbd_prefetch_bytes, "prefetch_bytes", "Data size prefetched", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_librbd_prefetch_wasted_bytes, "prefetch_wasted_bytes", "Prefetched data evicted unread", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_librbd_io_scheduler_delayed_writes, "io_scheduler_delayed_writes", "Writes delayed by IO scheduler");
+    plb.add_u64_counter(l_librbd_io_scheduler_dispatched_writes, "io_scheduler_dispatched_writes", "Merged writes dispatched by IO scheduler");
+    plb.add_time_avg(l_librbd_io_scheduler_delay, "io_scheduler_delay", "Delay added by IO scheduler");
     plb.add_u64_counter(l_librbd_invalidate_cache, "invalidate_cache", "Cache invalidates");
 
     plb.add_time(l_librbd_opened_time, "opened_time", "Opened time",
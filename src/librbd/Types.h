@@ -50,6 +50,15 @@ enum {
   l_librbd_readahead,
   l_librbd_readahead_bytes,
 
+  l_librbd_prefetch_hit,
+  l_librbd_prefetch_miss,
+  l_librbd_prefetch_bytes,
+  l_librbd_prefetch_wasted_bytes,
+
+  l_librbd_io_scheduler_delayed_writes,
+  l_librbd_io_scheduler_dispatched_writes,
+  l_librbd_io_scheduler_delay,
+
   l_librbd_invalidate_cache,
 
   l_librbd_opened_time,
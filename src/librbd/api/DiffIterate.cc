@@ -30,6 +30,17 @@ namespace api {
 
 namespace {
 
+template <typename I>
+uint64_t get_concurrent_diff_ops(I &image_ctx) {
+  auto ops = image_ctx.config.template get_val<uint64_t>(
+    "rbd_concurrent_diff_ops");
+  if (ops == 0) {
+    ops = image_ctx.config.template get_val<uint64_t>(
+      "rbd_concurrent_management_ops");
+  }
+  return ops;
+}
+
 struct DiffContext {
   DiffIterate<>::Callback callback;
   void *callback_arg;
@@ -46,7 +57,7 @@ struct DiffContext {
     : callback(callback), callback_arg(callback_arg),
       whole_object(_whole_object), include_parent(_include_parent),
       from_snap_id(_from_snap_id), end_snap_id(_end_snap_id),
-      throttle(image_ctx.config.template get_val<uint64_t>("rbd_concurrent_management_ops"), true) {
+      throttle(get_concurrent_diff_ops(image_ctx), true) {
   }
 };
 
@@ -210,6 +221,27 @@ int DiffIterate<I>::diff_iterate(I *ictx,
   return r;
 }
 
+template <typename I>
+bool DiffIterate<I>::is_extent_unchanged(
+    CephContext* cct, const file_layout_t& layout, uint64_t off, uint64_t len,
+    const BitVector<2>& object_diff_state, bool parent_overlap) {
+  // an object needs to be listed unless the object map shows that it
+  // neither changed nor can expose parent data
+  striper::LightweightObjectExtents object_extents;
+  Striper::file_to_extents(cct, &layout, off, len, 0, 0, &object_extents);
+  for (auto& object_extent : object_extents) {
+    if (object_extent.object_no >= object_diff_state.size()) {
+      return false;
+    }
+    uint8_t diff_state = object_diff_state[object_extent.object_no];
+    if (diff_state != object_map::DIFF_STATE_DATA &&
+        (diff_state != object_map::DIFF_STATE_HOLE || parent_overlap)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <typename I>
 int DiffIterate<I>::execute() {
   CephContext* cct = m_image_ctx.cct;
@@ -242,11 +274,14 @@ int DiffIterate<I>::execute() {
     return -EINVAL;
   }
 
+  // the object map diff is also used for non whole-object diffs to skip
+  // listing snapshots of objects that did not change
   int r;
+  bool object_map_diff_enabled = false;
   bool fast_diff_enabled = false;
   BitVector<2> object_diff_state;
   interval_set<uint64_t> parent_diff;
-  if (m_whole_object) {
+  {
     C_SaferCond ctx;
     auto req = object_map::DiffRequest<I>::create(&m_image_ctx, from_snap_id,
                                                   end_snap_id,
@@ -258,22 +293,25 @@ int DiffIterate<I>::execute() {
       ldout(cct, 5) << "fast diff disabled" << dendl;
     } else {
       ldout(cct, 5) << "fast diff enabled" << dendl;
-      fast_diff_enabled = true;
-
-      // check parent overlap only if we are comparing to the beginning of time
-      if (m_include_parent && from_snap_id == 0) {
-        std::shared_lock image_locker{m_image_ctx.image_lock};
-        uint64_t overlap = 0;
-        m_image_ctx.get_parent_overlap(m_image_ctx.snap_id, &overlap);
-        if (m_image_ctx.parent && overlap > 0) {
-          ldout(cct, 10) << " first getting parent diff" << dendl;
-          DiffIterate diff_parent(*m_image_ctx.parent, {}, nullptr, 0, overlap,
-                                  true, true, &simple_diff_cb, &parent_diff);
-          r = diff_parent.execute();
-          if (r < 0) {
-            return r;
-          }
-        }
+      object_map_diff_enabled = true;
+      fast_diff_enabled = m_whole_object;
+    }
+  }
+
+  // check parent overlap only if we are comparing to the beginning of time
+  bool parent_overlap = false;
+  if (m_include_parent && from_snap_id == 0) {
+    std::shared_lock image_locker{m_image_ctx.image_lock};
+    uint64_t overlap = 0;
+    m_image_ctx.get_parent_overlap(m_image_ctx.snap_id, &overlap);
+    parent_overlap = (m_image_ctx.parent && overlap > 0);
+    if (parent_overlap && fast_diff_enabled) {
+      ldout(cct, 10) << " first getting parent diff" << dendl;
+      DiffIterate diff_parent(*m_image_ctx.parent, {}, nullptr, 0, overlap,
+                              true, true, &simple_diff_cb, &parent_diff);
+      r = diff_parent.execute();
+      if (r < 0) {
+        return r;
       }
     }
   }
@@ -288,6 +326,7 @@ int DiffIterate<I>::execute() {
   uint64_t period = m_image_ctx.get_stripe_period();
   uint64_t off = m_offset;
   uint64_t left = m_length;
+  uint64_t skipped = 0;
 
   while (left > 0) {
     uint64_t period_off = off - (off % period);
@@ -349,6 +388,15 @@ int DiffIterate<I>::execute() {
         }
       }
     } else {
+      if (object_map_diff_enabled &&
+          is_extent_unchanged(cct, m_image_ctx.layout, off, read_len,
+                              object_diff_state, parent_overlap)) {
+        ++skipped;
+        left -= read_len;
+        off += read_len;
+        continue;
+      }
+
       auto diff_object = new C_DiffObject<I>(m_image_ctx, diff_context, off,
                                              read_len);
       diff_object->send();
@@ -367,6 +415,9 @@ int DiffIterate<I>::execute() {
   if (r < 0) {
     return r;
   }
+
+  ldout(cct, 10) << "skipped listing " << skipped << " unchanged periods"
+                 << dendl;
   return 0;
 }
 
@@ -7,6 +7,9 @@
 #include "include/int_types.h"
 #include "common/bit_vector.hpp"
 #include "cls/rbd/cls_rbd_types.h"
+#include "include/fs_types.h"
+
+class CephContext;
 
 namespace librbd {
 
@@ -27,6 +30,14 @@ public:
 		          int (*cb)(uint64_t, size_t, int, void *),
 		          void *arg);
 
+  // true if the object map diff shows that no object backing the image
+  // extent changed and none of them can expose parent data
+  static bool is_extent_unchanged(CephContext* cct,
+                                  const file_layout_t& layout,
+                                  uint64_t off, uint64_t len,
+                                  const BitVector<2>& object_diff_state,
+                                  bool parent_overlap);
+
 private:
   ImageCtxT &m_image_ctx;
   cls::rbd::SnapshotNamespace m_from_snap_namespace;
@@ -0,0 +1,599 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "librbd/cache/PrefetchObjectDispatch.h"
+#include "common/dout.h"
+#include "common/errno.h"
+#include "common/perf_counters.h"
+#include "include/neorados/RADOS.hpp"
+#include "librbd/ImageCtx.h"
+#include "librbd/Types.h"
+#include "librbd/Utils.h"
+#include "librbd/asio/ContextWQ.h"
+#include "librbd/io/ObjectDispatchSpec.h"
+#include "librbd/io/ObjectDispatcherInterface.h"
+#include "osdc/Striper.h"
+
+#define dout_subsys ceph_subsys_rbd
+#undef dout_prefix
+#define dout_prefix *_dout << "librbd::cache::PrefetchObjectDispatch: " \
+                           << this << " " << __func__ << ": "
+
+namespace librbd {
+namespace cache {
+
+using librbd::util::data_object_name;
+
+template <typename I>
+struct PrefetchObjectDispatch<I>::C_PrefetchRead : public Context {
+  PrefetchObjectDispatch* dispatch;
+  uint64_t object_no;
+  uint64_t object_off;
+  uint64_t object_len;
+  snap_t snap_id;
+  size_t stream;
+  io::ReadExtents extents;
+  ceph::mono_time start_time = ceph::mono_clock::now();
+  bool stale = false;
+
+  C_PrefetchRead(PrefetchObjectDispatch* dispatch, uint64_t object_no,
+                 uint64_t object_off, uint64_t object_len, snap_t snap_id,
+                 size_t stream)
+    : dispatch(dispatch), object_no(object_no), object_off(object_off),
+      object_len(object_len), snap_id(snap_id), stream(stream),
+      extents({{object_off, object_len}}) {
+  }
+
+  void finish(int r) override {
+    dispatch->handle_prefetch(this, r);
+  }
+};
+
+template <typename I>
+PrefetchObjectDispatch<I>::PrefetchObjectDispatch(I* image_ctx)
+  : m_image_ctx(image_ctx),
+    m_max_streams(std::max<uint64_t>(1,
+      image_ctx->config.template get_val<uint64_t>(
+        "rbd_prefetch_max_streams"))),
+    m_trigger_requests(image_ctx->config.template get_val<uint64_t>(
+      "rbd_prefetch_trigger_requests")),
+    m_min_window(image_ctx->config.template get_val<Option::size_t>(
+      "rbd_prefetch_min_bytes")),
+    m_max_window(std::max<uint64_t>(m_min_window,
+      image_ctx->config.template get_val<Option::size_t>(
+        "rbd_prefetch_max_bytes"))),
+    m_max_cache_bytes(image_ctx->config.template get_val<Option::size_t>(
+      "rbd_prefetch_cache_size")),
+    m_lock(ceph::make_mutex(util::unique_lock_name(
+      "librbd::cache::PrefetchObjectDispatch::lock", this))),
+    m_streams(m_max_streams) {
+}
+
+template <typename I>
+PrefetchObjectDispatch<I>::~PrefetchObjectDispatch() {
+  ceph_assert(m_in_flight.empty());
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::init() {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 5) << "max_streams=" << m_max_streams << ", "
+                << "window=" << m_min_window << "~" << m_max_window << ", "
+                << "cache_size=" << m_max_cache_bytes << dendl;
+
+  m_image_ctx->io_object_dispatcher->register_dispatch(this);
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::shut_down(Context* on_finish) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 5) << dendl;
+
+  // wait for in-flight prefetch reads
+  m_async_op_tracker.wait_for_ops(on_finish);
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::read(
+    uint64_t object_no, io::ReadExtents* extents, IOContext io_context,
+    int op_flags, int read_flags, const ZTracer::Trace &parent_trace,
+    uint64_t* version, int* object_dispatch_flags,
+    io::DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  if (version != nullptr || extents->empty() ||
+      (read_flags & io::READ_FLAG_DISABLE_READ_FROM_PARENT) != 0) {
+    // prefetched data includes data read from the parent and has no version
+    return false;
+  }
+
+  auto cct = m_image_ctx->cct;
+  auto snap_id = io_context->read_snap().value_or(CEPH_NOSNAP);
+
+  // streams are tracked in image offset space so that they can cross
+  // object boundaries
+  std::vector<std::pair<uint64_t, uint64_t>> file_extents;
+  Striper::extent_to_file(cct, &m_image_ctx->layout, object_no,
+                          extents->front().offset, extents->front().length,
+                          file_extents);
+  uint64_t offset = file_extents.front().first;
+  uint64_t length = 0;
+  for (auto& extent : *extents) {
+    length += extent.length;
+  }
+
+  uint64_t image_size;
+  {
+    std::shared_lock image_locker{m_image_ctx->image_lock};
+    image_size = m_image_ctx->size;
+  }
+
+  std::vector<io::ObjectDispatchSpec*> prefetches;
+  std::unique_lock locker{m_lock};
+  auto stream_idx = get_stream(offset, length);
+  auto& stream = m_streams[stream_idx];
+  bool prefetching = (stream.sequential > m_trigger_requests);
+
+  bool hit = true;
+  for (auto& extent : *extents) {
+    if (!lookup(object_no, snap_id, extent.offset, extent.length, nullptr)) {
+      hit = false;
+      break;
+    }
+  }
+
+  if (hit) {
+    ldout(cct, 20) << data_object_name(m_image_ctx, object_no) << " "
+                   << *extents << ": hit" << dendl;
+    for (auto& extent : *extents) {
+      extent.bl.clear();
+      extent.extent_map.clear();
+      lookup(object_no, snap_id, extent.offset, extent.length, &extent.bl);
+    }
+    update_window(stream, length, false);
+    m_image_ctx->perfcounter->inc(l_librbd_prefetch_hit);
+  } else if (prefetching) {
+    bool late = false;
+    for (auto& extent : *extents) {
+      late |= is_in_flight(object_no, extent.offset, extent.length);
+    }
+    ldout(cct, 20) << data_object_name(m_image_ctx, object_no) << " "
+                   << *extents << ": miss, late=" << late << dendl;
+    if (late) {
+      update_window(stream, length, true);
+    }
+    m_image_ctx->perfcounter->inc(l_librbd_prefetch_miss);
+  }
+
+  maybe_prefetch(stream_idx, offset + length, image_size, io_context,
+                 &prefetches);
+  locker.unlock();
+
+  for (auto spec : prefetches) {
+    spec->send();
+  }
+
+  if (!hit) {
+    return false;
+  }
+
+  *dispatch_result = io::DISPATCH_RESULT_COMPLETE;
+  m_image_ctx->op_work_queue->queue(on_dispatched, 0);
+  return true;
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::discard(
+    uint64_t object_no, uint64_t object_off, uint64_t object_len,
+    IOContext io_context, int discard_flags,
+    const ZTracer::Trace &parent_trace, int* object_dispatch_flags,
+    uint64_t* journal_tid, io::DispatchResult* dispatch_result,
+    Context** on_finish, Context* on_dispatched) {
+  start_write(object_no, object_off, object_len, on_finish);
+  return false;
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::write(
+    uint64_t object_no, uint64_t object_off, ceph::bufferlist&& data,
+    IOContext io_context, int op_flags, int write_flags,
+    std::optional<uint64_t> assert_version,
+    const ZTracer::Trace &parent_trace, int* object_dispatch_flags,
+    uint64_t* journal_tid, io::DispatchResult* dispatch_result,
+    Context** on_finish, Context* on_dispatched) {
+  start_write(object_no, object_off, data.length(), on_finish);
+  return false;
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::write_same(
+    uint64_t object_no, uint64_t object_off, uint64_t object_len,
+    io::LightweightBufferExtents&& buffer_extents, ceph::bufferlist&& data,
+    IOContext io_context, int op_flags,
+    const ZTracer::Trace &parent_trace, int* object_dispatch_flags,
+    uint64_t* journal_tid, io::DispatchResult* dispatch_result,
+    Context** on_finish, Context* on_dispatched) {
+  start_write(object_no, object_off, object_len, on_finish);
+  return false;
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::compare_and_write(
+    uint64_t object_no, uint64_t object_off, ceph::bufferlist&& cmp_data,
+    ceph::bufferlist&& write_data, IOContext io_context, int op_flags,
+    const ZTracer::Trace &parent_trace, uint64_t* mismatch_offset,
+    int* object_dispatch_flags, uint64_t* journal_tid,
+    io::DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  start_write(object_no, object_off, write_data.length(), on_finish);
+  return false;
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::invalidate_cache(Context* on_finish) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 5) << dendl;
+
+  std::lock_guard locker{m_lock};
+  m_cache.clear();
+  m_lru.clear();
+  m_cache_bytes = 0;
+  for (auto req : m_in_flight) {
+    req->stale = true;
+  }
+  for (auto& stream : m_streams) {
+    stream = Stream{};
+  }
+  return false;
+}
+
+template <typename I>
+size_t PrefetchObjectDispatch<I>::get_stream(uint64_t offset,
+                                             uint64_t length) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  auto now = ceph::mono_clock::now();
+  ++m_tick;
+
+  size_t lru = 0;
+  for (size_t i = 0; i < m_streams.size(); ++i) {
+    auto& stream = m_streams[i];
+    if (stream.sequential > 0 && offset >= stream.next_offset &&
+        offset - stream.next_offset <= m_min_window) {
+      // small forward skips don't break a stream
+      double elapsed = std::chrono::duration<double>(
+        now - stream.last_read).count();
+      if (elapsed > 0) {
+        double rate = length / elapsed;
+        stream.bandwidth = (stream.bandwidth == 0 ? rate :
+                            0.8 * stream.bandwidth + 0.2 * rate);
+      }
+      ++stream.sequential;
+      stream.next_offset = offset + length;
+      stream.last_used = m_tick;
+      stream.last_read = now;
+      return i;
+    }
+    if (stream.last_used < m_streams[lru].last_used) {
+      lru = i;
+    }
+  }
+
+  // start tracking a new stream in place of the least recently used one
+  auto& stream = m_streams[lru];
+  stream = Stream{};
+  stream.next_offset = offset + length;
+  stream.prefetched_to = stream.next_offset;
+  stream.window = m_min_window;
+  stream.sequential = 1;
+  stream.last_used = m_tick;
+  stream.last_read = now;
+  return lru;
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::update_window(Stream& stream, uint64_t length,
+                                              bool late) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  uint64_t window = stream.window;
+  if (late) {
+    // prefetched data arrived after it was needed -- read further ahead
+    window *= 2;
+  } else {
+    // additive increase, but always cover the bandwidth-delay product of
+    // the stream twice over so that the next window is in flight while the
+    // current one is being consumed
+    uint64_t bdp = 2 * stream.bandwidth * m_avg_latency;
+    window = std::max(window + length, bdp);
+  }
+  stream.window = std::min(window, m_max_window);
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::maybe_prefetch(
+    size_t stream_idx, uint64_t end_offset, uint64_t image_size,
+    IOContext io_context, std::vector<io::ObjectDispatchSpec*>* prefetches) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  auto cct = m_image_ctx->cct;
+  auto& stream = m_streams[stream_idx];
+  if (stream.sequential <= m_trigger_requests || m_max_cache_bytes == 0) {
+    return;
+  }
+
+  // keep a full window ahead of the stream, topping it up once half of it
+  // has been consumed
+  stream.prefetched_to = std::max(stream.prefetched_to, end_offset);
+  if (stream.prefetched_to >= end_offset + stream.window / 2) {
+    return;
+  }
+  uint64_t start = stream.prefetched_to;
+  uint64_t end = std::min(end_offset + stream.window, image_size);
+  if (start >= end ||
+      m_in_flight_bytes + (end - start) > m_max_cache_bytes / 2) {
+    return;
+  }
+
+  ldout(cct, 20) << "stream=" << stream_idx << ", prefetch "
+                 << start << "~" << (end - start) << ", window="
+                 << stream.window << dendl;
+
+  auto snap_id = io_context->read_snap().value_or(CEPH_NOSNAP);
+  striper::LightweightObjectExtents object_extents;
+  Striper::file_to_extents(cct, &m_image_ctx->layout, start, end - start, 0,
+                           0, &object_extents);
+  stream.prefetched_to = end;
+  for (auto& object_extent : object_extents) {
+    if (is_in_flight(object_extent.object_no, object_extent.offset,
+                     object_extent.length) ||
+        is_write_in_flight(object_extent.object_no, object_extent.offset,
+                           object_extent.length)) {
+      // a prefetch racing with a write could cache the old data
+      continue;
+    }
+    auto req = new C_PrefetchRead(this, object_extent.object_no,
+                                  object_extent.offset, object_extent.length,
+                                  snap_id, stream_idx);
+    m_in_flight.insert(req);
+    m_in_flight_bytes += object_extent.length;
+    m_async_op_tracker.start_op();
+    prefetches->push_back(io::ObjectDispatchSpec::create_read(
+      m_image_ctx, io::OBJECT_DISPATCH_LAYER_PREFETCH,
+      object_extent.object_no, &req->extents, io_context,
+      LIBRADOS_OP_FLAG_FADVISE_SEQUENTIAL, 0, {}, nullptr, req));
+  }
+  m_image_ctx->perfcounter->inc(l_librbd_prefetch_bytes, end - start);
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::handle_prefetch(C_PrefetchRead* req, int r) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << data_object_name(m_image_ctx, req->object_no) << " "
+                 << req->object_off << "~" << req->object_len << ": r=" << r
+                 << dendl;
+
+  std::unique_lock locker{m_lock};
+  m_in_flight.erase(req);
+  m_in_flight_bytes -= req->object_len;
+
+  double latency = std::chrono::duration<double>(
+    ceph::mono_clock::now() - req->start_time).count();
+  m_avg_latency = (m_avg_latency == 0 ? latency :
+                   0.8 * m_avg_latency + 0.2 * latency);
+
+  if (r == -ENOENT) {
+    // object (and parent) doesn't exist -- it reads as zeros
+    r = 0;
+  }
+  if (r < 0) {
+    ldout(cct, 5) << "prefetch failed: " << cpp_strerror(r) << dendl;
+  } else if (!req->stale) {
+    auto& extent = req->extents.front();
+    ceph::bufferlist bl;
+    if (extent.extent_map.empty()) {
+      bl = std::move(extent.bl);
+    } else {
+      // unsparsify the result
+      uint64_t pos = extent.offset;
+      uint64_t bl_off = 0;
+      for (auto [off, len] : extent.extent_map) {
+        if (off > pos) {
+          bl.append_zero(off - pos);
+        }
+        ceph::bufferlist sub;
+        sub.substr_of(extent.bl, bl_off, len);
+        bl.claim_append(sub);
+        bl_off += len;
+        pos = off + len;
+      }
+    }
+    if (bl.length() < extent.length) {
+      bl.append_zero(extent.length - bl.length());
+    }
+    insert(req->object_no, req->object_off, req->snap_id, req->stream,
+           std::move(bl));
+  }
+  locker.unlock();
+
+  m_async_op_tracker.finish_op();
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::lookup(uint64_t object_no, snap_t snap_id,
+                                       uint64_t object_off,
+                                       uint64_t object_len,
+                                       ceph::bufferlist* bl) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  auto it = m_cache.upper_bound({object_no, object_off});
+  if (it == m_cache.begin()) {
+    return false;
+  }
+  --it;
+
+  uint64_t pos = object_off;
+  uint64_t end = object_off + object_len;
+  while (pos < end) {
+    if (it == m_cache.end() || it->first.first != object_no ||
+        it->second.snap_id != snap_id) {
+      return false;
+    }
+    auto& entry = it->second;
+    uint64_t entry_off = it->first.second;
+    uint64_t entry_end = entry_off + entry.bl.length();
+    if (entry_off > pos || entry_end <= pos) {
+      return false;
+    }
+    uint64_t len = std::min(end, entry_end) - pos;
+    if (bl != nullptr) {
+      ceph::bufferlist sub;
+      sub.substr_of(entry.bl, pos - entry_off, len);
+      bl->claim_append(sub);
+
+      // fully consumed extents are the first to go
+      entry.consumed += len;
+      m_lru.erase(entry.lru_it);
+      if (entry.consumed >= entry.bl.length()) {
+        entry.lru_it = m_lru.insert(m_lru.begin(), it->first);
+      } else {
+        entry.lru_it = m_lru.insert(m_lru.end(), it->first);
+      }
+    }
+    pos += len;
+    ++it;
+  }
+  return true;
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::is_in_flight(uint64_t object_no,
+                                             uint64_t object_off,
+                                             uint64_t object_len) const {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  for (auto req : m_in_flight) {
+    if (req->object_no == object_no &&
+        req->object_off < object_off + object_len &&
+        object_off < req->object_off + req->object_len) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename I>
+bool PrefetchObjectDispatch<I>::is_write_in_flight(uint64_t object_no,
+                                                   uint64_t object_off,
+                                                   uint64_t object_len) const {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  auto range = m_in_flight_writes.equal_range(object_no);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto& [write_off, write_len] = it->second;
+    if (write_off < object_off + object_len &&
+        object_off < write_off + write_len) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::insert(uint64_t object_no, uint64_t object_off,
+                                       snap_t snap_id, size_t stream,
+                                       ceph::bufferlist&& bl) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  uint64_t length = bl.length();
+  if (length == 0 || length > m_max_cache_bytes) {
+    return;
+  }
+
+  erase(object_no, object_off, length);
+  while (m_cache_bytes + length > m_max_cache_bytes && !m_lru.empty()) {
+    erase(m_cache.find(m_lru.front()), true);
+  }
+
+  auto key = std::make_pair(object_no, object_off);
+  auto& entry = m_cache[key];
+  entry.snap_id = snap_id;
+  entry.bl = std::move(bl);
+  entry.stream = stream;
+  entry.lru_it = m_lru.insert(m_lru.end(), key);
+  m_cache_bytes += length;
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::erase(typename Cache::iterator it,
+                                      bool evicted) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  auto& entry = it->second;
+  if (evicted && entry.consumed == 0) {
+    // prefetched too far ahead (or for a stream that went away)
+    auto& stream = m_streams[entry.stream];
+    stream.window = std::max(stream.window / 2, m_min_window);
+    m_image_ctx->perfcounter->inc(l_librbd_prefetch_wasted_bytes,
+                                  entry.bl.length());
+  }
+  m_cache_bytes -= entry.bl.length();
+  m_lru.erase(entry.lru_it);
+  m_cache.erase(it);
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::erase(uint64_t object_no, uint64_t object_off,
+                                      uint64_t object_len) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  auto it = m_cache.upper_bound({object_no, object_off});
+  if (it != m_cache.begin()) {
+    auto prev = std::prev(it);
+    if (prev->first.first == object_no &&
+        prev->first.second + prev->second.bl.length() > object_off) {
+      it = prev;
+    }
+  }
+  while (it != m_cache.end() && it->first.first == object_no &&
+         it->first.second < object_off + object_len) {
+    erase(it++, false);
+  }
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::start_write(uint64_t object_no,
+                                            uint64_t object_off,
+                                            uint64_t object_len,
+                                            Context** on_finish) {
+  std::lock_guard locker{m_lock};
+  invalidate(object_no, object_off, object_len);
+
+  // no prefetch of the extent is issued until the write completes
+  auto it = m_in_flight_writes.emplace(
+    object_no, std::make_pair(object_off, object_len));
+  *on_finish = new LambdaContext([this, it, ctx=*on_finish](int r) {
+      finish_write(it);
+      ctx->complete(r);
+    });
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::finish_write(
+    typename InFlightWrites::iterator it) {
+  std::lock_guard locker{m_lock};
+  auto object_no = it->first;
+  auto [object_off, object_len] = it->second;
+  m_in_flight_writes.erase(it);
+  invalidate(object_no, object_off, object_len);
+}
+
+template <typename I>
+void PrefetchObjectDispatch<I>::invalidate(uint64_t object_no,
+                                           uint64_t object_off,
+                                           uint64_t object_len) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+  erase(object_no, object_off, object_len);
+  for (auto req : m_in_flight) {
+    if (req->object_no == object_no &&
+        req->object_off < object_off + object_len &&
+        object_off < req->object_off + req->object_len) {
+      req->stale = true;
+    }
+  }
+}
+
+} // namespace cache
+} // namespace librbd
+
+template class librbd::cache::PrefetchObjectDispatch<librbd::ImageCtx>;
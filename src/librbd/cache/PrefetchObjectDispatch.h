@@ -0,0 +1,208 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#ifndef CEPH_LIBRBD_CACHE_PREFETCH_OBJECT_DISPATCH_H
+#define CEPH_LIBRBD_CACHE_PREFETCH_OBJECT_DISPATCH_H
+
+#include "librbd/io/ObjectDispatchInterface.h"
+#include "common/AsyncOpTracker.h"
+#include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
+#include "librbd/io/Types.h"
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+struct Context;
+
+namespace librbd {
+
+struct ImageCtx;
+
+namespace io { struct ObjectDispatchSpec; }
+
+namespace cache {
+
+/**
+ * Sequential read prefetcher.
+ *
+ * Tracks a small number of concurrent sequential read streams per image
+ * (in image offset space, so streams crossing object boundaries are
+ * followed) and, once a stream has issued enough sequential requests,
+ * reads ahead of it into a bounded cache of object extents.  Each stream
+ * has its own prefetch window which grows while prefetched data is being
+ * consumed or arrives too late for the bandwidth-delay product of the
+ * stream, and shrinks when prefetched data is evicted without being read.
+ */
+template <typename ImageCtxT = ImageCtx>
+class PrefetchObjectDispatch : public io::ObjectDispatchInterface {
+public:
+  static PrefetchObjectDispatch* create(ImageCtxT* image_ctx) {
+    return new PrefetchObjectDispatch(image_ctx);
+  }
+
+  PrefetchObjectDispatch(ImageCtxT* image_ctx);
+  ~PrefetchObjectDispatch() override;
+
+  io::ObjectDispatchLayer get_dispatch_layer() const override {
+    return io::OBJECT_DISPATCH_LAYER_PREFETCH;
+  }
+
+  void init();
+  void shut_down(Context* on_finish) override;
+
+  bool read(
+      uint64_t object_no, io::ReadExtents* extents, IOContext io_context,
+      int op_flags, int read_flags, const ZTracer::Trace &parent_trace,
+      uint64_t* version, int* object_dispatch_flags,
+      io::DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override;
+
+  bool discard(
+      uint64_t object_no, uint64_t object_off, uint64_t object_len,
+      IOContext io_context, int discard_flags,
+      const ZTracer::Trace &parent_trace, int* object_dispatch_flags,
+      uint64_t* journal_tid, io::DispatchResult* dispatch_result,
+      Context** on_finish, Context* on_dispatched) override;
+
+  bool write(
+      uint64_t object_no, uint64_t object_off, ceph::bufferlist&& data,
+      IOContext io_context, int op_flags, int write_flags,
+      std::optional<uint64_t> assert_version,
+      const ZTracer::Trace &parent_trace, int* object_dispatch_flags,
+      uint64_t* journal_tid, io::DispatchResult* dispatch_result,
+      Context** on_finish, Context* on_dispatched) override;
+
+  bool write_same(
+      uint64_t object_no, uint64_t object_off, uint64_t object_len,
+      io::LightweightBufferExtents&& buffer_extents, ceph::bufferlist&& data,
+      IOContext io_context, int op_flags,
+      const ZTracer::Trace &parent_trace, int* object_dispatch_flags,
+      uint64_t* journal_tid, io::DispatchResult* dispatch_result,
+      Context** on_finish, Context* on_dispatched) override;
+
+  bool compare_and_write(
+      uint64_t object_no, uint64_t object_off, ceph::bufferlist&& cmp_data,
+      ceph::bufferlist&& write_data, IOContext io_context, int op_flags,
+      const ZTracer::Trace &parent_trace, uint64_t* mismatch_offset,
+      int* object_dispatch_flags, uint64_t* journal_tid,
+      io::DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override;
+
+  bool flush(
+      io::FlushSource flush_source, const ZTracer::Trace &parent_trace,
+      uint64_t* journal_tid, io::DispatchResult* dispatch_result,
+      Context** on_finish, Context* on_dispatched) override {
+    return false;
+  }
+
+  bool list_snaps(
+      uint64_t object_no, io::Extents&& extents, io::SnapIds&& snap_ids,
+      int list_snap_flags, const ZTracer::Trace &parent_trace,
+      io::SnapshotDelta* snapshot_delta, int* object_dispatch_flags,
+      io::DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override {
+    return false;
+  }
+
+  bool invalidate_cache(Context* on_finish) override;
+
+  bool reset_existence_cache(Context* on_finish) override {
+    return false;
+  }
+
+  void extent_overwritten(
+      uint64_t object_no, uint64_t object_off, uint64_t object_len,
+      uint64_t journal_tid, uint64_t new_journal_tid) override {
+  }
+
+  int prepare_copyup(
+      uint64_t object_no,
+      io::SnapshotSparseBufferlist* snapshot_sparse_bufferlist) override {
+    return 0;
+  }
+
+private:
+  struct C_PrefetchRead;
+
+  struct Stream {
+    uint64_t next_offset = 0;     ///< image offset expected next
+    uint64_t prefetched_to = 0;   ///< image offset prefetch was issued up to
+    uint64_t window = 0;          ///< current prefetch window (bytes)
+    uint64_t sequential = 0;      ///< consecutive sequential requests
+    uint64_t last_used = 0;       ///< request tick for stream replacement
+    ceph::mono_time last_read;    ///< time of the previous request
+    double bandwidth = 0;         ///< EWMA of consumption rate (bytes/sec)
+  };
+
+  struct CachedExtent {
+    snap_t snap_id;
+    ceph::bufferlist bl;
+    uint64_t consumed = 0;
+    size_t stream = 0;
+    std::list<std::pair<uint64_t, uint64_t>>::iterator lru_it;
+  };
+
+  // (object_no, object_off) -> cached extent
+  typedef std::map<std::pair<uint64_t, uint64_t>, CachedExtent> Cache;
+
+  ImageCtxT* m_image_ctx;
+
+  uint64_t m_max_streams;
+  uint64_t m_trigger_requests;
+  uint64_t m_min_window;
+  uint64_t m_max_window;
+  uint64_t m_max_cache_bytes;
+
+  ceph::mutex m_lock;
+  std::vector<Stream> m_streams;
+  uint64_t m_tick = 0;
+
+  Cache m_cache;
+  std::list<std::pair<uint64_t, uint64_t>> m_lru;
+  uint64_t m_cache_bytes = 0;
+
+  std::set<C_PrefetchRead*> m_in_flight;
+  uint64_t m_in_flight_bytes = 0;
+  double m_avg_latency = 0;       ///< EWMA of prefetch read latency (sec)
+
+  // object_no -> (object_off, object_len) of dispatched writes that have
+  // not completed yet
+  typedef std::multimap<uint64_t, std::pair<uint64_t, uint64_t>>
+    InFlightWrites;
+  InFlightWrites m_in_flight_writes;
+
+  AsyncOpTracker m_async_op_tracker;
+
+  size_t get_stream(uint64_t offset, uint64_t length);
+  void update_window(Stream& stream, uint64_t length, bool late);
+  void maybe_prefetch(size_t stream_idx, uint64_t end_offset,
+                      uint64_t image_size, IOContext io_context,
+                      std::vector<io::ObjectDispatchSpec*>* prefetches);
+  void handle_prefetch(C_PrefetchRead* req, int r);
+
+  // copies the cached range into bl, or only checks for it if bl is null
+  bool lookup(uint64_t object_no, snap_t snap_id, uint64_t object_off,
+              uint64_t object_len, ceph::bufferlist* bl);
+  bool is_in_flight(uint64_t object_no, uint64_t object_off,
+                    uint64_t object_len) const;
+  bool is_write_in_flight(uint64_t object_no, uint64_t object_off,
+                          uint64_t object_len) const;
+  void insert(uint64_t object_no, uint64_t object_off, snap_t snap_id,
+              size_t stream, ceph::bufferlist&& bl);
+  void erase(typename Cache::iterator it, bool evicted);
+  void erase(uint64_t object_no, uint64_t object_off, uint64_t object_len);
+  void start_write(uint64_t object_no, uint64_t object_off,
+                   uint64_t object_len, Context** on_finish);
+  void finish_write(typename InFlightWrites::iterator it);
+  void invalidate(uint64_t object_no, uint64_t object_off,
+                  uint64_t object_len);
+};
+
+} // namespace cache
+} // namespace librbd
+
+extern template class librbd::cache::PrefetchObjectDispatch<librbd::ImageCtx>;
+
+#endif // CEPH_LIBRBD_CACHE_PREFETCH_OBJECT_DISPATCH_H
@@ -8,6 +8,10 @@
     
 #include "librbd/io/Types.h"
 #include "librbd/cache/pwl/Types.h"
+#include <map>
+#include <utility>
+
+struct Context;
 
 namespace librbd {
 namespace cache {
@@ -41,6 +45,57 @@ struct SuperBlock{
   }
 };
 
+/*
+ * Log append batches are laid out in the ring in order, but several of
+ * them may be written to the device concurrently and complete out of
+ * order.  A batch that completes early is parked until all of the earlier
+ * batches have completed, so that the pool root (first_free_entry) only
+ * ever advances over persisted entries, and in order.
+ */
+class AppendBatches {
+public:
+  explicit AppendBatches(uint64_t max_in_flight)
+    : m_max_in_flight(max_in_flight) {
+  }
+
+  bool can_start() const {
+    return m_in_flight < m_max_in_flight;
+  }
+  uint64_t get_in_flight() const {
+    return m_in_flight;
+  }
+
+  // returns the sequence number of the new batch
+  uint64_t start() {
+    ++m_in_flight;
+    return ++m_last_started;
+  }
+
+  // records that batch seq is persisted up to first_free_entry, and calls
+  // f(first_free_entry, ctx) for it and for the parked batches following
+  // it, in order, once all of the batches before them completed
+  template <typename F>
+  void complete(uint64_t seq, uint64_t first_free_entry, Context *ctx,
+                F&& f) {
+    m_completed[seq] = {first_free_entry, ctx};
+    for (auto it = m_completed.begin();
+         it != m_completed.end() && it->first == m_last_persisted + 1;
+         it = m_completed.erase(it)) {
+      ++m_last_persisted;
+      --m_in_flight;
+      f(it->second.first, it->second.second);
+    }
+  }
+
+private:
+  const uint64_t m_max_in_flight;
+  uint64_t m_in_flight = 0;
+  uint64_t m_last_started = 0;
+  uint64_t m_last_persisted = 0;
+  /* seq -> (first free entry after the batch, root update completion) */
+  std::map<uint64_t, std::pair<uint64_t, Context*>> m_completed;
+};
+
 } // namespace ssd
 } // namespace pwl
 } // namespace cache
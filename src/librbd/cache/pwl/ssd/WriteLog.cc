@@ -55,7 +55,11 @@ WriteLog<I>::WriteLog(
     cache::ImageWritebackInterface& image_writeback,
     plugin::Api<I>& plugin_api)
   : AbstractWriteLog<I>(image_ctx, cache_state, create_builder(),
-                        image_writeback, plugin_api)
+                        image_writeback, plugin_api),
+    m_append_order_lock(ceph::make_mutex(pwl::unique_lock_name(
+      "librbd::cache::pwl::ssd::WriteLog::m_append_order_lock", this))),
+    m_append_batches(image_ctx.config.template get_val<uint64_t>(
+      "rbd_persistent_cache_ssd_append_batches"))
 {
 }
 
@@ -401,7 +405,7 @@ void WriteLog<I>::schedule_append_ops(GenericLogOperations &ops, C_BlockIOReques
     std::lock_guard locker(m_lock);
 
     bool persist_on_flush = this->get_persist_on_flush();
-    need_finisher = !this->m_appending &&
+    need_finisher = m_append_batches.can_start() &&
        ((this->m_ops_to_append.size() >= CONTROL_BLOCK_MAX_LOG_ENTRIES) ||
         !persist_on_flush);
 
@@ -442,15 +446,35 @@ void WriteLog<I>::setup_schedule_append(pwl::GenericLogOperationsVector &ops,
 template <typename I>
 void WriteLog<I>::append_scheduled_ops(void) {
   GenericLogOperations ops;
+  uint64_t seq = 0;
   ldout(m_image_ctx.cct, 20) << dendl;
 
-  bool ops_remain = false;  // unused, no-op variable for SSD
-  bool appending = false;   // unused, no-op variable for SSD
-  this->append_scheduled(ops, ops_remain, appending);
+  // Taking the batch, adding its entries to m_log_entries and laying it
+  // out in the ring must happen in the same order for every batch.
+  std::lock_guard order_locker(m_append_order_lock);
+  {
+    std::lock_guard locker(m_lock);
+    if (m_append_batches.can_start() && this->m_ops_to_append.size()) {
+      auto last_in_batch = this->m_ops_to_append.begin();
+      unsigned int ops_to_append = std::min<size_t>(
+        this->m_ops_to_append.size(), MAX_WRITES_PER_SYNC_POINT);
+      std::advance(last_in_batch, ops_to_append);
+      ops.splice(ops.end(), this->m_ops_to_append,
+                 this->m_ops_to_append.begin(), last_in_batch);
+      this->m_appending = true;
+      seq = m_append_batches.start();
+      ldout(m_image_ctx.cct, 20) << "appending " << ops.size()
+                                 << " as batch " << seq << ", remain "
+                                 << this->m_ops_to_append.size()
+                                 << ", in flight "
+                                 << m_append_batches.get_in_flight()
+                                 << dendl;
+    }
+  }
 
   if (ops.size()) {
     alloc_op_log_entries(ops);
-    append_op_log_entries(ops);
+    append_op_log_entries(ops, seq);
   } else {
     this->m_async_append_ops--;
     this->m_async_op_tracker.finish_op();
@@ -463,7 +487,8 @@ void WriteLog<I>::append_scheduled_ops(void) {
  * of these must already have been persisted to its reserved area.
  */
 template <typename I>
-void WriteLog<I>::append_op_log_entries(GenericLogOperations &ops) {
+void WriteLog<I>::append_op_log_entries(GenericLogOperations &ops,
+                                        uint64_t seq) {
   ceph_assert(!ops.empty());
   ldout(m_image_ctx.cct, 20) << dendl;
   Context *ctx = new LambdaContext([this, ops](int r) {
@@ -493,11 +518,10 @@ void WriteLog<I>::append_op_log_entries(GenericLogOperations &ops) {
   });
   uint64_t *new_first_free_entry = new(uint64_t);
   Context *append_ctx = new LambdaContext(
-    [this, new_first_free_entry, ops, ctx](int r) {
-      std::shared_ptr<WriteLogPoolRoot> new_root;
+    [this, seq, new_first_free_entry, ops, ctx](int r) {
       {
-        ldout(m_image_ctx.cct, 20) << "Finished appending at "
-                                   << *new_first_free_entry << dendl;
+        ldout(m_image_ctx.cct, 20) << "Finished appending batch " << seq
+                                   << " at " << *new_first_free_entry << dendl;
         utime_t now = ceph_clock_now();
         for (auto &operation : ops) {
           operation->log_append_comp_time = now;
@@ -505,13 +529,17 @@ void WriteLog<I>::append_op_log_entries(GenericLogOperations &ops) {
 
         std::lock_guard locker(this->m_log_append_lock);
         std::lock_guard locker1(m_lock);
-        assert(this->m_appending);
-        this->m_appending = false;
-        new_root = std::make_shared<WriteLogPoolRoot>(pool_root);
-        pool_root.first_free_entry = *new_first_free_entry;
-        new_root->first_free_entry = *new_first_free_entry;
+        ceph_assert(this->m_appending);
+        // Advance the root over every batch that is now persisted in order
+        m_append_batches.complete(seq, *new_first_free_entry, ctx,
+          [this](uint64_t first_free_entry, Context *root_ctx) {
+            auto new_root = std::make_shared<WriteLogPoolRoot>(pool_root);
+            pool_root.first_free_entry = first_free_entry;
+            new_root->first_free_entry = first_free_entry;
+            schedule_update_root(new_root, root_ctx);
+          });
         delete new_first_free_entry;
-        schedule_update_root(new_root, ctx);
+        this->m_appending = m_append_batches.get_in_flight() > 0;
       }
       this->m_async_append_ops--;
       this->m_async_op_tracker.finish_op();
@@ -864,7 +892,11 @@ void WriteLog<I>::append_ops(GenericLogOperations &ops, Context *ctx,
   uint64_t bytes_to_free = 0;
   ldout(cct, 20) << "Appending " << ops.size() << " log entries." << dendl;
 
-  *new_first_free_entry = pool_root.first_free_entry;
+  {
+    // batches still in flight have already claimed the ring up to here
+    std::lock_guard locker(m_lock);
+    *new_first_free_entry = m_first_free_entry;
+  }
   AioTransContext* aio = new AioTransContext(cct, ctx);
 
   utime_t now = ceph_clock_now();
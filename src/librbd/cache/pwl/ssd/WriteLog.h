@@ -99,6 +99,14 @@ private:
   WriteLogPoolRootUpdateList m_poolroot_to_update; /* pool root list to update to SSD */
   bool m_updating_pool_root = false;
 
+  /*
+   * Log appends are laid out in the ring in order (under
+   * m_append_order_lock), but up to rbd_persistent_cache_ssd_append_batches
+   * of them may be in flight on the device at once.
+   */
+  ceph::mutex m_append_order_lock;
+  AppendBatches m_append_batches;     /* protected by m_lock */
+
   std::atomic<int> m_async_update_superblock = {0};
   BlockDevice *bdev = nullptr;
   pwl::WriteLogPoolRoot pool_root;
@@ -120,7 +128,7 @@ private:
   void enlist_op_appender();
   bool retire_entries(const unsigned long int frees_per_tx);
   bool has_sync_point_logs(GenericLogOperations &ops);
-  void append_op_log_entries(GenericLogOperations &ops);
+  void append_op_log_entries(GenericLogOperations &ops, uint64_t seq);
   void alloc_op_log_entries(GenericLogOperations &ops);
   void construct_flush_entries(pwl::GenericLogEntries entires_to_flush,
 				DeferredContexts &post_unlock,
@@ -10,6 +10,7 @@
 #include "librbd/PluginRegistry.h"
 #include "librbd/Utils.h"
 #include "librbd/cache/ObjectCacherObjectDispatch.h"
+#include "librbd/cache/PrefetchObjectDispatch.h"
 #include "librbd/cache/WriteAroundObjectDispatch.h"
 #include "librbd/image/CloseRequest.h"
 #include "librbd/image/RefreshRequest.h"
@@ -688,6 +689,13 @@ Context *OpenRequest<I>::finalize(int r) {
         io::SimpleSchedulerObjectDispatch<I>::create(m_image_ctx);
       io_scheduler->init();
     }
+
+    if (m_image_ctx->child == nullptr &&
+        m_image_ctx->config.template get_val<Option::size_t>(
+          "rbd_prefetch_cache_size") > 0) {
+      auto prefetch = cache::PrefetchObjectDispatch<I>::create(m_image_ctx);
+      prefetch->init();
+    }
   }
 
   return m_on_finish;
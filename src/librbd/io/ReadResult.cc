@@ -59,22 +59,12 @@ struct ReadResult::AssembleResultVisitor : public boost::static_visitor<void> {
   }
 
   void operator()(Vector &vector) const {
-    bufferlist bl;
-    destriper.assemble_result(cct, bl, true);
-
-    ldout(cct, 20) << "copying resulting " << bl.length() << " bytes to iovec "
+    ldout(cct, 20) << "copying resulting bytes to iovec "
                    << reinterpret_cast<const void*>(vector.iov) << dendl;
 
-    bufferlist::iterator it = bl.begin();
-    size_t length = bl.length();
-    size_t offset = 0;
-    int idx = 0;
-    for (; offset < length && idx < vector.iov_count; idx++) {
-      size_t len = std::min(vector.iov[idx].iov_len, length - offset);
-      it.copy(len, static_cast<char *>(vector.iov[idx].iov_base));
-      offset += len;
-    }
-    ceph_assert(offset == bl.length());
+    // copy straight into the caller's buffers instead of first assembling
+    // a bufferlist (which allocates and fills buffers for any holes)
+    destriper.assemble_result(cct, vector.iov, vector.iov_count);
   }
 
   void operator()(Bufferlist &bufferlist) const {
@@ -6,8 +6,10 @@
 #include "common/ceph_time.h"
 #include "common/Timer.h"
 #include "common/errno.h"
+#include "common/perf_counters.h"
 #include "librbd/AsioEngine.h"
 #include "librbd/ImageCtx.h"
+#include "librbd/Types.h"
 #include "librbd/Utils.h"
 #include "librbd/io/FlushTracker.h"
 #include "librbd/io/ObjectDispatchSpec.h"
@@ -73,6 +75,7 @@ bool SimpleSchedulerObjectDispatch<I>::ObjectRequests::try_delay_request(
   } else {
     m_io_context = io_context;
     m_op_flags = op_flags;
+    m_delay_start_time = ceph_clock_now();
   }
 
   if (data.length() == 0) {
@@ -146,6 +149,11 @@ void SimpleSchedulerObjectDispatch<I>::ObjectRequests::try_merge_delayed_request
 template <typename I>
 void SimpleSchedulerObjectDispatch<I>::ObjectRequests::dispatch_delayed_requests(
     I *image_ctx, LatencyStats *latency_stats, ceph::mutex *latency_stats_lock) {
+  image_ctx->perfcounter->inc(l_librbd_io_scheduler_dispatched_writes,
+                              m_delayed_requests.size());
+  image_ctx->perfcounter->tinc(l_librbd_io_scheduler_delay,
+                               ceph_clock_now() - m_delay_start_time);
+
   for (auto &it : m_delayed_requests) {
     auto offset = it.first;
     auto &merged_requests = it.second;
@@ -172,6 +180,10 @@ void SimpleSchedulerObjectDispatch<I>::ObjectRequests::dispatch_delayed_requests
     req->send();
   }
 
+  // the entry outlives the dispatch if a write to the object is in flight
+  m_delayed_requests.clear();
+  m_delayed_request_extents.clear();
+  m_object_dispatch_flags = 0;
   m_dispatch_time = {};
 }
 
@@ -183,7 +195,11 @@ SimpleSchedulerObjectDispatch<I>::SimpleSchedulerObjectDispatch(
     m_lock(ceph::make_mutex(librbd::util::unique_lock_name(
       "librbd::io::SimpleSchedulerObjectDispatch::lock", this))),
     m_max_delay(image_ctx->config.template get_val<uint64_t>(
-      "rbd_io_scheduler_simple_max_delay")) {
+      "rbd_io_scheduler_simple_max_delay")),
+    m_batch_max_bytes(image_ctx->config.template get_val<Option::size_t>(
+      "rbd_io_scheduler_simple_batch_max_bytes")),
+    m_batch_max_objects(image_ctx->config.template get_val<uint64_t>(
+      "rbd_io_scheduler_simple_batch_max_objects")) {
   CephContext *cct = m_image_ctx->cct;
   ldout(cct, 5) << "ictx=" << image_ctx << dendl;
 
@@ -290,6 +306,7 @@ bool SimpleSchedulerObjectDispatch<I>::write(
       });
 
     *dispatch_result = DISPATCH_RESULT_COMPLETE;
+    maybe_dispatch_pg_delayed_requests(object_no);
     return true;
   }
 
@@ -384,18 +401,44 @@ bool SimpleSchedulerObjectDispatch<I>::try_delay_write(
     return false;
   }
 
+  bool batch = (m_batch_max_bytes > 0 && data.length() > 0 &&
+                data.length() <= m_batch_max_bytes);
   auto it = m_requests.find(object_no);
   if (it == m_requests.end()) {
-    ldout(cct, 20) << "no pending requests" << dendl;
-    return false;
+    if (!batch) {
+      ldout(cct, 20) << "no pending requests" << dendl;
+      return false;
+    }
+
+    // no write in flight to merge with -- hold the write back so that it
+    // is dispatched together with other small writes to the same PG
+    it = m_requests.insert(
+      {object_no, std::make_shared<ObjectRequests>(object_no)}).first;
   }
 
   auto &object_requests = it->second;
+  if (batch && !object_requests->get_pg()) {
+    uint32_t pg;
+    int r = m_image_ctx->data_ctx.get_object_pg_hash_position2(
+      data_object_name(m_image_ctx, object_no), &pg);
+    if (r == 0) {
+      object_requests->set_pg(pg);
+    }
+  }
+
   bool delayed = object_requests->try_delay_request(
       object_off, std::move(data), io_context, op_flags, object_dispatch_flags,
       on_dispatched);
 
   ldout(cct, 20) << "delayed: " << delayed << dendl;
+  if (delayed) {
+    m_image_ctx->perfcounter->inc(l_librbd_io_scheduler_delayed_writes);
+
+    auto pg = object_requests->get_pg();
+    if (pg) {
+      m_pg_batches[*pg].insert(object_no);
+    }
+  }
 
   // schedule dispatch on the first request added
   if (delayed && !object_requests->is_scheduled_dispatch()) {
@@ -495,6 +538,7 @@ void SimpleSchedulerObjectDispatch<I>::dispatch_delayed_requests(
     return;
   }
 
+  remove_from_pg_batch(object_requests);
   object_requests->dispatch_delayed_requests(m_image_ctx, m_latency_stats.get(),
                                              &m_lock);
 
@@ -505,6 +549,93 @@ void SimpleSchedulerObjectDispatch<I>::dispatch_delayed_requests(
   }
 }
 
+template <typename I>
+void SimpleSchedulerObjectDispatch<I>::dispatch_pg_delayed_requests(
+    uint32_t pg) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+  auto cct = m_image_ctx->cct;
+
+  auto batch_it = m_pg_batches.find(pg);
+  if (batch_it == m_pg_batches.end()) {
+    ldout(cct, 20) << "pg=" << pg << ": not found" << dendl;
+    return;
+  }
+
+  auto object_nos = std::move(batch_it->second);
+  m_pg_batches.erase(batch_it);
+
+  ldout(cct, 20) << "pg=" << pg << ", " << object_nos.size() << " objects"
+                 << dendl;
+
+  // dispatch the whole batch back-to-back and re-arm the timer only once
+  bool reschedule = false;
+  for (auto object_no : object_nos) {
+    auto it = m_requests.find(object_no);
+    if (it == m_requests.end()) {
+      continue;
+    }
+    auto object_requests = it->second;
+    if (object_requests->is_scheduled_dispatch()) {
+      object_requests->dispatch_delayed_requests(
+        m_image_ctx, m_latency_stats.get(), &m_lock);
+      reschedule |= (m_dispatch_queue.front() == object_requests);
+    }
+
+    // an object with a write in flight keeps its entry until that write
+    // completes, so that later writes are still delayed behind it
+    if (object_requests->get_dispatch_seq() == 0) {
+      m_requests.erase(it);
+    }
+  }
+
+  if (reschedule) {
+    schedule_dispatch_delayed_requests();
+  }
+}
+
+template <typename I>
+void SimpleSchedulerObjectDispatch<I>::maybe_dispatch_pg_delayed_requests(
+    uint64_t object_no) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  auto it = m_requests.find(object_no);
+  if (it == m_requests.end()) {
+    return;
+  }
+
+  auto pg = it->second->get_pg();
+  if (!pg) {
+    return;
+  }
+
+  auto batch_it = m_pg_batches.find(*pg);
+  if (batch_it != m_pg_batches.end() &&
+      batch_it->second.size() >= m_batch_max_objects) {
+    dispatch_pg_delayed_requests(*pg);
+  }
+}
+
+template <typename I>
+void SimpleSchedulerObjectDispatch<I>::remove_from_pg_batch(
+    const ObjectRequestsRef &object_requests) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  auto pg = object_requests->get_pg();
+  if (!pg) {
+    return;
+  }
+
+  auto it = m_pg_batches.find(*pg);
+  if (it == m_pg_batches.end()) {
+    return;
+  }
+
+  it->second.erase(object_requests->get_object_no());
+  if (it->second.empty()) {
+    m_pg_batches.erase(it);
+  }
+}
+
 template <typename I>
 void SimpleSchedulerObjectDispatch<I>::schedule_dispatch_delayed_requests() {
   ceph_assert(ceph_mutex_is_locked(m_lock));
@@ -548,7 +679,14 @@ void SimpleSchedulerObjectDispatch<I>::schedule_dispatch_delayed_requests() {
       m_image_ctx->asio_engine->post(
         [this, object_no]() {
           std::lock_guard locker{m_lock};
-          dispatch_delayed_requests(object_no);
+          auto it = m_requests.find(object_no);
+          if (it == m_requests.end() || !it->second->get_pg()) {
+            dispatch_delayed_requests(object_no);
+            return;
+          }
+
+          // the deadline of the oldest write bounds the whole PG batch
+          dispatch_pg_delayed_requests(*it->second->get_pg());
         });
     });
 
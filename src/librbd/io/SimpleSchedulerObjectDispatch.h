@@ -14,6 +14,8 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
 
 namespace librbd {
 
@@ -26,6 +28,12 @@ class LatencyStats;
 
 /**
  * Simple scheduler plugin for object dispatcher layer.
+ *
+ * Small writes to an object with a write already in flight are delayed and
+ * merged with adjacent writes to the same object.  Optionally, small writes
+ * to idle objects are delayed as well and dispatched together with the other
+ * delayed writes targeting the same PG, so that writes spread over
+ * neighbouring objects reach the primary OSD as one burst.
  */
 template <typename ImageCtxT = ImageCtx>
 class SimpleSchedulerObjectDispatch : public ObjectDispatchInterface {
@@ -155,6 +163,14 @@ private:
       return !clock_t::is_zero(m_dispatch_time);
     }
 
+    void set_pg(uint32_t pg) {
+      m_pg = pg;
+    }
+
+    std::optional<uint32_t> get_pg() const {
+      return m_pg;
+    }
+
     size_t delayed_requests_size() const {
       return m_delayed_requests.size();
     }
@@ -175,6 +191,8 @@ private:
     uint64_t m_object_no;
     uint64_t m_dispatch_seq = 0;
     clock_t::time_point m_dispatch_time;
+    utime_t m_delay_start_time;
+    std::optional<uint32_t> m_pg;
     IOContext m_io_context;
     int m_op_flags = 0;
     int m_object_dispatch_flags = 0;
@@ -197,9 +215,12 @@ private:
   SafeTimer *m_timer;
   ceph::mutex *m_timer_lock;
   uint64_t m_max_delay;
+  uint64_t m_batch_max_bytes;
+  uint64_t m_batch_max_objects;
   uint64_t m_dispatch_seq = 0;
 
   Requests m_requests;
+  std::map<uint32_t, std::set<uint64_t>> m_pg_batches;
   std::list<ObjectRequestsRef> m_dispatch_queue;
   Context *m_timer_task = nullptr;
   std::unique_ptr<LatencyStats> m_latency_stats;
@@ -213,6 +234,9 @@ private:
   void dispatch_all_delayed_requests();
   void dispatch_delayed_requests(uint64_t object_no);
   void dispatch_delayed_requests(ObjectRequestsRef object_requests);
+  void dispatch_pg_delayed_requests(uint32_t pg);
+  void maybe_dispatch_pg_delayed_requests(uint64_t object_no);
+  void remove_from_pg_batch(const ObjectRequestsRef &object_requests);
   void register_in_flight_request(uint64_t object_no, const utime_t &start_time,
                                   Context** on_finish);
 
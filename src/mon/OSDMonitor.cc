@@ -5417,7 +5417,8 @@ namespace {
     CSUM_TYPE, CSUM_MAX_BLOCK, CSUM_MIN_BLOCK, FINGERPRINT_ALGORITHM,
     PG_AUTOSCALE_MODE, PG_NUM_MIN, TARGET_SIZE_BYTES, TARGET_SIZE_RATIO,
     PG_AUTOSCALE_BIAS, DEDUP_TIER, DEDUP_CHUNK_ALGORITHM, 
-    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX };
+    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX,
+    COMPRESSION_DICT_ID };
 
   std::set<osd_pool_get_choices>
     subtract_second_from_first(const std::set<osd_pool_get_choices>& first,
@@ -6164,6 +6165,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
       {"compression_required_ratio", COMPRESSION_REQUIRED_RATIO},
       {"compression_max_blob_size", COMPRESSION_MAX_BLOB_SIZE},
       {"compression_min_blob_size", COMPRESSION_MIN_BLOB_SIZE},
+      {"compression_dict_id", COMPRESSION_DICT_ID},
       {"csum_type", CSUM_TYPE},
       {"csum_max_block", CSUM_MAX_BLOCK},
       {"csum_min_block", CSUM_MIN_BLOCK},
@@ -6395,6 +6397,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case COMPRESSION_REQUIRED_RATIO:
 	  case COMPRESSION_MAX_BLOB_SIZE:
 	  case COMPRESSION_MIN_BLOB_SIZE:
+	  case COMPRESSION_DICT_ID:
 	  case CSUM_TYPE:
 	  case CSUM_MAX_BLOCK:
 	  case CSUM_MIN_BLOCK:
@@ -6558,6 +6561,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case COMPRESSION_REQUIRED_RATIO:
 	  case COMPRESSION_MAX_BLOB_SIZE:
 	  case COMPRESSION_MIN_BLOB_SIZE:
+	  case COMPRESSION_DICT_ID:
 	  case CSUM_TYPE:
 	  case CSUM_MAX_BLOCK:
 	  case CSUM_MIN_BLOCK:
@@ -8816,6 +8820,23 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
       //preserve csum_type numeric value
       n = t;
       interr.clear(); 
+    } else if (var == "compression_dict_id") {
+      if (interr.length()) {
+        ss << "error parsing int value '" << val << "': " << interr;
+        return -EINVAL;
+      }
+      if (n < 0 || n > std::numeric_limits<int32_t>::max()) {
+        ss << "compression_dict_id is out of range: '" << val << "'";
+        return -EINVAL;
+      }
+      if (n > 0) {
+        auto zstd = Compressor::create(cct, "zstd");
+        if (!zstd || !zstd->has_dictionary(n)) {
+          ss << "unknown zstd dictionary id " << n
+             << ", it must be loaded from compressor_zstd_dict_dir";
+          return -EINVAL;
+        }
+      }
     } else if (var == "compression_max_blob_size" ||
                var == "compression_min_blob_size" ||
                var == "csum_max_block" ||
@@ -249,6 +249,8 @@ void BlueFS::_init_logger()
 		    "Bytes written to the metadata log",
 		    "j",
 		    PerfCountersBuilder::PRIO_CRITICAL, unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluefs_log_sync_piggybacked, "log_sync_piggybacked",
+		    "Log syncs satisfied by a concurrent flush of the metadata log");
   b.add_u64_counter(l_bluefs_files_written_wal, "files_written_wal",
 		    "Files written to WAL");
   b.add_u64_counter(l_bluefs_files_written_sst, "files_written_sst",
@@ -1648,6 +1650,7 @@ int BlueFS::_replay(bool noop, bool to_stdout)
     log.seq_live = log_seq + 1;
     dirty.seq_live = log_seq + 1;
     log.t.seq = log.seq_live;
+    log.seq_synced = log_seq;
     dirty.seq_stable = log_seq;
   }
 
@@ -2937,6 +2940,17 @@ int BlueFS::_flush_and_sync_log_LD(uint64_t want_seq)
   int64_t available_runway;
   do {
     log.lock.lock();
+    if (want_seq && want_seq <= log.seq_synced) {
+      // Group commit: while we were waiting for log.lock, another thread
+      // wrote and flushed a log transaction covering our seq.
+      uint64_t synced = log.seq_synced;
+      log.lock.unlock();
+      dout(10) << __func__ << " want_seq " << want_seq << " <= seq_synced "
+	       << synced << ", piggybacked" << dendl;
+      _clear_dirty_set_stable_D(synced);
+      logger->inc(l_bluefs_log_sync_piggybacked);
+      return 0;
+    }
     dirty.lock.lock();
     if (want_seq && want_seq <= dirty.seq_stable) {
       dout(10) << __func__ << " want_seq " << want_seq << " <= seq_stable "
@@ -2969,6 +2983,7 @@ int BlueFS::_flush_and_sync_log_LD(uint64_t want_seq)
 
   _flush_and_sync_log_core(available_runway);
   _flush_bdev(log.writer);
+  log.seq_synced = seq;
   logger->set(l_bluefs_log_bytes, log.writer->file->fnode.size);
   //now log.lock is no longer needed
   log.lock.unlock();
@@ -3005,6 +3020,7 @@ int BlueFS::_flush_and_sync_log_jump_D(uint64_t jump_to,
   vselector->add_usage(log.writer->file->vselector_hint, log.writer->file->fnode.size);
 
   _flush_bdev(log.writer);
+  log.seq_synced = seq;
 
   _clear_dirty_set_stable_D(seq);
   _release_pending_allocations(to_release);
@@ -3147,7 +3163,16 @@ int BlueFS::_flush_range_F(FileWriter *h, uint64_t offset, uint64_t length)
     h->file->is_dirty = true;
   }
   if (h->file->fnode.size < offset + length) {
-    h->file->fnode.size = offset + length;
+    if (h->writer_type == WRITER_WAL &&
+	cct->_conf->bluefs_wal_size_to_allocation) {
+      // Publish the whole allocation as file size, so that subsequent
+      // appends into (pre)allocated space don't dirty the file and each
+      // sync doesn't need a metadata log update. Rocksdb WAL recovery
+      // stops at the first stale/garbage record past the real end.
+      h->file->fnode.size = h->file->fnode.get_allocated();
+    } else {
+      h->file->fnode.size = offset + length;
+    }
     h->file->is_dirty = true;
   }
 
@@ -32,6 +32,7 @@ enum {
   l_bluefs_log_bytes,
   l_bluefs_log_compactions,
   l_bluefs_logged_bytes,
+  l_bluefs_log_sync_piggybacked,
   l_bluefs_files_written_wal,
   l_bluefs_files_written_sst,
   l_bluefs_bytes_written_wal,
@@ -346,6 +347,7 @@ private:
   struct {
     ceph::mutex lock = ceph::make_mutex("BlueFS::log.lock");
     uint64_t seq_live = 1;   //seq that log is currently writing to; mirrors dirty.seq_live
+    uint64_t seq_synced = 0; //last seq whose log transaction is on disk
     FileWriter *writer = 0;
     bluefs_transaction_t t;
   } log;
@@ -4206,6 +4206,28 @@ void *BlueStore::MempoolThread::entry()
     if (binned_kv_onode_cache != nullptr) {
       pcm->insert("kv_onode", binned_kv_onode_cache, true);
     }
+    if (store->cache_kv_balance_by_hits) {
+      for (auto& prefix : store->db->get_cache_prefixes()) {
+        if (prefix == PREFIX_OBJ) {
+          continue;
+        }
+        auto c = store->db->get_priority_cache(prefix);
+        if (c != nullptr) {
+          binned_kv_cf_caches[prefix] = c;
+          pcm->insert("kv_" + prefix, c, true);
+        }
+      }
+      kv_partition_caches["kv"] = binned_kv_cache;
+      kv_partitions["kv"].ratio = store->cache_kv_ratio;
+      if (binned_kv_onode_cache != nullptr) {
+        kv_partition_caches["kv_onode"] = binned_kv_onode_cache;
+        kv_partitions["kv_onode"].ratio = store->cache_kv_onode_ratio;
+      }
+      for (auto& [prefix, c] : binned_kv_cf_caches) {
+        kv_partition_caches["kv_" + prefix] = c;
+        kv_partitions["kv_" + prefix];
+      }
+    }
   }
 
   utime_t next_balance = ceph_clock_now();
@@ -4245,6 +4267,9 @@ void *BlueStore::MempoolThread::entry()
       if (binned_kv_onode_cache != nullptr) {
         binned_kv_onode_cache->import_bins(store->kv_onode_bins);
       }
+      for (auto& [prefix, c] : binned_kv_cf_caches) {
+        c->import_bins(store->kv_bins);
+      }
       meta_cache->import_bins(store->meta_bins);
       data_cache->import_bins(store->data_bins);
 
@@ -4262,6 +4287,9 @@ void *BlueStore::MempoolThread::entry()
       if (binned_kv_onode_cache != nullptr) {
         binned_kv_onode_cache->set_cache_ratio(store->cache_kv_onode_ratio);
       }
+      if (!kv_partitions.empty()) {
+        _balance_kv_partitions();
+      }
       meta_cache->set_cache_ratio(store->cache_meta_ratio);
       data_cache->set_cache_ratio(store->cache_data_ratio);
 
@@ -4405,6 +4433,24 @@ void BlueStore::MempoolThread::_update_cache_settings()
                 << dendl;
 }
 
+void BlueStore::MempoolThread::_balance_kv_partitions()
+{
+  // Split the memory reserved for rocksdb between the kv cache partitions
+  // according to their recent hits.
+  for (auto& [name, share] : kv_partitions) {
+    auto& c = kv_partition_caches[name];
+    share.hits = c->get_hits();
+    share.committed = c->get_committed_size();
+  }
+  PriorityCache::balance_by_hits(
+    store->cache_kv_ratio + store->cache_kv_onode_ratio, kv_partitions);
+  for (auto& [name, share] : kv_partitions) {
+    kv_partition_caches[name]->set_cache_ratio(share.ratio);
+    dout(20) << __func__ << " " << name << " hits " << share.hits
+             << " ratio " << share.ratio << dendl;
+  }
+}
+
 // =======================================================
 
 // OmapIteratorImpl
@@ -4865,6 +4911,8 @@ int BlueStore::_set_cache_sizes()
 {
   ceph_assert(bdev);
   cache_autotune = cct->_conf.get_val<bool>("bluestore_cache_autotune");
+  cache_kv_balance_by_hits =
+      cct->_conf.get_val<bool>("bluestore_cache_kv_balance_by_hits");
   cache_autotune_interval =
       cct->_conf.get_val<double>("bluestore_cache_autotune_interval");
   cache_age_bin_interval =
@@ -5186,6 +5234,13 @@ void BlueStore::_init_logger()
 	    "Sum for beneficial compress ops");
   b.add_u64_counter(l_bluestore_compress_rejected_count, "compress_rejected_count",
 	    "Sum for compress ops rejected due to low net gain of space");
+  b.add_u64_counter(l_bluestore_decompress_avoided_bytes,
+	    "decompress_avoided_bytes",
+	    "Sum for bytes of compressed blobs read from the buffer cache "
+	    "without decompression",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
   //****************************************
 
   // onode cache stats
@@ -10791,6 +10846,7 @@ void BlueStore::_read_cache(
   // build blob-wise list to of stuff read (that isn't cached)
   unsigned left = length;
   uint64_t pos = offset;
+  uint64_t decompress_avoided = 0;
   auto lp = o->extent_map.seek_lextent(offset);
   while (left > 0 && lp != o->extent_map.extent_map.end()) {
     if (pos < lp->logical_offset) {
@@ -10825,6 +10881,9 @@ void BlueStore::_read_cache(
       if (pc != cache_res.end() &&
           pc->first == b_off) {
         l = pc->second.length();
+        if (bptr->get_blob().is_compressed()) {
+          decompress_avoided += l;
+        }
         ready_regions[pos] = std::move(pc->second);
         dout(30) << __func__ << "    use cache 0x" << std::hex << pos << ": 0x"
                  << b_off << "~" << l << std::dec << dendl;
@@ -10875,6 +10934,9 @@ void BlueStore::_read_cache(
     }
     ++lp;
   }
+  if (decompress_avoided) {
+    logger->inc(l_bluestore_decompress_avoided_bytes, decompress_avoided);
+  }
 }
 
 int BlueStore::_prepare_read_ioc(
@@ -10946,6 +11008,22 @@ int BlueStore::_prepare_read_ioc(
   return 0;
 }
 
+bool BlueStore::_cache_decompressed_blobs(
+  bool buffered,
+  uint32_t op_flags,
+  const IOContext& ioc) const
+{
+  if (ioc.skip_cache()) {
+    return false;
+  }
+  // decompression is expensive, so keep decompressed blobs cached even if
+  // plain reads aren't buffered by default, unless the client objects.
+  return buffered ||
+    (cct->_conf->bluestore_cache_decompressed_blobs &&
+     (op_flags & (CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
+		  CEPH_OSD_OP_FLAG_FADVISE_NOCACHE)) == 0);
+}
+
 int BlueStore::_generate_read_result_bl(
   OnodeRef o,
   uint64_t offset,
@@ -10954,6 +11032,7 @@ int BlueStore::_generate_read_result_bl(
   vector<bufferlist>& compressed_blob_bls,
   blobs2read_t& blobs2read,
   bool buffered,
+  bool buffered_compressed,
   bool* csum_error,
   bufferlist& bl)
 {
@@ -10977,7 +11056,9 @@ int BlueStore::_generate_read_result_bl(
       auto r = _decompress(compressed_bl, &raw_bl);
       if (r < 0)
         return r;
-      if (buffered) {
+      if (buffered_compressed) {
+        // keep the whole decompressed blob so that subsequent reads of
+        // any part of it don't need to decompress it again.
         bptr->shared_blob->bc.did_read(bptr->shared_blob->get_cache(), 0,
                                        raw_bl);
       }
@@ -11133,6 +11214,7 @@ int BlueStore::_do_read(
   r = _generate_read_result_bl(o, offset, length, ready_regions,
                               compressed_blob_bls, blobs2read,
                               buffered && !ioc.skip_cache(),
+                              _cache_decompressed_blobs(buffered, op_flags, ioc),
                               &csum_error, bl);
   if (csum_error) {
     // Handles spurious read errors caused by a kernel bug.
@@ -11493,7 +11575,9 @@ int BlueStore::_do_readv(
                                  std::get<0>(raw_results[i]),
                                  std::get<1>(raw_results[i]),
                                  std::get<2>(raw_results[i]),
-                                 buffered, &csum_error, t);
+                                 buffered,
+                                 _cache_decompressed_blobs(buffered, op_flags, ioc),
+                                 &csum_error, t);
     if (csum_error) {
       // Handles spurious read errors caused by a kernel bug.
       // We sometimes get all-zero pages as a result of the read under
@@ -15423,6 +15507,7 @@ int BlueStore::_do_alloc_write(
 
   CompressorRef c;
   double crr = 0;
+  std::optional<int32_t> comp_dict_id;
   if (wctx->compress) {
     c = select_option(
       "compression_algorithm",
@@ -15457,6 +15542,13 @@ int BlueStore::_do_alloc_write(
         return std::optional<double>();
       }
     );
+
+    if (c && c->get_type() == Compressor::COMP_ALG_ZSTD) {
+      int64_t val;
+      if (coll->pool_opts.get(pool_opts_t::COMPRESSION_DICT_ID, &val)) {
+        comp_dict_id = val;
+      }
+    }
   }
 
   // checksum
@@ -15486,7 +15578,7 @@ int BlueStore::_do_alloc_write(
 
       // FIXME: memory alignment here is bad
       bufferlist t;
-      std::optional<int32_t> compressor_message;
+      std::optional<int32_t> compressor_message = comp_dict_id;
       int r = c->compress(wi.bl, t, compressor_message);
       uint64_t want_len_raw = wi.blob_length * crr;
       uint64_t want_len = p2roundup(want_len_raw, min_alloc_size);
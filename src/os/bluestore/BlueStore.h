@@ -159,6 +159,7 @@ enum {
   l_bluestore_decompress_lat,
   l_bluestore_compress_success_count,
   l_bluestore_compress_rejected_count,
+  l_bluestore_decompress_avoided_bytes,
   //****************************************
 
   // onode cache stats
@@ -2281,6 +2282,7 @@ private:
   double cache_kv_onode_ratio = 0; ///< cache ratio dedicated to kv onodes (e.g., rocksdb onode CF)
   double cache_data_ratio = 0;   ///< cache ratio dedicated to object data
   bool cache_autotune = false;   ///< cache autotune setting
+  bool cache_kv_balance_by_hits = false; ///< split kv cache memory by CF hit rates
   double cache_age_bin_interval = 0; ///< time to wait between cache age bin rotations
   double cache_autotune_interval = 0; ///< time to wait between cache rebalancing
   std::vector<uint64_t> kv_bins; ///< kv autotune bins
@@ -2312,8 +2314,16 @@ private:
     bool stop = false;
     std::shared_ptr<PriorityCache::PriCache> binned_kv_cache = nullptr;
     std::shared_ptr<PriorityCache::PriCache> binned_kv_onode_cache = nullptr;
+    /// block caches of the remaining column families, keyed by prefix
+    std::map<std::string, std::shared_ptr<PriorityCache::PriCache>>
+      binned_kv_cf_caches;
     std::shared_ptr<PriorityCache::Manager> pcm = nullptr;
 
+    /// kv cache partitions for hit driven balancing
+    std::map<std::string, std::shared_ptr<PriorityCache::PriCache>>
+      kv_partition_caches;
+    std::map<std::string, PriorityCache::HitShare> kv_partitions;
+
     struct MempoolCache : public PriorityCache::PriCache {
       BlueStore *store;
       uint64_t bins[PriorityCache::Priority::LAST+1] = {0};
@@ -2533,6 +2543,7 @@ private:
   private:
     void _update_cache_settings();
     void _resize_shards(bool interval_stats);
+    void _balance_kv_partitions();
   } mempool_thread;
 
 #ifdef WITH_BLKIN
@@ -3003,6 +3014,11 @@ private:
     std::vector<ceph::buffer::list>* compressed_blob_bls,
     IOContext* ioc);
 
+  bool _cache_decompressed_blobs(
+    bool buffered,
+    uint32_t op_flags,
+    const IOContext& ioc) const;
+
   int _generate_read_result_bl(
     OnodeRef o,
     uint64_t offset,
@@ -3011,6 +3027,7 @@ private:
     std::vector<ceph::buffer::list>& compressed_blob_bls,
     blobs2read_t& blobs2read,
     bool buffered,
+    bool buffered_compressed,
     bool* csum_error,
     ceph::buffer::list& bl);
 
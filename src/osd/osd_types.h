@@ -1074,6 +1074,7 @@ public:
     DEDUP_CHUNK_ALGORITHM,
     DEDUP_CDC_CHUNK_SIZE,
     PG_NUM_MAX, // max pg_num
+    COMPRESSION_DICT_ID, // zstd dictionary id used for blob compression
   };
 
   enum type_t {
@@ -406,7 +406,7 @@ void Objecter::init()
  */
 void Objecter::start(const OSDMap* o)
 {
-  shared_lock rl(rwlock);
+  unique_lock wl(rwlock);
 
   start_tick();
   if (o) {
@@ -2267,6 +2267,12 @@ void Objecter::resend_mon_ops()
 
 void Objecter::op_submit(Op *op, ceph_tid_t *ptid, int *ctx_budget)
 {
+  // the pg mapping cache is read without a lock of its own, but submission
+  // still takes rwlock shared: _calc_target() reads the osdmap, which
+  // handle_osd_map() updates in place, and _op_submit() looks up and links
+  // the op to its session, which must not race with the rescan of the
+  // sessions after a map change.  submitting against a published osdmap
+  // snapshot instead would need both of these to be reworked.
   shunique_lock rl(rwlock, ceph::acquire_shared);
   ceph_tid_t tid = 0;
   if (!ptid)
@@ -5028,6 +5034,13 @@ Objecter::~Objecter()
 
   ceph_assert(!m_request_state_hook);
   ceph_assert(!logger);
+
+  for (auto& [pool, mapping_array] : pg_mappings) {
+    _clear_pg_mapping_slots(mapping_array);
+  }
+  for (auto m : pg_mapping_retired) {
+    delete m;
+  }
 }
 
 /**
@@ -15,6 +15,7 @@
 #ifndef CEPH_OBJECTER_H
 #define CEPH_OBJECTER_H
 
+#include <atomic>
 #include <condition_variable>
 #include <list>
 #include <map>
@@ -1676,55 +1677,92 @@ private:
                : epoch(epoch), up(up), up_primary(up_primary),
                  acting(acting), acting_primary(acting_primary) {}
   };
-  ceph::shared_mutex pg_mapping_lock =
-    ceph::make_shared_mutex("Objecter::pg_mapping_lock");
   // pool -> pg mapping
-  std::map<int64_t, std::vector<pg_mapping_t>> pg_mappings;
+  //
+  // The cache is read on every op submission, so lookups take no lock of
+  // their own.  Published entries are immutable; a (re)computed mapping is
+  // installed with an atomic exchange while rwlock is held shared and the
+  // entry it replaces is retired.  Retired entries, the per-pool slot
+  // arrays and the pool map itself are only freed or modified while rwlock
+  // is held unique, which is the grace period: no reader can still be
+  // looking at them then.
+  struct pg_mapping_slots_t {
+    std::unique_ptr<std::atomic<pg_mapping_t*>[]> slots;
+    size_t size = 0;
+  };
+  std::map<int64_t, pg_mapping_slots_t> pg_mappings;
+  ceph::mutex pg_mapping_retired_lock =
+    ceph::make_mutex("Objecter::pg_mapping_retired_lock");
+  std::vector<pg_mapping_t*> pg_mapping_retired;
 
   // convenient accessors
+  // rwlock is locked
   bool lookup_pg_mapping(const pg_t& pg, epoch_t epoch, std::vector<int> *up,
                          int *up_primary, std::vector<int> *acting,
                          int *acting_primary) {
-    std::shared_lock l{pg_mapping_lock};
     auto it = pg_mappings.find(pg.pool());
     if (it == pg_mappings.end())
       return false;
     auto& mapping_array = it->second;
-    if (pg.ps() >= mapping_array.size())
+    if (pg.ps() >= mapping_array.size)
       return false;
-    if (mapping_array[pg.ps()].epoch != epoch) // stale
+    auto pg_mapping = mapping_array.slots[pg.ps()].load(
+      std::memory_order_acquire);
+    if (!pg_mapping || pg_mapping->epoch != epoch) // stale
       return false;
-    auto& pg_mapping = mapping_array[pg.ps()];
-    *up = pg_mapping.up;
-    *up_primary = pg_mapping.up_primary;
-    *acting = pg_mapping.acting;
-    *acting_primary = pg_mapping.acting_primary;
+    *up = pg_mapping->up;
+    *up_primary = pg_mapping->up_primary;
+    *acting = pg_mapping->acting;
+    *acting_primary = pg_mapping->acting_primary;
     return true;
   }
+  // rwlock is locked
   void update_pg_mapping(const pg_t& pg, pg_mapping_t&& pg_mapping) {
-    std::lock_guard l{pg_mapping_lock};
-    auto& mapping_array = pg_mappings[pg.pool()];
-    ceph_assert(pg.ps() < mapping_array.size());
-    mapping_array[pg.ps()] = std::move(pg_mapping);
+    auto it = pg_mappings.find(pg.pool());
+    ceph_assert(it != pg_mappings.end());
+    auto& mapping_array = it->second;
+    ceph_assert(pg.ps() < mapping_array.size);
+    auto old = mapping_array.slots[pg.ps()].exchange(
+      new pg_mapping_t(std::move(pg_mapping)), std::memory_order_acq_rel);
+    if (old) {
+      std::lock_guard l{pg_mapping_retired_lock};
+      pg_mapping_retired.push_back(old);
+    }
   }
+  // rwlock is locked unique
   void prune_pg_mapping(const mempool::osdmap::map<int64_t,pg_pool_t>& pools) {
-    std::lock_guard l{pg_mapping_lock};
     for (auto& pool : pools) {
       auto& mapping_array = pg_mappings[pool.first];
       size_t pg_num = pool.second.get_pg_num();
-      if (mapping_array.size() != pg_num) {
+      if (mapping_array.size != pg_num) {
         // catch both pg_num increasing & decreasing
-        mapping_array.resize(pg_num);
+        _clear_pg_mapping_slots(mapping_array);
+        mapping_array.slots.reset(new std::atomic<pg_mapping_t*>[pg_num]);
+        for (size_t i = 0; i < pg_num; ++i) {
+          mapping_array.slots[i] = nullptr;
+        }
+        mapping_array.size = pg_num;
       }
     }
     for (auto it = pg_mappings.begin(); it != pg_mappings.end(); ) {
       if (!pools.count(it->first)) {
         // pool is gone
+        _clear_pg_mapping_slots(it->second);
         pg_mappings.erase(it++);
         continue;
       }
       it++;
     }
+    std::lock_guard l{pg_mapping_retired_lock};
+    for (auto m : pg_mapping_retired) {
+      delete m;
+    }
+    pg_mapping_retired.clear();
+  }
+  void _clear_pg_mapping_slots(pg_mapping_slots_t& mapping_array) {
+    for (size_t i = 0; i < mapping_array.size; ++i) {
+      delete mapping_array.slots[i].exchange(nullptr);
+    }
   }
 
 public:
@@ -14,6 +14,8 @@
 
 #include "Striper.h"
 
+#include <sys/uio.h>
+
 #include "include/types.h"
 #include "include/buffer.h"
 #include "osd/OSDMap.h"
@@ -519,6 +521,51 @@ void Striper::StripedReadResult::assemble_result(CephContext *cct, char *buffer,
   ceph_assert(curr == 0);
 }
 
+void Striper::StripedReadResult::assemble_result(CephContext *cct,
+						 const struct iovec *iov,
+						 int iov_count)
+{
+  ldout(cct, 10) << "assemble_result(" << this << ") " << total_intended_len
+		 << " bytes to " << iov_count << " iovecs" << dendl;
+
+  int idx = 0;
+  size_t iov_off = 0;
+  // copy len bytes from it (or zeros if null) to the current iovec position
+  auto fill = [&](bufferlist::const_iterator *it, size_t len) {
+    while (len > 0) {
+      ceph_assert(idx < iov_count);
+      size_t n = std::min(len, iov[idx].iov_len - iov_off);
+      char *dst = static_cast<char*>(iov[idx].iov_base) + iov_off;
+      if (it) {
+	it->copy(n, dst);
+      } else {
+	// FIPS zeroization audit 20191117: this memset is not security related.
+	memset(dst, 0, n);
+      }
+      len -= n;
+      iov_off += n;
+      if (iov_off == iov[idx].iov_len) {
+	++idx;
+	iov_off = 0;
+      }
+    }
+  };
+
+  for (auto& p : partial) {
+    auto& bl = p.second.first;
+    size_t got = bl.length();
+    size_t expect = p.second.second;
+    if (got) {
+      auto it = std::cbegin(bl);
+      fill(&it, got);
+    }
+    if (expect > got) {
+      fill(nullptr, expect - got);
+    }
+  }
+  partial.clear();
+}
+
 uint64_t Striper::StripedReadResult::assemble_result(
     CephContext *cct, std::map<uint64_t, uint64_t> *extent_map,
     bufferlist *bl)
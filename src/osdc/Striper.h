@@ -20,6 +20,7 @@
 #include "osd/osd_types.h"
 #include "osdc/StriperTypes.h"
 
+struct iovec;
 
 //namespace ceph {
 
@@ -120,6 +121,15 @@
        */
       void assemble_result(CephContext *cct, char *buffer, size_t len);
 
+      /**
+       * copy read data into the iovec, zero-filling holes in place
+       *
+       * @iov the buffers to fill in order
+       * @iov_count the number of buffers
+       */
+      void assemble_result(CephContext *cct, const struct iovec *iov,
+                           int iov_count);
+
       uint64_t assemble_result(CephContext *cct,
                                std::map<uint64_t, uint64_t> *extent_map,
                                ceph::buffer::list *bl);
@@ -396,6 +396,8 @@ void usage()
   cout << "   --data-extra-pool=<pool>  placement target data extra (non-ec) pool\n";
   cout << "   --placement-index-type=<type>\n";
   cout << "                             placement target index type (normal, indexless, or #id)\n";
+  cout << "   --overlap-index-prepare[=false]\n";
+  cout << "                             set/reset whether PUTs send the bucket index prepare along with the head write\n";
   cout << "   --compression=<type>      placement target compression type (plugin name or empty/none)\n";
   cout << "   --tier-type=<type>        zone tier type\n";
   cout << "   --tier-config=<k>=<v>[,...]\n";
@@ -3611,6 +3613,8 @@ int main(int argc, const char **argv)
   boost::optional<string> data_extra_pool;
   rgw::BucketIndexType placement_index_type = rgw::BucketIndexType::Normal;
   bool index_type_specified = false;
+  int overlap_index_prepare = false;
+  bool overlap_index_prepare_specified = false;
 
   boost::optional<std::string> compression_type;
 
@@ -4059,6 +4063,8 @@ int main(int argc, const char **argv)
         }
       }
       index_type_specified = true;
+    } else if (ceph_argparse_binary_flag(args, i, &overlap_index_prepare, NULL, "--overlap-index-prepare", (char*)NULL)) {
+      overlap_index_prepare_specified = true;
     } else if (ceph_argparse_witharg(args, i, &val, "--compression", (char*)NULL)) {
       compression_type = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--role-name", (char*)NULL)) {
@@ -6357,6 +6363,9 @@ int main(int argc, const char **argv)
           if (index_type_specified) {
 	    info.index_type = placement_index_type;
           }
+          if (overlap_index_prepare_specified) {
+            info.overlap_index_prepare = overlap_index_prepare;
+          }
 
           ret = check_pool_support_omap(info.get_data_extra_pool());
           if (ret < 0) {
@@ -13,12 +13,17 @@
  *
  */
 
+#include <optional>
 #include <type_traits>
+#include <vector>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
 #include "include/rados/librados.hpp"
 #include "librados/librados_asio.h"
 
 #include "rgw_aio.h"
 #include "rgw_d3n_cacherequest.h"
+#include "rgw_perf_counters.h"
 
 namespace rgw {
 
@@ -135,4 +140,119 @@ Aio::OpFunc Aio::d3n_cache_op(const DoutPrefixProvider *dpp, optional_yield y,
   return d3n_cache_aio_abstract(dpp, y, read_ofs, read_len, location);
 }
 
+struct ReadCoalescer::Flight {
+  struct Waiter {
+    Aio* aio;
+    AioResult* r;
+    // the strand of the waiter's coroutine, which must run its completion.
+    // the work guard keeps its io_context running until then
+    using Executor = boost::asio::strand<boost::asio::io_context::executor_type>;
+    std::optional<boost::asio::executor_work_guard<Executor>> work;
+  };
+  std::vector<Waiter> waiters;
+};
+
+struct ReadCoalescer::Read {
+  ReadCoalescer* coalescer;
+  Key key;
+  librados::AioCompletion* c = nullptr;
+  bufferlist data;
+};
+
+Aio::OpFunc ReadCoalescer::read_op(const rgw_raw_obj& obj, uint64_t ofs,
+                                   uint64_t len, optional_yield y)
+{
+  return [this, key = Key{obj, ofs, len}, y] (Aio* aio, AioResult& r) mutable {
+      join(std::move(key), aio, r, y);
+    };
+}
+
+void ReadCoalescer::join(Key&& key, Aio* aio, AioResult& r, optional_yield y)
+{
+  Flight::Waiter waiter{aio, &r};
+  if (y) {
+    using namespace boost::asio;
+    async_completion<yield_context, void()> init(y.get_yield_context());
+    waiter.work.emplace(make_work_guard(
+        get_associated_executor(init.completion_handler)));
+  }
+
+  std::unique_lock lock{mutex};
+  auto [i, inserted] = flights.try_emplace(std::move(key));
+  i->second.waiters.push_back(std::move(waiter));
+  if (!inserted) {
+    lock.unlock();
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_get_obj_coalesced);
+    }
+    return;
+  }
+  // the key stays valid until the flight finishes
+  const Key& flight_key = i->first;
+  lock.unlock();
+  if (perfcounter) {
+    perfcounter->inc(l_rgw_get_obj_coalesce_reads);
+  }
+
+  int ret = send_read(r.obj, flight_key);
+  if (ret < 0) {
+    finish(flight_key, ret, {});
+  }
+}
+
+int ReadCoalescer::send_read(RGWSI_RADOS::Obj& obj, const Key& key)
+{
+  // the read isn't tied to the caller's request, which may finish before
+  // the other waiters do
+  const auto& [raw_obj, ofs, len] = key;
+  librados::ObjectReadOperation op;
+  op.read(ofs, len, nullptr, nullptr);
+  auto read = new Read{this, key};
+  read->c = librados::Rados::aio_create_completion(read, &complete);
+  int ret = obj.aio_operate(read->c, &op, &read->data);
+  if (ret < 0) {
+    read->c->release();
+    delete read;
+  }
+  return ret;
+}
+
+void ReadCoalescer::complete(librados::completion_t, void* arg)
+{
+  std::unique_ptr<Read> read{static_cast<Read*>(arg)};
+  const int result = read->c->get_return_value();
+  read->c->release();
+  read->coalescer->finish(read->key, result, read->data);
+}
+
+void ReadCoalescer::finish(const Key& key, int result, const bufferlist& data)
+{
+  // remove the flight first, so no more waiters can join it
+  std::vector<Flight::Waiter> waiters;
+  {
+    std::lock_guard l{mutex};
+    auto i = flights.find(key);
+    if (i == flights.end()) {
+      return;
+    }
+    waiters = std::move(i->second.waiters);
+    flights.erase(i);
+  }
+  for (auto& w : waiters) {
+    if (w.work) {
+      auto ex = w.work->get_executor();
+      boost::asio::post(ex, [aio = w.aio, r = w.r, result, bl = data,
+                             work = std::move(*w.work)] () mutable {
+          r->result = result;
+          r->data = std::move(bl);
+          aio->put(*r);
+        });
+    } else {
+      w.r->result = result;
+      w.r->data = data;
+      w.aio->put(*w.r);
+    }
+  }
+}
+
 } // namespace rgw
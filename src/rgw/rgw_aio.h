@@ -16,7 +16,9 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 
 #include <boost/intrusive/list.hpp>
@@ -28,6 +30,7 @@
 #include "rgw_common.h"
 
 #include "include/function2.hpp"
+#include "common/ceph_mutex.h"
 
 struct D3nGetObjData;
 
@@ -101,4 +104,35 @@ class Aio {
                              off_t read_ofs, off_t read_len, std::string& location);
 };
 
+// joins the concurrent reads of the same range of a rados object, so that a
+// single read is sent to the osds and its data is handed to all the callers.
+// this is only correct for objects that are never modified once written,
+// like the tail objects of rgw
+class ReadCoalescer {
+ public:
+  virtual ~ReadCoalescer() {}
+
+  Aio::OpFunc read_op(const rgw_raw_obj& obj, uint64_t ofs, uint64_t len,
+                      optional_yield y);
+
+ protected:
+  using Key = std::tuple<rgw_raw_obj, uint64_t, uint64_t>;
+
+  // sends the read of a new flight. its result must be passed to finish(),
+  // unless an error is returned
+  virtual int send_read(RGWSI_RADOS::Obj& obj, const Key& key);
+  // hands the result of a read to all of the callers waiting on it
+  void finish(const Key& key, int result, const bufferlist& data);
+
+ private:
+  struct Flight;
+  struct Read;
+
+  ceph::mutex mutex = ceph::make_mutex("rgw::ReadCoalescer");
+  std::map<Key, Flight> flights;
+
+  void join(Key&& key, Aio* aio, AioResult& r, optional_yield y);
+  static void complete(librados::completion_t, void* arg);
+};
+
 } // namespace rgw
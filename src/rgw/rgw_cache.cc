@@ -3,27 +3,149 @@
 
 #include "rgw_cache.h"
 #include "rgw_perf_counters.h"
+#include "common/perf_counters.h"
 
+#include <algorithm>
 #include <errno.h>
 
 #define dout_subsys ceph_subsys_rgw
 
 using namespace std;
 
-int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, uint32_t mask, rgw_cache_entry_info *cache_info)
+static uint64_t sketch_index(uint64_t hash, int i)
+{
+  static constexpr uint64_t seeds[] = {
+    0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+    0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+  };
+  uint64_t h = (hash + seeds[i]) * seeds[i];
+  return h ^ (h >> 32);
+}
+
+void RGWCacheFrequencySketch::init(uint64_t capacity)
+{
+  uint64_t words = 16;
+  while (words < capacity) {
+    words <<= 1;
+  }
+  table = std::vector<std::atomic<uint64_t>>(words);
+  mask = words - 1;
+  sample_size = 10 * std::max<uint64_t>(capacity, 1);
+  additions = 0;
+}
+
+unsigned RGWCacheFrequencySketch::estimate(uint64_t hash) const
+{
+  if (table.empty()) {
+    return 0;
+  }
+  unsigned freq = 15;
+  for (int i = 0; i < 4; ++i) {
+    uint64_t h = sketch_index(hash, i);
+    unsigned shift = ((h >> 58) & 15) << 2;
+    uint64_t word = table[h & mask].load(std::memory_order_relaxed);
+    freq = std::min<unsigned>(freq, (word >> shift) & 15);
+  }
+  return freq;
+}
+
+void RGWCacheFrequencySketch::increment(uint64_t hash)
+{
+  if (table.empty()) {
+    return;
+  }
+  bool added = false;
+  for (int i = 0; i < 4; ++i) {
+    uint64_t h = sketch_index(hash, i);
+    unsigned shift = ((h >> 58) & 15) << 2;
+    auto& slot = table[h & mask];
+    uint64_t word = slot.load(std::memory_order_relaxed);
+    while (((word >> shift) & 15) != 15) {
+      if (slot.compare_exchange_weak(word, word + (1ULL << shift),
+				     std::memory_order_relaxed)) {
+	added = true;
+	break;
+      }
+    }
+  }
+  if (added && ++additions == sample_size) {
+    age();
+  }
+}
+
+void RGWCacheFrequencySketch::age()
+{
+  for (auto& slot : table) {
+    uint64_t word = slot.load(std::memory_order_relaxed);
+    while (!slot.compare_exchange_weak(word,
+				       (word >> 1) & 0x7777777777777777ULL,
+				       std::memory_order_relaxed)) {
+    }
+  }
+  additions -= sample_size / 2;
+}
+
+void ObjectCache::set_ctx(CephContext *_cct)
 {
+  // the shards and their perf counters are registered with the old context
+  remove_shards();
+  cct = _cct;
+  expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
+				  "rgw_cache_expiry_interval"));
+  admission_filter = cct->_conf.get_val<bool>("rgw_cache_admission_filter");
+
+  auto num_shards = std::max<uint64_t>(
+    1, cct->_conf.get_val<uint64_t>("rgw_cache_shards"));
+  shard_capacity = std::max<unsigned long>(
+    1, cct->_conf->rgw_cache_lru_size / num_shards);
+
+  shards.reserve(num_shards);
+  for (uint64_t i = 0; i < num_shards; ++i) {
+    auto& shard = shards.emplace_back(std::make_unique<Shard>());
+    shard->lru_window = shard_capacity / 2;
+    shard->sketch.init(shard_capacity);
+
+    PerfCountersBuilder plb(cct, "rgw_cache_shard." + std::to_string(i),
+			    l_rgw_cache_shard_first, l_rgw_cache_shard_last);
+    plb.add_u64_counter(l_rgw_cache_shard_hit, "hit", "Cache hits");
+    plb.add_u64_counter(l_rgw_cache_shard_miss, "miss", "Cache misses");
+    plb.add_u64_counter(l_rgw_cache_shard_evict, "evict",
+			"Entries evicted from the LRU");
+    plb.add_u64_counter(l_rgw_cache_shard_reject, "reject",
+			"New entries rejected by the admission filter");
+    plb.add_u64(l_rgw_cache_shard_entries, "entries", "Cached entries");
+    shard->logger = plb.create_perf_counters();
+    cct->get_perfcounters_collection()->add(shard->logger);
+  }
+}
 
-  std::shared_lock rl{lock};
-  std::unique_lock wl{lock, std::defer_lock}; // may be promoted to write lock
+static void count_hit(PerfCounters *logger, bool hit)
+{
+  if (perfcounter) {
+    perfcounter->inc(hit ? l_rgw_cache_hit : l_rgw_cache_miss);
+  }
+  if (logger) {
+    logger->inc(hit ? l_rgw_cache_shard_hit : l_rgw_cache_shard_miss);
+  }
+}
+
+int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, uint32_t mask, rgw_cache_entry_info *cache_info)
+{
   if (!enabled) {
     return -ENOENT;
   }
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end()) {
+
+  const uint64_t hash = std::hash<std::string>{}(name);
+  Shard& shard = get_shard(hash);
+  shard.sketch.increment(hash);
+
+  chained_entries_t invalidated;
+  std::shared_lock rl{shard.lock};
+  std::unique_lock wl{shard.lock, std::defer_lock}; // may be promoted to write lock
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end()) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : miss" << dendl;
-    if (perfcounter) {
-      perfcounter->inc(l_rgw_cache_miss);
-    }
+    count_hit(shard.logger, false);
     return -ENOENT;
   }
 
@@ -33,74 +155,96 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
     rl.unlock();
     wl.lock(); // write lock for expiration
     // check that wasn't already removed by other thread
-    iter = cache_map.find(name);
-    if (iter != cache_map.end()) {
-      for (auto &kv : iter->second.chained_entries)
-        kv.first->invalidate(kv.second);
-      remove_lru(name, iter->second.lru_iter);
-      cache_map.erase(iter);
-    }
-    if (perfcounter) {
-      perfcounter->inc(l_rgw_cache_miss);
+    iter = shard.cache_map.find(name);
+    if (iter != shard.cache_map.end()) {
+      invalidate_lru(iter->second, invalidated);
+      remove_lru(shard, name, iter->second.lru_iter);
+      shard.cache_map.erase(iter);
     }
+    wl.unlock();
+    invalidate_chained(invalidated);
+    count_hit(shard.logger, false);
     return -ENOENT;
   }
 
   ObjectCacheEntry *entry = &iter->second;
 
-  if (lru_counter - entry->lru_promotion_ts > lru_window) {
-    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << lru_counter
+  if (shard.lru_counter - entry->lru_promotion_ts > shard.lru_window) {
+    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << shard.lru_counter
                    << " promotion_ts=" << entry->lru_promotion_ts << dendl;
     rl.unlock();
     wl.lock(); // write lock for touch_lru()
     /* need to redo this because entry might have dropped off the cache */
-    iter = cache_map.find(name);
-    if (iter == cache_map.end()) {
+    iter = shard.cache_map.find(name);
+    if (iter == shard.cache_map.end()) {
       ldpp_dout(dpp, 10) << "lost race! cache get: name=" << name << " : miss" << dendl;
-      if(perfcounter) perfcounter->inc(l_rgw_cache_miss);
+      count_hit(shard.logger, false);
       return -ENOENT;
     }
 
     entry = &iter->second;
     /* check again, we might have lost a race here */
-    if (lru_counter - entry->lru_promotion_ts > lru_window) {
-      touch_lru(dpp, name, *entry, iter->second.lru_iter);
+    if (shard.lru_counter - entry->lru_promotion_ts > shard.lru_window) {
+      touch_lru(dpp, shard, name, *entry, iter->second.lru_iter, invalidated);
     }
   }
 
   ObjectCacheInfo& src = iter->second.info;
+  int r = 0;
   if(src.status == -ENOENT) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : hit (negative entry)" << dendl;
-    if (perfcounter) perfcounter->inc(l_rgw_cache_hit);
-    return -ENODATA;
-  }
-  if ((src.flags & mask) != mask) {
+    count_hit(shard.logger, true);
+    r = -ENODATA;
+  } else if ((src.flags & mask) != mask) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : type miss (requested=0x"
                    << std::hex << mask << ", cached=0x" << src.flags
                    << std::dec << ")" << dendl;
-    if(perfcounter) perfcounter->inc(l_rgw_cache_miss);
-    return -ENOENT;
-  }
-  ldpp_dout(dpp, 10) << "cache get: name=" << name << " : hit (requested=0x"
-                 << std::hex << mask << ", cached=0x" << src.flags
-                 << std::dec << ")" << dendl;
+    count_hit(shard.logger, false);
+    r = -ENOENT;
+  } else {
+    ldpp_dout(dpp, 10) << "cache get: name=" << name << " : hit (requested=0x"
+                   << std::hex << mask << ", cached=0x" << src.flags
+                   << std::dec << ")" << dendl;
 
-  info = src;
-  if (cache_info) {
-    cache_info->cache_locator = name;
-    cache_info->gen = entry->gen;
+    info = src;
+    if (cache_info) {
+      cache_info->cache_locator = name;
+      cache_info->gen = entry->gen;
+    }
+    count_hit(shard.logger, true);
   }
-  if(perfcounter) perfcounter->inc(l_rgw_cache_hit);
 
-  return 0;
+  if (!invalidated.empty()) {
+    // only the write lock can have evicted entries
+    wl.unlock();
+    invalidate_chained(invalidated);
+  }
+  return r;
 }
 
 bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
                                     std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
 				    RGWChainedCache::Entry *chained_entry)
 {
-  std::unique_lock l{lock};
+  if (!enabled) {
+    return false;
+  }
 
+  // the entries may live in different shards; lock all of them in shard
+  // index order, like do_invalidate_all(), so the chained entry is added
+  // atomically
+  std::vector<size_t> locked;
+  for (auto cache_info : cache_info_entries) {
+    locked.push_back(shard_index(
+      std::hash<std::string>{}(cache_info->cache_locator)));
+  }
+  std::sort(locked.begin(), locked.end());
+  locked.erase(std::unique(locked.begin(), locked.end()), locked.end());
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(locked.size());
+  for (auto idx : locked) {
+    locks.emplace_back(shards[idx]->lock);
+  }
   if (!enabled) {
     return false;
   }
@@ -111,8 +255,9 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
   for (auto cache_info : cache_info_entries) {
     ldpp_dout(dpp, 10) << "chain_cache_entry: cache_locator="
 		   << cache_info->cache_locator << dendl;
-    auto iter = cache_map.find(cache_info->cache_locator);
-    if (iter == cache_map.end()) {
+    auto& shard = get_shard(std::hash<std::string>{}(cache_info->cache_locator));
+    auto iter = shard.cache_map.find(cache_info->cache_locator);
+    if (iter == shard.cache_map.end()) {
       ldpp_dout(dpp, 20) << "chain_cache_entry: couldn't find cache locator" << dendl;
       return false;
     }
@@ -139,10 +284,31 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
   return true;
 }
 
+bool ObjectCache::admit(Shard& shard, uint64_t hash)
+{
+  if (!admission_filter || shard.lru_size < shard_capacity ||
+      shard.lru.empty()) {
+    return true;
+  }
+  // only take the place of the next LRU victim if the new entry was
+  // looked up more often recently
+  const auto& victim = shard.lru.front();
+  return shard.sketch.estimate(hash) >
+    shard.sketch.estimate(std::hash<std::string>{}(victim));
+}
+
 void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, rgw_cache_entry_info *cache_info)
 {
-  std::unique_lock l{lock};
+  if (!enabled) {
+    return;
+  }
+
+  const uint64_t hash = std::hash<std::string>{}(name);
+  Shard& shard = get_shard(hash);
 
+  chained_entries_t invalidated;
+  std::unique_lock l{shard.lock};
+  // checked again under the shard lock, see do_invalidate_all()
   if (!enabled) {
     return;
   }
@@ -150,20 +316,29 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   ldpp_dout(dpp, 10) << "cache put: name=" << name << " info.flags=0x"
                  << std::hex << info.flags << std::dec << dendl;
 
-  auto [iter, inserted] = cache_map.emplace(name, ObjectCacheEntry{});
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end()) {
+    if (!admit(shard, hash)) {
+      ldpp_dout(dpp, 10) << "cache put: name=" << name
+		     << " : not admitted" << dendl;
+      if (shard.logger) {
+	shard.logger->inc(l_rgw_cache_shard_reject);
+      }
+      return;
+    }
+    iter = shard.cache_map.emplace(name, ObjectCacheEntry{}).first;
+    iter->second.lru_iter = shard.lru.end();
+  }
   ObjectCacheEntry& entry = iter->second;
   entry.info.time_added = ceph::coarse_mono_clock::now();
-  if (inserted) {
-    entry.lru_iter = lru.end();
-  }
   ObjectCacheInfo& target = entry.info;
 
-  invalidate_lru(entry);
+  invalidate_lru(entry, invalidated);
 
   entry.chained_entries.clear();
   entry.gen++;
 
-  touch_lru(dpp, name, entry, entry.lru_iter);
+  touch_lru(dpp, shard, name, entry, entry.lru_iter, invalidated);
 
   target.status = info.status;
 
@@ -171,6 +346,8 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
     target.flags = 0;
     target.xattrs.clear();
     target.data.clear();
+    l.unlock();
+    invalidate_chained(invalidated);
     return;
   }
 
@@ -212,39 +389,45 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
 
   if (info.flags & CACHE_FLAG_OBJV)
     target.version = info.version;
+
+  l.unlock();
+  invalidate_chained(invalidated);
 }
 
 // WARNING: This function /must not/ be modified to cache a
 // negative lookup. It must only invalidate.
 bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string& name)
 {
-  std::unique_lock l{lock};
-
   if (!enabled) {
     return false;
   }
 
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end())
-    return false;
+  Shard& shard = get_shard(std::hash<std::string>{}(name));
 
-  ldpp_dout(dpp, 10) << "removing " << name << " from cache" << dendl;
-  ObjectCacheEntry& entry = iter->second;
+  chained_entries_t invalidated;
+  {
+    std::unique_lock l{shard.lock};
 
-  for (auto& kv : entry.chained_entries) {
-    kv.first->invalidate(kv.second);
-  }
+    auto iter = shard.cache_map.find(name);
+    if (iter == shard.cache_map.end())
+      return false;
+
+    ldpp_dout(dpp, 10) << "removing " << name << " from cache" << dendl;
+    invalidate_lru(iter->second, invalidated);
 
-  remove_lru(name, iter->second.lru_iter);
-  cache_map.erase(iter);
+    remove_lru(shard, name, iter->second.lru_iter);
+    shard.cache_map.erase(iter);
+  }
+  invalidate_chained(invalidated);
   return true;
 }
 
-void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, ObjectCacheEntry& entry,
-			    std::list<string>::iterator& lru_iter)
+void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, Shard& shard, const string& name,
+			    ObjectCacheEntry& entry, std::list<string>::iterator& lru_iter,
+			    chained_entries_t& invalidated)
 {
-  while (lru_size > (size_t)cct->_conf->rgw_cache_lru_size) {
-    auto iter = lru.begin();
+  while (shard.lru_size > shard_capacity) {
+    auto iter = shard.lru.begin();
     if ((*iter).compare(name) == 0) {
       /*
        * if the entry we're touching happens to be at the lru end, don't remove it,
@@ -252,58 +435,84 @@ void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, O
        */
       break;
     }
-    auto map_iter = cache_map.find(*iter);
+    auto map_iter = shard.cache_map.find(*iter);
     ldout(cct, 10) << "removing entry: name=" << *iter << " from cache LRU" << dendl;
-    if (map_iter != cache_map.end()) {
+    if (map_iter != shard.cache_map.end()) {
       ObjectCacheEntry& entry = map_iter->second;
-      invalidate_lru(entry);
-      cache_map.erase(map_iter);
+      invalidate_lru(entry, invalidated);
+      shard.cache_map.erase(map_iter);
+    }
+    shard.lru.pop_front();
+    shard.lru_size--;
+    if (shard.logger) {
+      shard.logger->inc(l_rgw_cache_shard_evict);
     }
-    lru.pop_front();
-    lru_size--;
   }
 
-  if (lru_iter == lru.end()) {
-    lru.push_back(name);
-    lru_size++;
+  if (lru_iter == shard.lru.end()) {
+    shard.lru.push_back(name);
+    shard.lru_size++;
     lru_iter--;
     ldpp_dout(dpp, 10) << "adding " << name << " to cache LRU end" << dendl;
   } else {
     ldpp_dout(dpp, 10) << "moving " << name << " to cache LRU end" << dendl;
-    lru.erase(lru_iter);
-    lru.push_back(name);
-    lru_iter = lru.end();
+    shard.lru.erase(lru_iter);
+    shard.lru.push_back(name);
+    lru_iter = shard.lru.end();
     --lru_iter;
   }
 
-  lru_counter++;
-  entry.lru_promotion_ts = lru_counter;
+  shard.lru_counter++;
+  entry.lru_promotion_ts = shard.lru_counter;
+  if (shard.logger) {
+    shard.logger->set(l_rgw_cache_shard_entries, shard.lru_size);
+  }
 }
 
-void ObjectCache::remove_lru(const string& name,
+void ObjectCache::remove_lru(Shard& shard, const string& name,
 			     std::list<string>::iterator& lru_iter)
 {
-  if (lru_iter == lru.end())
+  if (lru_iter == shard.lru.end())
     return;
 
-  lru.erase(lru_iter);
-  lru_size--;
-  lru_iter = lru.end();
+  shard.lru.erase(lru_iter);
+  shard.lru_size--;
+  lru_iter = shard.lru.end();
+  if (shard.logger) {
+    shard.logger->set(l_rgw_cache_shard_entries, shard.lru_size);
+  }
 }
 
-void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
+void ObjectCache::invalidate_lru(ObjectCacheEntry& entry,
+				 chained_entries_t& invalidated)
 {
-  for (auto iter = entry.chained_entries.begin();
-       iter != entry.chained_entries.end(); ++iter) {
-    RGWChainedCache *chained_cache = iter->first;
-    chained_cache->invalidate(iter->second);
+  for (auto& kv : entry.chained_entries) {
+    invalidated.push_back(std::move(kv));
   }
+  entry.chained_entries.clear();
 }
 
-void ObjectCache::set_enabled(bool status)
+void ObjectCache::invalidate_chained(chained_entries_t& invalidated)
 {
-  std::unique_lock l{lock};
+  // chained caches are invalidated after the shard lock was dropped, so
+  // that invalidations of the same chained cache don't serialize the
+  // shards; the caller still waits for them to complete
+  if (invalidated.empty()) {
+    return;
+  }
+  std::sort(invalidated.begin(), invalidated.end());
+  std::shared_lock l{chained_cache_lock};
+  for (auto& [cache, key] : invalidated) {
+    // skip caches that have been unchained meanwhile
+    if (std::find(chained_cache.begin(), chained_cache.end(), cache) !=
+	chained_cache.end()) {
+      cache->invalidate(key);
+    }
+  }
+}
 
+void ObjectCache::set_enabled(bool status)
+{
   enabled = status;
 
   if (!enabled) {
@@ -313,32 +522,43 @@ void ObjectCache::set_enabled(bool status)
 
 void ObjectCache::invalidate_all()
 {
-  std::unique_lock l{lock};
-
   do_invalidate_all();
 }
 
 void ObjectCache::do_invalidate_all()
 {
-  cache_map.clear();
-  lru.clear();
+  // holding every shard lock at once makes sure nothing is added from
+  // before the cache was disabled
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(shards.size());
+  for (auto& shard : shards) {
+    locks.emplace_back(shard->lock);
+  }
+
+  for (auto& shard : shards) {
+    shard->cache_map.clear();
+    shard->lru.clear();
 
-  lru_size = 0;
-  lru_counter = 0;
-  lru_window = 0;
+    shard->lru_size = 0;
+    shard->lru_counter = 0;
+    if (shard->logger) {
+      shard->logger->set(l_rgw_cache_shard_entries, 0);
+    }
+  }
 
+  std::shared_lock l{chained_cache_lock};
   for (auto& cache : chained_cache) {
     cache->invalidate_all();
   }
 }
 
 void ObjectCache::chain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::unique_lock l{chained_cache_lock};
   chained_cache.push_back(cache);
 }
 
 void ObjectCache::unchain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::unique_lock l{chained_cache_lock};
 
   auto iter = chained_cache.begin();
   for (; iter != chained_cache.end(); ++iter) {
@@ -350,11 +570,23 @@ void ObjectCache::unchain_cache(RGWChainedCache *cache) {
   }
 }
 
+void ObjectCache::remove_shards()
+{
+  for (auto& shard : shards) {
+    if (shard->logger) {
+      cct->get_perfcounters_collection()->remove(shard->logger);
+      delete shard->logger;
+    }
+  }
+  shards.clear();
+}
+
 ObjectCache::~ObjectCache()
 {
   for (auto cache : chained_cache) {
     cache->unregistered();
   }
+  remove_shards();
 }
 
 void ObjectMetaInfo::generate_test_instances(list<ObjectMetaInfo*>& o)
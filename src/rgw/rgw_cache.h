@@ -4,9 +4,13 @@
 #ifndef CEPH_RGWCACHE_H
 #define CEPH_RGWCACHE_H
 
+#include <atomic>
+#include <list>
+#include <memory>
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <vector>
 #include "include/types.h"
 #include "include/utime.h"
 #include "include/ceph_assert.h"
@@ -15,6 +19,8 @@
 #include "cls/version/cls_version_types.h"
 #include "rgw_common.h"
 
+class PerfCounters;
+
 enum {
   UPDATE_OBJ,
   INVALIDATE_OBJ,
@@ -159,29 +165,88 @@ struct ObjectCacheEntry {
   ObjectCacheEntry() : lru_promotion_ts(0), gen(0) {}
 };
 
+/*
+ * Compact count-min sketch of 4-bit counters used as a TinyLFU admission
+ * filter: it estimates how often a key was looked up recently, and all
+ * counters are halved once enough increments were seen so that the
+ * estimate follows changes in popularity.
+ */
+class RGWCacheFrequencySketch {
+  std::vector<std::atomic<uint64_t>> table; // 16 counters per word
+  uint64_t mask = 0;
+  uint64_t sample_size = 0;
+  std::atomic<uint64_t> additions = {0};
+
+  void age();
+
+public:
+  void init(uint64_t capacity);
+  void increment(uint64_t hash);
+  unsigned estimate(uint64_t hash) const;
+};
+
+enum {
+  l_rgw_cache_shard_first = 16000,
+  l_rgw_cache_shard_hit,
+  l_rgw_cache_shard_miss,
+  l_rgw_cache_shard_evict,
+  l_rgw_cache_shard_reject,
+  l_rgw_cache_shard_entries,
+  l_rgw_cache_shard_last,
+};
+
 class ObjectCache {
-  std::unordered_map<std::string, ObjectCacheEntry> cache_map;
-  std::list<std::string> lru;
-  unsigned long lru_size;
-  unsigned long lru_counter;
-  unsigned long lru_window;
-  ceph::shared_mutex lock = ceph::make_shared_mutex("ObjectCache");
+  /*
+   * entries are spread over independently locked shards by the hash of
+   * their name; each shard runs its own LRU and admission filter
+   */
+  struct Shard {
+    std::unordered_map<std::string, ObjectCacheEntry> cache_map;
+    std::list<std::string> lru;
+    unsigned long lru_size = 0;
+    unsigned long lru_counter = 0;
+    unsigned long lru_window = 0;
+    ceph::shared_mutex lock = ceph::make_shared_mutex("ObjectCache::Shard");
+    RGWCacheFrequencySketch sketch;
+    PerfCounters *logger = nullptr;
+  };
+
+  // chained cache entries to invalidate once the shard lock is dropped
+  using chained_entries_t =
+    std::vector<std::pair<RGWChainedCache *, std::string>>;
+
+  std::vector<std::unique_ptr<Shard>> shards;
+  unsigned long shard_capacity;
+  bool admission_filter;
   CephContext *cct;
 
+  ceph::shared_mutex chained_cache_lock =
+    ceph::make_shared_mutex("ObjectCache::chained_cache_lock");
   std::vector<RGWChainedCache *> chained_cache;
 
-  bool enabled;
+  std::atomic<bool> enabled;
   ceph::timespan expiry;
 
-  void touch_lru(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheEntry& entry,
-		 std::list<std::string>::iterator& lru_iter);
-  void remove_lru(const std::string& name, std::list<std::string>::iterator& lru_iter);
-  void invalidate_lru(ObjectCacheEntry& entry);
+  size_t shard_index(uint64_t hash) const {
+    return (hash >> 32) % shards.size();
+  }
+  Shard& get_shard(uint64_t hash) {
+    return *shards[shard_index(hash)];
+  }
+  bool admit(Shard& shard, uint64_t hash);
+
+  void touch_lru(const DoutPrefixProvider *dpp, Shard& shard, const std::string& name,
+		 ObjectCacheEntry& entry, std::list<std::string>::iterator& lru_iter,
+		 chained_entries_t& invalidated);
+  void remove_lru(Shard& shard, const std::string& name, std::list<std::string>::iterator& lru_iter);
+  void invalidate_lru(ObjectCacheEntry& entry, chained_entries_t& invalidated);
+  void invalidate_chained(chained_entries_t& invalidated);
 
   void do_invalidate_all();
+  void remove_shards();
 
 public:
-  ObjectCache() : lru_size(0), lru_counter(0), lru_window(0), cct(NULL), enabled(false) { }
+  ObjectCache() : shard_capacity(0), admission_filter(false), cct(NULL), enabled(false) { }
   ~ObjectCache();
   int get(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheInfo& bl, uint32_t mask, rgw_cache_entry_info *cache_info);
   std::optional<ObjectCacheInfo> get(const DoutPrefixProvider *dpp, const std::string& name) {
@@ -192,10 +257,13 @@ public:
 
   template<typename F>
   void for_each(const F& f) {
-    std::shared_lock l{lock};
-    if (enabled) {
+    if (!enabled) {
+      return;
+    }
+    for (auto& shard : shards) {
+      std::shared_lock l{shard->lock};
       auto now  = ceph::coarse_mono_clock::now();
-      for (const auto& [name, entry] : cache_map) {
+      for (const auto& [name, entry] : shard->cache_map) {
         if (expiry.count() && (now - entry.info.time_added) < expiry) {
           f(name, entry);
         }
@@ -205,12 +273,7 @@ public:
 
   void put(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheInfo& bl, rgw_cache_entry_info *cache_info);
   bool invalidate_remove(const DoutPrefixProvider *dpp, const std::string& name);
-  void set_ctx(CephContext *_cct) {
-    cct = _cct;
-    lru_window = cct->_conf->rgw_cache_lru_size / 2;
-    expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
-						"rgw_cache_expiry_interval"));
-  }
+  void set_ctx(CephContext *_cct);
   bool chain_cache_entry(const DoutPrefixProvider *dpp,
                          std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
 			 RGWChainedCache::Entry *chained_entry);
@@ -129,6 +129,9 @@ using ceph::crypto::MD5;
 
 #define RGW_ATTR_COMPRESSION    RGW_ATTR_PREFIX "compression"
 
+/* S3 additional checksums, suffixed with the algorithm */
+#define RGW_ATTR_CHECKSUM_PREFIX RGW_ATTR_PREFIX "x-amz-checksum-"
+
 #define RGW_ATTR_APPEND_PART_NUM    RGW_ATTR_PREFIX "append_part_num"
 
 /* IAM Policy */
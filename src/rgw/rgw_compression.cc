@@ -42,6 +42,35 @@ int rgw_compression_info_from_attrset(const map<string, bufferlist>& attrs,
 //------------RGWPutObj_Compress---------------
 
 int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
+{
+  // the first part decides whether the others are compressed at all, so
+  // it's compressed before any of them is handed to the pool
+  if (logical_offset == 0 && in.length() > 0) {
+    bufferlist out;
+    int cr = transform(in, logical_offset, &out);
+    return complete(std::move(in), std::move(out), cr, logical_offset);
+  }
+  return ParallelPipe::process(std::move(in), logical_offset);
+}
+
+int RGWPutObj_Compress::transform(bufferlist& in, uint64_t logical_offset,
+                                  bufferlist *out)
+{
+  if (in.length() == 0 || (logical_offset > 0 && !compressed)) {
+    return 0;
+  }
+  ldout(cct, 10) << "Compression for rgw is enabled, compress part " << in.length() << dendl;
+  std::optional<int32_t> message;
+  int cr = compressor->compress(in, *out, message);
+  if (cr >= 0) {
+    std::lock_guard l{message_lock};
+    compressor_message = message;
+  }
+  return cr;
+}
+
+int RGWPutObj_Compress::complete(bufferlist&& in, bufferlist&& compressed_bl,
+                                 int cr, uint64_t logical_offset)
 {
   bufferlist out;
   compressed_ofs = logical_offset;
@@ -50,8 +79,6 @@ int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
     // compression stuff
     if ((logical_offset > 0 && compressed) || // if previous part was compressed
         (logical_offset == 0)) {              // or it's the first part
-      ldout(cct, 10) << "Compression for rgw is enabled, compress part " << in.length() << dendl;
-      int cr = compressor->compress(in, out, compressor_message);
       if (cr < 0) {
         if (logical_offset > 0) {
           lderr(cct) << "Compression failed with exit code " << cr
@@ -64,6 +91,7 @@ int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
         out = std::move(in);
       } else {
         compressed = true;
+        out = std::move(compressed_bl);
     
         compression_block newbl;
         size_t bs = blocks.size();
@@ -4,6 +4,7 @@
 #ifndef CEPH_RGW_COMPRESSION_H
 #define CEPH_RGW_COMPRESSION_H
 
+#include <atomic>
 #include <vector>
 
 #include "compressor/Compressor.h"
@@ -40,25 +41,38 @@ public:
 
 };
 
-class RGWPutObj_Compress : public rgw::putobj::Pipe
+class RGWPutObj_Compress : public rgw::putobj::ParallelPipe
 {
   CephContext* cct;
-  bool compressed{false};
+  // read by transform() on the pool threads
+  std::atomic<bool> compressed{false};
   CompressorRef compressor;
+  ceph::mutex message_lock = ceph::make_mutex("RGWPutObj_Compress");
   std::optional<int32_t> compressor_message;
   std::vector<compression_block> blocks;
   uint64_t compressed_ofs{0};
+
+protected:
+  int transform(bufferlist& in, uint64_t logical_offset, bufferlist *out) override;
+  int complete(bufferlist&& in, bufferlist&& out, int cr,
+               uint64_t logical_offset) override;
+
 public:
-  RGWPutObj_Compress(CephContext* cct_, CompressorRef compressor,
-                     rgw::sal::DataProcessor *next)
-    : Pipe(next), cct(cct_), compressor(compressor) {}
-  virtual ~RGWPutObj_Compress() override {};
+  int process(bufferlist&& in, uint64_t logical_offset) override;
 
-  int process(bufferlist&& data, uint64_t logical_offset) override;
+  RGWPutObj_Compress(CephContext* cct_, CompressorRef compressor,
+                     rgw::sal::DataProcessor *next,
+                     rgw::putobj::TransformPool *pool = nullptr,
+                     optional_yield y = null_yield)
+    : ParallelPipe(next, pool, y), cct(cct_), compressor(compressor) {}
+  virtual ~RGWPutObj_Compress() override { wait_idle(); }
 
   bool is_compressed() { return compressed; }
   std::vector<compression_block>& get_compression_blocks() { return blocks; }
-  std::optional<int32_t> get_compressor_message() { return compressor_message; }
+  std::optional<int32_t> get_compressor_message() {
+    std::lock_guard l{message_lock};
+    return compressor_message;
+  }
 
 }; /* RGWPutObj_Compress */
 
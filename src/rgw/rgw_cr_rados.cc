@@ -6,6 +6,7 @@
 #include "rgw_zone.h"
 #include "rgw_coroutine.h"
 #include "rgw_cr_rados.h"
+#include "rgw_data_sync.h"
 #include "rgw_sync_counters.h"
 #include "rgw_bucket.h"
 #include "rgw_datalog_notify.h"
@@ -726,6 +727,7 @@ int RGWAsyncFetchRemoteObj::_send_request(const DoutPrefixProvider *dpp)
   std::string etag;
 
   std::optional<uint64_t> bytes_transferred;
+  const auto start = ceph::mono_clock::now();
   int r = store->getRados()->fetch_remote_obj(obj_ctx,
                        user_id.value_or(rgw_user()),
                        NULL, /* req_info */
@@ -756,6 +758,10 @@ int RGWAsyncFetchRemoteObj::_send_request(const DoutPrefixProvider *dpp)
                        filter.get(),
                        &zones_trace,
                        &bytes_transferred);
+  if (window) {
+    window->complete(ceph::mono_clock::now() - start,
+                     bytes_transferred.value_or(0), r);
+  }
 
   if (r < 0) {
     ldpp_dout(dpp, 0) << "store->fetch_remote_obj() returned r=" << r << dendl;
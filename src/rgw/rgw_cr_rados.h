@@ -20,6 +20,7 @@
 
 struct rgw_http_param_pair;
 class RGWRESTConn;
+class RGWBucketSyncWindow;
 
 class RGWAsyncRadosRequest : public RefCountedObject {
   RGWCoroutine *caller;
@@ -1053,6 +1054,7 @@ class RGWAsyncFetchRemoteObj : public RGWAsyncRadosRequest {
   rgw_zone_set zones_trace;
   PerfCounters* counters;
   const DoutPrefixProvider *dpp;
+  std::shared_ptr<RGWBucketSyncWindow> window;
 
 protected:
   int _send_request(const DoutPrefixProvider *dpp) override;
@@ -1069,7 +1071,8 @@ public:
                          bool _if_newer,
                          std::shared_ptr<RGWFetchObjFilter> _filter,
                          rgw_zone_set *_zones_trace,
-                         PerfCounters* counters, const DoutPrefixProvider *dpp)
+                         PerfCounters* counters, const DoutPrefixProvider *dpp,
+                         std::shared_ptr<RGWBucketSyncWindow> window)
     : RGWAsyncRadosRequest(caller, cn), store(_store),
       source_zone(_source_zone),
       user_id(_user_id),
@@ -1082,7 +1085,8 @@ public:
       copy_if_newer(_if_newer),
       filter(_filter),
       counters(counters),
-      dpp(dpp)
+      dpp(dpp),
+      window(std::move(window))
   {
     if (_zones_trace) {
       zones_trace = *_zones_trace;
@@ -1116,6 +1120,7 @@ class RGWFetchRemoteObjCR : public RGWSimpleCoroutine {
   rgw_zone_set *zones_trace;
   PerfCounters* counters;
   const DoutPrefixProvider *dpp;
+  std::shared_ptr<RGWBucketSyncWindow> window;
 
 public:
   RGWFetchRemoteObjCR(RGWAsyncRadosProcessor *_async_rados, rgw::sal::RadosStore* _store,
@@ -1130,7 +1135,8 @@ public:
                       bool _if_newer,
                       std::shared_ptr<RGWFetchObjFilter> _filter,
                       rgw_zone_set *_zones_trace,
-                      PerfCounters* counters, const DoutPrefixProvider *dpp)
+                      PerfCounters* counters, const DoutPrefixProvider *dpp,
+                      std::shared_ptr<RGWBucketSyncWindow> window = nullptr)
     : RGWSimpleCoroutine(_store->ctx()), cct(_store->ctx()),
       async_rados(_async_rados), store(_store),
       source_zone(_source_zone),
@@ -1144,7 +1150,8 @@ public:
       copy_if_newer(_if_newer),
       filter(_filter),
       req(NULL),
-      zones_trace(_zones_trace), counters(counters), dpp(dpp) {}
+      zones_trace(_zones_trace), counters(counters), dpp(dpp),
+      window(std::move(window)) {}
 
 
   ~RGWFetchRemoteObjCR() override {
@@ -1162,7 +1169,7 @@ public:
     req = new RGWAsyncFetchRemoteObj(this, stack->create_completion_notifier(), store,
 				     source_zone, user_id, src_bucket, dest_placement_rule, dest_bucket_info,
                                      key, dest_key, versioned_epoch, copy_if_newer, filter,
-                                     zones_trace, counters, dpp);
+                                     zones_trace, counters, dpp, window);
     async_rados->queue(req);
     return 0;
   }
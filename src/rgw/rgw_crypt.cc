@@ -799,8 +799,10 @@ int RGWGetObj_BlockDecrypt::flush() {
 RGWPutObj_BlockEncrypt::RGWPutObj_BlockEncrypt(const DoutPrefixProvider *dpp,
                                                CephContext* cct,
                                                rgw::sal::DataProcessor *next,
-                                               std::unique_ptr<BlockCrypt> crypt)
-  : Pipe(next),
+                                               std::unique_ptr<BlockCrypt> crypt,
+                                               rgw::putobj::TransformPool *pool,
+                                               optional_yield y)
+  : ParallelPipe(next, pool, y),
     dpp(dpp),
     cct(cct),
     crypt(std::move(crypt)),
@@ -824,12 +826,9 @@ int RGWPutObj_BlockEncrypt::process(bufferlist&& data, uint64_t logical_offset)
     proc_size = cache.length();
   }
   if (proc_size > 0) {
-    bufferlist in, out;
+    bufferlist in;
     cache.splice(0, proc_size, &in);
-    if (!crypt->encrypt(in, 0, proc_size, out, logical_offset)) {
-      return -ERR_INTERNAL_ERROR;
-    }
-    int r = Pipe::process(std::move(out), logical_offset);
+    int r = ParallelPipe::process(std::move(in), logical_offset);
     logical_offset += proc_size;
     if (r < 0)
       return r;
@@ -837,7 +836,16 @@ int RGWPutObj_BlockEncrypt::process(bufferlist&& data, uint64_t logical_offset)
 
   if (flush) {
     /*replicate 0-sized handle_data*/
-    return Pipe::process({}, logical_offset);
+    return ParallelPipe::process({}, logical_offset);
+  }
+  return 0;
+}
+
+int RGWPutObj_BlockEncrypt::transform(bufferlist& in, uint64_t logical_offset,
+                                      bufferlist *out)
+{
+  if (!crypt->encrypt(in, 0, in.length(), *out, logical_offset)) {
+    return -ERR_INTERNAL_ERROR;
   }
   return 0;
 }
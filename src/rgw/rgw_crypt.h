@@ -121,7 +121,7 @@ public:
 }; /* RGWGetObj_BlockDecrypt */
 
 
-class RGWPutObj_BlockEncrypt : public rgw::putobj::Pipe
+class RGWPutObj_BlockEncrypt : public rgw::putobj::ParallelPipe
 {
   const DoutPrefixProvider *dpp;
   CephContext* cct;
@@ -129,11 +129,17 @@ class RGWPutObj_BlockEncrypt : public rgw::putobj::Pipe
                                           for operations when enough data is accumulated */
   bufferlist cache; /**< stores extra data that could not (yet) be processed by BlockCrypt */
   const size_t block_size; /**< snapshot of \ref BlockCrypt.get_block_size() */
+protected:
+  /** encrypts whole blocks, possibly concurrently since crypt is stateless */
+  int transform(bufferlist& in, uint64_t logical_offset, bufferlist *out) override;
 public:
   RGWPutObj_BlockEncrypt(const DoutPrefixProvider *dpp,
                          CephContext* cct,
                          rgw::sal::DataProcessor *next,
-                         std::unique_ptr<BlockCrypt> crypt);
+                         std::unique_ptr<BlockCrypt> crypt,
+                         rgw::putobj::TransformPool *pool = nullptr,
+                         optional_yield y = null_yield);
+  ~RGWPutObj_BlockEncrypt() override { wait_idle(); }
 
   int process(bufferlist&& data, uint64_t logical_offset) override;
 }; /* RGWPutObj_BlockEncrypt */
@@ -9,9 +9,16 @@
 #include "rgw_auth_s3.h"
 #include "rgw_op.h"
 #include "rgw_crypt_sanitize.h"
+#include "common/Thread.h"
 #if defined(__linux__)
 #include <features.h>
 #endif
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+#include <algorithm>
+#include <limits.h>
+#include <tuple>
 
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -60,20 +67,34 @@ done:
 }
 
 D3nDataCache::D3nDataCache()
-  : cct(nullptr), io_type(_io_type::ASYNC_IO), free_data_cache_size(0), outstanding_write_size(0)
+  : cct(nullptr), io_type(_io_type::ASYNC_IO), cache_size(0), used_size(0), outstanding_write_size(0)
 {
   lsubdout(g_ceph_context, rgw_datacache, 5) << "D3nDataCache: " << __func__ << "()" << dendl;
 }
 
+D3nDataCache::~D3nDataCache()
+{
+  shutdown();
+}
+
 void D3nDataCache::init(CephContext *_cct) {
   cct = _cct;
-  free_data_cache_size = cct->_conf->rgw_d3n_l1_datacache_size;
+  cache_size = cct->_conf->rgw_d3n_l1_datacache_size;
+  high_watermark = static_cast<uint64_t>(cache_size *
+    cct->_conf.get_val<double>("rgw_d3n_l1_eviction_high_watermark"));
+  low_watermark = std::min(high_watermark, static_cast<uint64_t>(cache_size *
+    cct->_conf.get_val<double>("rgw_d3n_l1_eviction_low_watermark")));
+  admission_size_threshold =
+    cct->_conf.get_val<Option::size_t>("rgw_d3n_l1_admission_size_threshold");
+  admission_history =
+    cct->_conf.get_val<uint64_t>("rgw_d3n_l1_admission_history");
   head = nullptr;
   tail = nullptr;
   cache_location = cct->_conf->rgw_d3n_l1_datacache_persistent_path;
   if(cache_location.back() != '/') {
       cache_location += "/";
   }
+  write_location = cache_location + ".d3n_writes/";
   try {
     if (efs::exists(cache_location)) {
       // d3n: evict the cache storage directory
@@ -82,12 +103,17 @@ void D3nDataCache::init(CephContext *_cct) {
         for (auto& p : efs::directory_iterator(cache_location)) {
           efs::remove_all(p.path());
         }
+      } else {
+        load_index();
       }
     } else {
       // create the cache storage directory
       lsubdout(g_ceph_context, rgw, 5) << "D3nDataCache: init: creating the persistent storage directory on start" << dendl;
       efs::create_directories(cache_location);
     }
+    // whatever is left in here was being written when we stopped
+    efs::remove_all(write_location);
+    efs::create_directories(write_location);
   } catch (const efs::filesystem_error& e) {
     lderr(g_ceph_context) << "D3nDataCache: init: ERROR initializing the cache storage directory '" << cache_location <<
                               "' : " << e.what() << dendl;
@@ -100,6 +126,14 @@ void D3nDataCache::init(CephContext *_cct) {
   if (conf_eviction_policy == "random")
     eviction_policy = _eviction_policy::RANDOM;
 
+#ifdef HAVE_LIBURING
+  auto queue_depth = cct->_conf.get_val<uint64_t>("rgw_d3n_io_uring_queue_depth");
+  if (queue_depth > 0 && !d3n_uring_init(queue_depth)) {
+    ldout(cct, 1) << "D3nDataCache: io_uring is not available, falling back to libaio" << dendl;
+  }
+  if (!ring)
+#endif
+  {
 #if defined(HAVE_LIBAIO) && defined(__GLIBC__)
   // libaio setup
   struct aioinit ainit{0};
@@ -108,12 +142,84 @@ void D3nDataCache::init(CephContext *_cct) {
   ainit.aio_idle_time = 120;
   aio_init(&ainit);
 #endif
+  }
+
+  evict_thread = make_named_thread("d3n_evict", &D3nDataCache::evict_entry, this);
+}
+
+void D3nDataCache::shutdown()
+{
+  if (evict_thread.joinable()) {
+    {
+      std::lock_guard l(d3n_eviction_lock);
+      evict_stop = true;
+    }
+    evict_cond.notify_all();
+    evict_thread.join();
+  }
+#ifdef HAVE_LIBURING
+  d3n_uring_shutdown();
+#endif
+
+  if (cct && !cct->_conf->rgw_d3n_l1_evict_cache_on_start) {
+    // keep the cached files for the next start, see load_index()
+    for (auto& shard : shards) {
+      std::lock_guard l(shard.lock);
+      for (auto& [oid, chunk_info] : shard.map) {
+        delete chunk_info;
+      }
+      shard.map.clear();
+    }
+    head = tail = nullptr;
+    return;
+  }
+  while (lru_eviction() > 0);
+}
+
+void D3nDataCache::load_index()
+{
+  // the cached chunks are immutable rados tail objects named after their
+  // oid, so whatever survived in the cache directory can be served again.
+  // chunks are only renamed into it once completely written, but a file
+  // may still have been cut short by a crash of the host before it was
+  // flushed: empty files and files larger than the cache are dropped here,
+  // and chunks whose size doesn't match the read are dropped by get()
+  std::vector<std::tuple<efs::file_time_type, std::string, uint64_t>> files;
+  for (auto& p : efs::directory_iterator(cache_location)) {
+    if (!p.is_regular_file()) {
+      continue;
+    }
+    uint64_t size = p.file_size();
+    if (size == 0 || size > cache_size) {
+      lsubdout(g_ceph_context, rgw, 5) << "D3nDataCache: init: removing " <<
+        p.path() << " of size " << size << dendl;
+      efs::remove(p.path());
+      continue;
+    }
+    files.emplace_back(p.last_write_time(), p.path().filename().string(),
+                       size);
+  }
+  std::sort(files.begin(), files.end());
+
+  for (auto& [mtime, oid, size] : files) {
+    D3nChunkDataInfo* chunk_info = new D3nChunkDataInfo;
+    chunk_info->oid = oid;
+    chunk_info->set_ctx(cct);
+    chunk_info->size = size;
+    auto& shard = get_shard(oid);
+    const std::lock_guard l(shard.lock);
+    shard.map.emplace(oid, chunk_info);
+    const std::lock_guard le(d3n_eviction_lock);
+    lru_insert_head(chunk_info);
+    used_size += size;
+  }
+  lsubdout(g_ceph_context, rgw, 5) << "D3nDataCache: init: loaded " << files.size() <<
+    " cached chunks, " << used_size << " bytes" << dendl;
 }
 
 int D3nDataCache::d3n_io_write(bufferlist& bl, unsigned int len, std::string oid)
 {
-  D3nChunkDataInfo* chunk_info = new D3nChunkDataInfo;
-  std::string location = cache_location + oid;
+  std::string location = write_location + oid;
 
   lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "(): location=" << location << dendl;
   FILE *cache_file = nullptr;
@@ -129,6 +235,7 @@ int D3nDataCache::d3n_io_write(bufferlist& bl, unsigned int len, std::string oid
   nbytes = fwrite(bl.c_str(), 1, len, cache_file);
   if (nbytes != len) {
     ldout(cct, 0) << "ERROR: D3nDataCache::io_write: fwrite has returned error: nbytes!=len, nbytes=" << nbytes << ", len=" << len << dendl;
+    fclose(cache_file);
     return -EIO;
   }
 
@@ -138,15 +245,45 @@ int D3nDataCache::d3n_io_write(bufferlist& bl, unsigned int len, std::string oid
     return -errno;
   }
 
-  { // update cahce_map entries for new chunk in cache
-    const std::lock_guard l(d3n_cache_lock);
+  d3n_write_completion(oid, len, 0);
+  return r;
+}
+
+void D3nDataCache::d3n_write_completion(const std::string& oid, uint64_t len, int r)
+{
+  if (r >= 0 && ::rename((write_location + oid).c_str(),
+                         (cache_location + oid).c_str()) < 0) {
+    r = -errno;
+  }
+  auto& shard = get_shard(oid);
+  const std::lock_guard l(shard.lock);
+  shard.outstanding_writes.erase(oid);
+  if (r < 0) {
+    ldout(cct, 1) << "D3nDataCache: " << __func__ << "(): failed to write oid=" << oid << ", r=" << r << dendl;
+    ::remove((write_location + oid).c_str());
+  }
+  D3nChunkDataInfo* chunk_info = nullptr;
+  if (r >= 0 && shard.map.find(oid) == shard.map.end()) {
+    chunk_info = new D3nChunkDataInfo;
     chunk_info->oid = oid;
     chunk_info->set_ctx(cct);
     chunk_info->size = len;
-    d3n_cache_map.insert(pair<string, D3nChunkDataInfo*>(oid, chunk_info));
+    shard.map.emplace(oid, chunk_info);
   }
 
-  return r;
+  bool need_eviction;
+  {
+    const std::lock_guard le(d3n_eviction_lock);
+    outstanding_write_size -= std::min(outstanding_write_size, len);
+    if (chunk_info) {
+      used_size += len;
+      lru_insert_head(chunk_info);
+    }
+    need_eviction = used_size > high_watermark;
+  }
+  if (need_eviction) {
+    evict_cond.notify_one();
+  }
 }
 
 void d3n_libaio_write_cb(sigval sigval)
@@ -159,26 +296,13 @@ void d3n_libaio_write_cb(sigval sigval)
 
 void D3nDataCache::d3n_libaio_write_completion_cb(D3nCacheAioWriteRequest* c)
 {
-  D3nChunkDataInfo* chunk_info{nullptr};
-
   ldout(cct, 5) << "D3nDataCache: " << __func__ << "(): oid=" << c->oid << dendl;
 
-  { // update cache_map entries for new chunk in cache
-    const std::lock_guard l(d3n_cache_lock);
-    d3n_outstanding_write_list.erase(c->oid);
-    chunk_info = new D3nChunkDataInfo;
-    chunk_info->oid = c->oid;
-    chunk_info->set_ctx(cct);
-    chunk_info->size = c->cb->aio_nbytes;
-    d3n_cache_map.insert(pair<string, D3nChunkDataInfo*>(c->oid, chunk_info));
-  }
-
-  { // update free size
-    const std::lock_guard l(d3n_eviction_lock);
-    free_data_cache_size -= c->cb->aio_nbytes;
-    outstanding_write_size -= c->cb->aio_nbytes;
-    lru_insert_head(chunk_info);
+  int r = aio_error(c->cb);
+  if (r == 0 && aio_return(c->cb) != static_cast<ssize_t>(c->cb->aio_nbytes)) {
+    r = EIO;
   }
+  d3n_write_completion(c->oid, c->cb->aio_nbytes, -r);
   delete c;
   c = nullptr;
 }
@@ -188,7 +312,7 @@ int D3nDataCache::d3n_libaio_create_write_request(bufferlist& bl, unsigned int l
   lsubdout(g_ceph_context, rgw_datacache, 30) << "D3nDataCache: " << __func__ << "(): Write To Cache, oid=" << oid << ", len=" << len << dendl;
   struct D3nCacheAioWriteRequest* wr = new struct D3nCacheAioWriteRequest(cct);
   int r=0;
-  if ((r = wr->d3n_prepare_libaio_write_op(bl, len, oid, cache_location)) < 0) {
+  if ((r = wr->d3n_prepare_libaio_write_op(bl, len, oid, write_location)) < 0) {
     ldout(cct, 0) << "ERROR: D3nDataCache: " << __func__ << "() prepare libaio write op r=" << r << dendl;
     goto done;
   }
@@ -211,73 +335,217 @@ done:
   return r;
 }
 
-void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
+#ifdef HAVE_LIBURING
+struct D3nCacheUringWriteRequest {
+  std::string oid;
+  bufferlist bl;
+  int fd = -1;
+  std::vector<iovec> iov;
+};
+
+bool D3nDataCache::d3n_uring_init(unsigned queue_depth)
+{
+  ring = std::make_unique<struct io_uring>();
+  int r = io_uring_queue_init(queue_depth, ring.get(), 0);
+  if (r < 0) {
+    ldout(cct, 1) << "D3nDataCache: " << __func__ << "(): io_uring_queue_init failed, r=" << r << dendl;
+    ring.reset();
+    return false;
+  }
+  ring_thread = make_named_thread("d3n_uring", &D3nDataCache::d3n_uring_completion_loop, this);
+  return true;
+}
+
+void D3nDataCache::d3n_uring_shutdown()
+{
+  if (!ring) {
+    return;
+  }
+  {
+    // a drained nop completes after all writes that are still in flight
+    // and stops the completion thread
+    std::lock_guard l(ring_lock);
+    struct io_uring_sqe* sqe = io_uring_get_sqe(ring.get());
+    while (sqe == nullptr) {
+      io_uring_submit(ring.get());
+      sqe = io_uring_get_sqe(ring.get());
+    }
+    io_uring_prep_nop(sqe);
+    io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
+    io_uring_sqe_set_data(sqe, nullptr);
+    io_uring_submit(ring.get());
+  }
+  ring_thread.join();
+  io_uring_queue_exit(ring.get());
+  ring.reset();
+}
+
+void D3nDataCache::d3n_uring_completion_loop()
+{
+  while (true) {
+    struct io_uring_cqe* cqe = nullptr;
+    int r = io_uring_wait_cqe(ring.get(), &cqe);
+    if (r == -EINTR) {
+      continue;
+    }
+    if (r < 0) {
+      ldout(cct, 0) << "ERROR: D3nDataCache: " << __func__ << "(): io_uring_wait_cqe r=" << r << dendl;
+      break;
+    }
+    auto req = static_cast<D3nCacheUringWriteRequest*>(io_uring_cqe_get_data(cqe));
+    int res = cqe->res;
+    io_uring_cqe_seen(ring.get(), cqe);
+    if (req == nullptr) {
+      break;
+    }
+
+    ::close(req->fd);
+    uint64_t len = req->bl.length();
+    if (res >= 0 && static_cast<uint64_t>(res) != len) {
+      res = -EIO;
+    }
+    ldout(cct, 5) << "D3nDataCache: " << __func__ << "(): oid=" << req->oid << ", r=" << res << dendl;
+    d3n_write_completion(req->oid, len, res < 0 ? res : 0);
+    delete req;
+  }
+}
+
+int D3nDataCache::d3n_uring_create_write_request(bufferlist& bl, unsigned int len, const std::string& oid)
 {
-  size_t sr = 0;
-  uint64_t freed_size = 0, _free_data_cache_size = 0, _outstanding_write_size = 0;
+  std::string location = write_location + oid;
+  lsubdout(g_ceph_context, rgw_datacache, 30) << "D3nDataCache: " << __func__ << "(): Write To Cache, location=" << location << ", len=" << len << dendl;
+
+  auto req = std::make_unique<D3nCacheUringWriteRequest>();
+  req->oid = oid;
+  // the request holds a reference to the data, so no copy is needed
+  req->bl.substr_of(bl, 0, len);
+  if (req->bl.get_num_buffers() > IOV_MAX) {
+    req->bl.rebuild();
+  }
+  req->bl.prepare_iov(&req->iov);
+
+  mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+  req->fd = ::open(location.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+  if (req->fd < 0) {
+    int r = -errno;
+    ldout(cct, 0) << "ERROR: D3nDataCache: " << __func__ << "(): open file failed, errno=" << -r << ", location='" << location << "'" << dendl;
+    return r;
+  }
+  if (g_conf()->rgw_d3n_l1_fadvise != POSIX_FADV_NORMAL)
+    posix_fadvise(req->fd, 0, 0, g_conf()->rgw_d3n_l1_fadvise);
+
+  std::lock_guard l(ring_lock);
+  struct io_uring_sqe* sqe = io_uring_get_sqe(ring.get());
+  if (sqe == nullptr) {
+    ::close(req->fd);
+    return -EAGAIN;
+  }
+  io_uring_prep_writev(sqe, req->fd, req->iov.data(), req->iov.size(), 0);
+  io_uring_sqe_set_data(sqe, req.get());
+  int r = io_uring_submit(ring.get());
+  if (r < 0) {
+    ldout(cct, 0) << "ERROR: D3nDataCache: " << __func__ << "(): io_uring_submit r=" << r << dendl;
+    ::close(req->fd);
+    return r;
+  }
+  req.release();
+  return 0;
+}
+#endif
 
+bool D3nDataCache::admit(const std::string& oid, uint64_t obj_size)
+{
+  if (admission_size_threshold == 0 || obj_size <= admission_size_threshold ||
+      admission_history == 0) {
+    return true;
+  }
+  // a chunk of a large object is only worth caching if it's read again
+  const uint64_t hash = std::hash<std::string>{}(oid);
+  const std::lock_guard l(admission_lock);
+  if (admission_seen.erase(hash) > 0) {
+    return true;
+  }
+  admission_seen[hash] = ++admission_seq;
+  admission_seen_order.emplace_back(hash, admission_seq);
+  while (admission_seen_order.size() > admission_history) {
+    auto [front_hash, front_seq] = admission_seen_order.front();
+    auto seen = admission_seen.find(front_hash);
+    if (seen != admission_seen.end() && seen->second == front_seq) {
+      admission_seen.erase(seen);
+    }
+    admission_seen_order.pop_front();
+  }
+  return false;
+}
+
+void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid, uint64_t obj_size)
+{
   ldout(cct, 10) << "D3nDataCache::" << __func__ << "(): oid=" << oid << ", len=" << len << dendl;
+  auto& shard = get_shard(oid);
   {
-    const std::lock_guard l(d3n_cache_lock);
-    std::unordered_map<string, D3nChunkDataInfo*>::iterator iter = d3n_cache_map.find(oid);
-    if (iter != d3n_cache_map.end()) {
+    const std::lock_guard l(shard.lock);
+    if (shard.map.find(oid) != shard.map.end()) {
       ldout(cct, 10) << "D3nDataCache::" << __func__ << "(): data already cached, no rewrite" << dendl;
       return;
     }
-    auto it = d3n_outstanding_write_list.find(oid);
-    if (it != d3n_outstanding_write_list.end()) {
+    if (shard.outstanding_writes.count(oid)) {
       ldout(cct, 10) << "D3nDataCache: NOTE: data put in cache already issued, no rewrite" << dendl;
       return;
     }
-    d3n_outstanding_write_list.insert(oid);
+    if (!admit(oid, obj_size)) {
+      ldout(cct, 10) << "D3nDataCache: " << __func__ << "(): not admitting chunk of large object, oid=" << oid << ", obj_size=" << obj_size << dendl;
+      return;
+    }
+    shard.outstanding_writes.insert(oid);
   }
+
+  bool full = false;
   {
+    // space is freed by the eviction thread, don't wait for it here
     const std::lock_guard l(d3n_eviction_lock);
-    _free_data_cache_size = free_data_cache_size;
-    _outstanding_write_size = outstanding_write_size;
-  }
-  ldout(cct, 20) << "D3nDataCache: Before eviction _free_data_cache_size:" << _free_data_cache_size << ", _outstanding_write_size:" << _outstanding_write_size << ", freed_size:" << freed_size << dendl;
-  while (len > (_free_data_cache_size - _outstanding_write_size + freed_size)) {
-    ldout(cct, 20) << "D3nDataCache: enter eviction" << dendl;
-    if (eviction_policy == _eviction_policy::LRU) {
-      sr = lru_eviction();
-    } else if (eviction_policy == _eviction_policy::RANDOM) {
-      sr = random_eviction();
+    ldout(cct, 20) << "D3nDataCache: used_size:" << used_size << ", outstanding_write_size:" << outstanding_write_size << dendl;
+    if (used_size + outstanding_write_size + len > cache_size) {
+      full = true;
     } else {
-      ldout(cct, 0) << "D3nDataCache: Warning: unknown cache eviction policy, defaulting to lru eviction" << dendl;
-      sr = lru_eviction();
-    }
-    if (sr == 0) {
-      ldout(cct, 2) << "D3nDataCache: Warning: eviction was not able to free disk space, not writing to cache" << dendl;
-      d3n_outstanding_write_list.erase(oid);
-      return;
+      outstanding_write_size += len;
     }
-    ldout(cct, 20) << "D3nDataCache: completed eviction of " << sr << " bytes" << dendl;
-    freed_size += sr;
   }
+  if (full) {
+    ldout(cct, 2) << "D3nDataCache: Warning: cache is full, not writing to cache" << dendl;
+    evict_cond.notify_one();
+    const std::lock_guard l(shard.lock);
+    shard.outstanding_writes.erase(oid);
+    return;
+  }
+
   int r = 0;
+#ifdef HAVE_LIBURING
+  if (ring) {
+    r = d3n_uring_create_write_request(bl, len, oid);
+  } else
+#endif
   r = d3n_libaio_create_write_request(bl, len, oid);
   if (r < 0) {
-    const std::lock_guard l(d3n_cache_lock);
-    d3n_outstanding_write_list.erase(oid);
     ldout(cct, 1) << "D3nDataCache: create_aio_write_request fail, r=" << r << dendl;
-    return;
+    {
+      const std::lock_guard l(shard.lock);
+      shard.outstanding_writes.erase(oid);
+    }
+    const std::lock_guard l(d3n_eviction_lock);
+    outstanding_write_size -= len;
   }
-
-  const std::lock_guard l(d3n_eviction_lock);
-  free_data_cache_size += freed_size;
-  outstanding_write_size += len;
 }
 
 bool D3nDataCache::get(const string& oid, const off_t len)
 {
-  const std::lock_guard l(d3n_cache_lock);
+  auto& shard = get_shard(oid);
+  const std::lock_guard l(shard.lock);
   bool exist = false;
   string location = cache_location + oid;
 
   lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "(): location=" << location << dendl;
-  std::unordered_map<string, D3nChunkDataInfo*>::iterator iter = d3n_cache_map.find(oid);
-  if (!(iter == d3n_cache_map.end())) {
+  std::unordered_map<string, D3nChunkDataInfo*>::iterator iter = shard.map.find(oid);
+  if (!(iter == shard.map.end())) {
     // check inside cache whether file exists or not!!!! then make exist true;
     struct D3nChunkDataInfo* chdo = iter->second;
     struct stat st;
@@ -290,80 +558,126 @@ bool D3nDataCache::get(const string& oid, const off_t len)
       lru_remove(chdo);
       lru_insert_head(chdo);
     } else {
-      d3n_cache_map.erase(oid);
-      const std::lock_guard l(d3n_eviction_lock);
-      lru_remove(chdo);
+      shard.map.erase(iter);
+      {
+        const std::lock_guard l(d3n_eviction_lock);
+        lru_remove(chdo);
+        used_size -= std::min(used_size, chdo->size);
+      }
       delete chdo;
+      if (r != -1) {
+        ::remove(location.c_str());
+      }
       exist = false;
     }
   }
   return exist;
 }
 
+void D3nDataCache::evict_entry()
+{
+  std::unique_lock l(d3n_eviction_lock);
+  while (!evict_stop) {
+    if (used_size + outstanding_write_size <= high_watermark) {
+      evict_cond.wait(l);
+      continue;
+    }
+    ldout(cct, 20) << "D3nDataCache: enter eviction, used_size=" << used_size << dendl;
+    while (!evict_stop && used_size + outstanding_write_size > low_watermark) {
+      l.unlock();
+      size_t sr = 0;
+      bool evicted = evict_one(&sr);
+      l.lock();
+      if (!evicted) {
+        break;
+      }
+      ldout(cct, 20) << "D3nDataCache: completed eviction of " << sr << " bytes" << dendl;
+    }
+    if (used_size + outstanding_write_size > high_watermark) {
+      // only outstanding writes left, wait for them to complete
+      evict_cond.wait_for(l, std::chrono::milliseconds(100));
+    }
+  }
+}
+
+bool D3nDataCache::evict_one(size_t* freed_size)
+{
+  size_t sr;
+  if (eviction_policy == _eviction_policy::RANDOM) {
+    sr = random_eviction();
+  } else {
+    sr = lru_eviction();
+  }
+  if (sr == 0 || sr == static_cast<size_t>(-1)) {
+    return false;
+  }
+  *freed_size = sr;
+  return true;
+}
+
 size_t D3nDataCache::random_eviction()
 {
   lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "()" << dendl;
-  int n_entries = 0;
-  int random_index = 0;
-  size_t freed_size = 0;
-  D3nChunkDataInfo* del_entry;
-  string del_oid, location;
-  {
-    const std::lock_guard l(d3n_cache_lock);
-    n_entries = d3n_cache_map.size();
-    if (n_entries <= 0) {
-      return -1;
+  size_t start = ceph::util::generate_random_number<size_t>(0, num_shards - 1);
+  for (size_t i = 0; i < num_shards; ++i) {
+    auto& shard = shards[(start + i) % num_shards];
+    const std::lock_guard l(shard.lock);
+    if (shard.map.empty()) {
+      continue;
     }
-    srand (time(NULL));
-    random_index = ceph::util::generate_random_number<int>(0, n_entries-1);
-    std::unordered_map<string, D3nChunkDataInfo*>::iterator iter = d3n_cache_map.begin();
+    auto random_index = ceph::util::generate_random_number<size_t>(0, shard.map.size() - 1);
+    auto iter = shard.map.begin();
     std::advance(iter, random_index);
-    del_oid = iter->first;
-    del_entry =  iter->second;
+    D3nChunkDataInfo* del_entry = iter->second;
     ldout(cct, 20) << "D3nDataCache: random_eviction: index:" << random_index << ", free size: " << del_entry->size << dendl;
-    freed_size = del_entry->size;
+    size_t freed_size = del_entry->size;
+    std::string location = cache_location + iter->first;
+    shard.map.erase(iter);
+    {
+      const std::lock_guard le(d3n_eviction_lock);
+      lru_remove(del_entry);
+      used_size -= std::min<uint64_t>(used_size, freed_size);
+    }
     delete del_entry;
-    del_entry = nullptr;
-    d3n_cache_map.erase(del_oid); // oid
+    ::remove(location.c_str());
+    return freed_size;
   }
-
-  location = cache_location + del_oid;
-  ::remove(location.c_str());
-  return freed_size;
+  return 0;
 }
 
 size_t D3nDataCache::lru_eviction()
 {
   lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "()" << dendl;
-  int n_entries = 0;
-  size_t freed_size = 0;
-  D3nChunkDataInfo* del_entry;
-  string del_oid, location;
-
-  {
-    const std::lock_guard l(d3n_eviction_lock);
-    del_entry = tail;
-    if (del_entry == nullptr) {
-      ldout(cct, 2) << "D3nDataCache: lru_eviction: del_entry=null_ptr" << dendl;
-      return 0;
+  while (true) {
+    string del_oid;
+    {
+      const std::lock_guard l(d3n_eviction_lock);
+      if (tail == nullptr) {
+        ldout(cct, 2) << "D3nDataCache: lru_eviction: del_entry=null_ptr" << dendl;
+        return 0;
+      }
+      del_oid = tail->oid;
     }
-    lru_remove(del_entry);
-  }
 
-  {
-    const std::lock_guard l(d3n_cache_lock);
-    n_entries = d3n_cache_map.size();
-    if (n_entries <= 0) {
-      ldout(cct, 2) << "D3nDataCache: lru_eviction: cache_map.size<=0" << dendl;
-      return -1;
+    auto& shard = get_shard(del_oid);
+    const std::lock_guard l(shard.lock);
+    auto iter = shard.map.find(del_oid);
+    if (iter == shard.map.end()) {
+      // lost a race with get() or another eviction, try the next entry
+      continue;
     }
-    del_oid = del_entry->oid;
     ldout(cct, 20) << "D3nDataCache: lru_eviction: oid to remove: " << del_oid << dendl;
-    d3n_cache_map.erase(del_oid); // oid
+    D3nChunkDataInfo* del_entry = iter->second;
+    size_t freed_size = del_entry->size;
+    shard.map.erase(iter);
+    {
+      const std::lock_guard le(d3n_eviction_lock);
+      lru_remove(del_entry);
+      used_size -= std::min<uint64_t>(used_size, freed_size);
+    }
+    delete del_entry;
+    std::string location = cache_location + del_oid;
+    ::remove(location.c_str());
+    return freed_size;
   }
-  freed_size = del_entry->size;
-  delete del_entry;
-  location = cache_location + del_oid;
-  ::remove(location.c_str());
-  return freed_size;
 }
@@ -9,12 +9,20 @@
 
 #include "rgw_common.h"
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <unordered_map>
 #include <unistd.h>
 #include <signal.h>
 #include "include/Context.h"
 #include "include/lru.h"
 #include "rgw_d3n_cacherequest.h"
 
+#ifdef HAVE_LIBURING
+struct io_uring;
+#endif
 
 /*D3nDataCache*/
 struct D3nDataCache;
@@ -63,9 +71,17 @@ struct D3nCacheAioWriteRequest {
 struct D3nDataCache {
 
 private:
-  std::unordered_map<std::string, D3nChunkDataInfo*> d3n_cache_map;
-  std::set<std::string> d3n_outstanding_write_list;
-  std::mutex d3n_cache_lock;
+  /* the index of cached chunks is sharded by oid; a chunk is linked into
+   * the LRU list exactly while it is in its shard's map, and both are only
+   * changed with the shard lock held (lock order: shard, then
+   * d3n_eviction_lock) */
+  struct Shard {
+    std::mutex lock;
+    std::unordered_map<std::string, D3nChunkDataInfo*> map;
+    std::set<std::string> outstanding_writes;
+  };
+  static constexpr size_t num_shards = 16;
+  std::array<Shard, num_shards> shards;
   std::mutex d3n_eviction_lock;
 
   CephContext *cct;
@@ -79,24 +95,65 @@ private:
   } eviction_policy;
 
   struct sigaction action;
-  uint64_t free_data_cache_size = 0;
+  uint64_t cache_size = 0;
+  uint64_t used_size = 0;
   uint64_t outstanding_write_size = 0;
-  struct D3nChunkDataInfo* head;
-  struct D3nChunkDataInfo* tail;
+  struct D3nChunkDataInfo* head = nullptr;
+  struct D3nChunkDataInfo* tail = nullptr;
+
+  // background eviction from the high to the low watermark
+  uint64_t high_watermark = 0;
+  uint64_t low_watermark = 0;
+  std::condition_variable evict_cond;
+  std::thread evict_thread;
+  bool evict_stop = false;
+
+  // chunks of objects larger than this are only admitted on their second
+  // access within the last admission_history misses; each miss is tagged
+  // with a sequence number so that an entry that was admitted, and maybe
+  // seen again since, isn't forgotten when its older slot expires
+  uint64_t admission_size_threshold = 0;
+  size_t admission_history = 0;
+  std::mutex admission_lock;
+  uint64_t admission_seq = 0;
+  std::unordered_map<uint64_t, uint64_t> admission_seen;
+  std::deque<std::pair<uint64_t, uint64_t>> admission_seen_order;
+
+  // chunks are written here and renamed into cache_location once complete,
+  // so that a crash never leaves a partial chunk under its oid
+  std::string write_location;
+
+#ifdef HAVE_LIBURING
+  std::unique_ptr<struct io_uring> ring;
+  std::mutex ring_lock;
+  std::thread ring_thread;
+
+  bool d3n_uring_init(unsigned queue_depth);
+  void d3n_uring_shutdown();
+  void d3n_uring_completion_loop();
+  int d3n_uring_create_write_request(bufferlist& bl, unsigned int len, const std::string& oid);
+#endif
 
 private:
   void add_io();
+  Shard& get_shard(const std::string& oid) {
+    return shards[std::hash<std::string>{}(oid) % num_shards];
+  }
+  void load_index();
+  bool admit(const std::string& oid, uint64_t obj_size);
+  void d3n_write_completion(const std::string& oid, uint64_t len, int r);
+  void evict_entry();
+  bool evict_one(size_t* freed_size);
+  void shutdown();
 
 public:
   D3nDataCache();
-  ~D3nDataCache() {
-    while (lru_eviction() > 0);
-  }
+  ~D3nDataCache();
 
   std::string cache_location;
 
   bool get(const std::string& oid, const off_t len);
-  void put(bufferlist& bl, unsigned int len, std::string& obj_key);
+  void put(bufferlist& bl, unsigned int len, std::string& obj_key, uint64_t obj_size = 0);
   int d3n_io_write(bufferlist& bl, unsigned int len, std::string oid);
   int d3n_libaio_create_write_request(bufferlist& bl, unsigned int len, std::string oid);
   void d3n_libaio_write_completion_cb(D3nCacheAioWriteRequest* c);
@@ -227,6 +284,7 @@ int D3nRGWDataCache<T>::get_obj_iterate_cb(const DoutPrefixProvider *dpp, const
       return r;
     }
 
+    d->d3n_obj_size = astate->size;
     const bool is_compressed = (astate->attrset.find(RGW_ATTR_COMPRESSION) != astate->attrset.end());
     const bool is_encrypted = (astate->attrset.find(RGW_ATTR_CRYPT_MODE) != astate->attrset.end());
     if (read_ofs != 0 || astate->size != astate->accounted_size || is_compressed || is_encrypted) {
@@ -2740,7 +2740,8 @@ public:
                                        key, dest_key, versioned_epoch,
                                        true,
                                        std::static_pointer_cast<RGWFetchObjFilter>(filter),
-                                       zones_trace, sync_env->counters, dpp));
+                                       zones_trace, sync_env->counters, dpp,
+                                       sc->bucket_sync_window));
         }
         if (retcode < 0) {
           if (*need_retry) {
@@ -4023,6 +4024,107 @@ public:
   }
 };
 
+RGWBucketSyncWindow::RGWBucketSyncWindow(CephContext *cct, PerfCounters *counters)
+  : cct(cct), counters(counters),
+    window(std::max<int64_t>(1, cct->_conf->rgw_bucket_sync_spawn_window))
+{
+  if (counters) {
+    counters->set(sync_counters::l_fetch_window, window);
+  }
+}
+
+int64_t RGWBucketSyncWindow::get() const
+{
+  const int64_t max_window = std::max<int64_t>(
+      cct->_conf->rgw_bucket_sync_spawn_window,
+      cct->_conf.get_val<int64_t>("rgw_bucket_sync_max_spawn_window"));
+  return std::clamp<int64_t>(window, 1, max_window);
+}
+
+size_t RGWBucketSyncWindow::size_class(uint64_t bytes)
+{
+  size_t c = 0;
+  for (uint64_t limit = 64 * 1024; c < num_size_classes - 1 && bytes > limit;
+       limit *= 16) {
+    ++c;
+  }
+  return c;
+}
+
+void RGWBucketSyncWindow::complete(ceph::timespan latency, uint64_t bytes, int r)
+{
+  std::lock_guard l{lock};
+  switch (r) {
+    case -EBUSY: // 503
+    case -EIO:
+    case -EAGAIN:
+    case -ETIMEDOUT:
+      failed = true;
+      break;
+    default:
+      if (r < 0) {
+        break;
+      }
+      auto& sc = size_classes[size_class(bytes)];
+      if (sc.base_latency == ceph::timespan::zero() || latency < sc.base_latency) {
+        sc.base_latency = latency;
+      } else {
+        // let a stale minimum follow the current latency, slowly
+        sc.base_latency += (latency - sc.base_latency) / 256;
+      }
+      if (sc.avg_latency == ceph::timespan::zero()) {
+        sc.avg_latency = latency;
+      } else {
+        sc.avg_latency += (latency - sc.avg_latency) / 8;
+      }
+      sc.sampled = true;
+  }
+  if (++completions < window) {
+    return;
+  }
+  completions = 0;
+
+  bool congested = false;
+  for (auto& sc : size_classes) {
+    if (sc.sampled && sc.avg_latency > 2 * sc.base_latency) {
+      ldout(cct, 20) << "bucket sync window: size class "
+          << (&sc - size_classes.data()) << " avg_latency=" << sc.avg_latency
+          << " base_latency=" << sc.base_latency << dendl;
+      congested = true;
+    }
+    sc.sampled = false;
+  }
+
+  const int64_t min_window = std::max<int64_t>(1, cct->_conf->rgw_bucket_sync_spawn_window);
+  const int64_t max_window = std::max(min_window,
+      cct->_conf.get_val<int64_t>("rgw_bucket_sync_max_spawn_window"));
+  int64_t w = window;
+  if (failed) {
+    w = std::max<int64_t>(1, w / 2);
+    failed = false;
+  } else if (congested) {
+    if (w > min_window) {
+      w = std::max(min_window, w / 2);
+    }
+  } else if (w < max_window) {
+    ++w;
+  }
+  w = std::min(w, max_window);
+  window = w;
+  ldout(cct, 20) << "bucket sync window=" << w << dendl;
+  if (counters) {
+    counters->set(sync_counters::l_fetch_window, w);
+  }
+}
+
+static int64_t bucket_sync_spawn_window(RGWDataSyncCtx *sc)
+{
+  if (sc->bucket_sync_window) {
+    return sc->bucket_sync_window->get();
+  }
+  return sc->cct->_conf->rgw_bucket_sync_spawn_window;
+}
+
 static bool ignore_sync_error(int err) {
   switch (err) {
     case -ENOENT:
@@ -4356,7 +4458,7 @@ int RGWBucketFullSyncCR::operate(const DoutPrefixProvider *dpp)
                                  entry->key, &marker_tracker, zones_trace, tn),
                       false);
         }
-        drain_with_cb(cct->_conf->rgw_bucket_sync_spawn_window,
+        drain_with_cb(bucket_sync_spawn_window(sc),
                       [&](uint64_t stack_id, int ret) {
                 if (ret < 0) {
                   tn->log(10, "a sync operation returned error");
@@ -4750,7 +4852,7 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
                   false);
           }
         // }
-        drain_with_cb(cct->_conf->rgw_bucket_sync_spawn_window,
+        drain_with_cb(bucket_sync_spawn_window(sc),
                       [&](uint64_t stack_id, int ret) {
                 if (ret < 0) {
                   tn->log(10, "a sync operation returned error");
@@ -347,6 +347,44 @@ void pretty_print(const RGWDataSyncEnv* env, T&& ...t) {
   }
 }
 
+// Adapts the number of objects that each bucket shard fetches concurrently
+// from a source zone. The window grows by one for each window's worth of
+// fetches while their latency stays close to the lowest one seen, i.e. to the
+// round-trip time to the source zone, plus the transfer time of the object.
+// The latencies are tracked per object size class, so that a mix of small and
+// large objects isn't taken for congestion. The window is halved when the
+// latency of a size class doubles, as requests then queue up in either zone,
+// though not below rgw_bucket_sync_spawn_window, and when the source zone
+// fails or rejects requests. The fetches complete on the async rados threads.
+class RGWBucketSyncWindow {
+public:
+  // objects of up to 64K, 1M, 16M and larger ones
+  static constexpr size_t num_size_classes = 4;
+  static size_t size_class(uint64_t bytes);
+
+private:
+  struct SizeClass {
+    ceph::timespan base_latency = ceph::timespan::zero();
+    ceph::timespan avg_latency = ceph::timespan::zero();
+    bool sampled = false; // since the last adjustment
+  };
+
+  CephContext *cct;
+  PerfCounters *counters;
+  ceph::mutex lock = ceph::make_mutex("RGWBucketSyncWindow");
+  std::atomic<int64_t> window;
+  int64_t completions = 0; // since the last adjustment
+  bool failed = false;
+  std::array<SizeClass, num_size_classes> size_classes;
+
+public:
+  RGWBucketSyncWindow(CephContext *cct, PerfCounters *counters);
+
+  int64_t get() const;
+  // account for a completed fetch of the given number of bytes, with its result
+  void complete(ceph::timespan latency, uint64_t bytes, int r);
+};
+
 struct RGWDataSyncCtx {
   RGWDataSyncEnv *env{nullptr};
   CephContext *cct{nullptr};
@@ -354,12 +392,15 @@ struct RGWDataSyncCtx {
   RGWRESTConn *conn{nullptr};
   rgw_zone_id source_zone;
 
+  std::shared_ptr<RGWBucketSyncWindow> bucket_sync_window;
+
   RGWDataSyncCtx() = default;
 
   RGWDataSyncCtx(RGWDataSyncEnv* env,
 		 RGWRESTConn* conn,
 		 const rgw_zone_id& source_zone)
-    : env(env), cct(env->cct), conn(conn), source_zone(source_zone) {}
+    : env(env), cct(env->cct), conn(conn), source_zone(source_zone),
+      bucket_sync_window(std::make_shared<RGWBucketSyncWindow>(env->cct, env->counters)) {}
 
   void init(RGWDataSyncEnv *_env,
             RGWRESTConn *_conn,
@@ -368,6 +409,7 @@ struct RGWDataSyncCtx {
     env = _env;
     conn = _conn;
     source_zone = _source_zone;
+    bucket_sync_window = std::make_shared<RGWBucketSyncWindow>(cct, env->counters);
   }
 };
 
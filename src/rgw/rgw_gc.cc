@@ -14,6 +14,7 @@
 #include "cls/lock/cls_lock_client.h"
 #include "include/random.h"
 #include "rgw_gc_log.h"
+#include "rgw_gc_batch.h"
 
 #include <list> // XXX
 #include <sstream>
@@ -350,6 +351,7 @@ class RGWGCIOManager {
     string oid;
     int index{-1};
     string tag;
+    ceph::mono_time start;
   };
 
   deque<IO> ios;
@@ -359,14 +361,14 @@ class RGWGCIOManager {
    */
   vector<map<string, size_t> > tag_io_size;
 
-#define MAX_AIO_DEFAULT 10
-  size_t max_aio{MAX_AIO_DEFAULT};
+  RGWGCIOWindow window;
 
 public:
   RGWGCIOManager(const DoutPrefixProvider* _dpp, CephContext *_cct, RGWGC *_gc) : dpp(_dpp),
                                                                                   cct(_cct),
-                                                                                  gc(_gc) {
-    max_aio = cct->_conf->rgw_gc_max_concurrent_io;
+                                                                                  gc(_gc),
+                                                                                  window(_cct->_conf->rgw_gc_max_concurrent_io,
+                                                                                         _cct->_conf.get_val<std::chrono::milliseconds>("rgw_gc_io_target_latency")) {
     remove_tags.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
     tag_io_size.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
   }
@@ -379,7 +381,7 @@ public:
 
   int schedule_io(IoCtx *ioctx, const string& oid, ObjectWriteOperation *op,
 		  int index, const string& tag) {
-    while (ios.size() > max_aio) {
+    while (ios.size() > window.size()) {
       if (gc->going_down()) {
         return 0;
       }
@@ -395,7 +397,7 @@ public:
     if (ret < 0) {
       return ret;
     }
-    ios.push_back(IO{IO::TailIO, c, oid, index, tag});
+    ios.push_back(IO{IO::TailIO, c, oid, index, tag, ceph::mono_clock::now()});
 
     return 0;
   }
@@ -403,10 +405,21 @@ public:
   int handle_next_completion() {
     ceph_assert(!ios.empty());
     IO& io = ios.front();
+    const bool waited = !io.c->is_complete();
     io.c->wait_for_complete();
     int ret = io.c->get_return_value();
     io.c->release();
 
+    if (io.type == IO::TailIO) {
+      if (window.adjust(ceph::mono_clock::now() - io.start, waited) &&
+          perfcounter) {
+        perfcounter->set(l_rgw_gc_io_window, window.size());
+      }
+      if (perfcounter) {
+        perfcounter->inc(l_rgw_gc_tail_remove);
+      }
+    }
+
     if (ret == -ENOENT) {
       ret = 0;
     }
@@ -544,6 +557,32 @@ public:
   }
 }; // class RGWGCIOManger
 
+/* a tail object of a gc entry, ordered by pool and placement group */
+struct GCTailObj {
+  const cls_rgw_obj* obj;
+  const string* tag;
+  IoCtx* ctx;
+  uint32_t pg_order;
+
+  bool operator<(const GCTailObj& rhs) const {
+    int r = obj->pool.compare(rhs.obj->pool);
+    if (r != 0) {
+      return r < 0;
+    }
+    return pg_order < rhs.pg_order;
+  }
+};
+
+static uint32_t pg_order(IoCtx& ctx, const cls_rgw_obj& obj)
+{
+  uint32_t hash = 0;
+  if (ctx.get_object_pg_hash_position2(obj.loc.empty() ? obj.key.name : obj.loc,
+                                       &hash) < 0) {
+    return 0;
+  }
+  return gc_pg_order(hash);
+}
+
 int RGWGC::process(int index, int max_secs, bool expired_only,
                    RGWGCIOManager& io_manager)
 {
@@ -577,7 +616,9 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
   string marker;
   string next_marker;
   bool truncated;
-  IoCtx *ctx = new IoCtx;
+  map<string, IoCtx> ctxs;
+  RGWGCQueueBatch queue_batch(
+    cct->_conf.get_val<uint64_t>("rgw_gc_max_queue_batch"));
   do {
     int max = 100;
     std::list<cls_rgw_gc_obj_info> entries;
@@ -627,21 +668,22 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
 
     marker = next_marker;
 
-    string last_pool;
-    std::list<cls_rgw_gc_obj_info>::iterator iter;
-    for (iter = entries.begin(); iter != entries.end(); ++iter) {
-      cls_rgw_gc_obj_info& info = *iter;
-
+    {
+    /* collect the tail objects of the listed entries, and send their
+     * removals ordered by placement group, so that consecutive ios go to
+     * the same osds */
+    std::vector<GCTailObj> tail_objs;
+    uint32_t num_entries = 0;
+    for (auto& info : entries) {
       ldpp_dout(this, 20) << "RGWGC::process iterating over entry tag='" <<
 	info.tag << "', time=" << info.time << ", chain.objs.size()=" <<
 	info.chain.objs.size() << dendl;
 
-      std::list<cls_rgw_obj>::iterator liter;
       cls_rgw_obj_chain& chain = info.chain;
 
       utime_t now = ceph_clock_now();
       if (now >= end) {
-        goto done;
+        break;
       }
       if (! transitioned_objects_cache[index]) {
         if (chain.objs.empty()) {
@@ -650,65 +692,76 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
           io_manager.add_tag_io_size(index, info.tag, chain.objs.size());
         }
       }
-      if (! chain.objs.empty()) {
-	for (liter = chain.objs.begin(); liter != chain.objs.end(); ++liter) {
-	  cls_rgw_obj& obj = *liter;
-
-	  if (obj.pool != last_pool) {
-	    delete ctx;
-	    ctx = new IoCtx;
-	    ret = rgw_init_ioctx(this, store->get_rados_handle(), obj.pool, *ctx);
-	    if (ret < 0) {
-        if (transitioned_objects_cache[index]) {
-          goto done;
-        }
-	      last_pool = "";
-	      ldpp_dout(this, 0) << "ERROR: failed to create ioctx pool=" <<
-		obj.pool << dendl;
-	      continue;
+      for (auto& obj : chain.objs) {
+	auto ctx = ctxs.find(obj.pool);
+	if (ctx == ctxs.end()) {
+	  IoCtx new_ctx;
+	  ret = rgw_init_ioctx(this, store->get_rados_handle(), obj.pool, new_ctx);
+	  if (ret < 0) {
+	    if (transitioned_objects_cache[index]) {
+	      goto done;
 	    }
-	    last_pool = obj.pool;
+	    ldpp_dout(this, 0) << "ERROR: failed to create ioctx pool=" <<
+	      obj.pool << dendl;
+	    continue;
 	  }
+	  ctx = ctxs.emplace(obj.pool, std::move(new_ctx)).first;
+	}
+	tail_objs.push_back(GCTailObj{&obj, &info.tag, &ctx->second,
+				      pg_order(ctx->second, obj)});
+      }
+      ++num_entries;
+    }
 
-	  ctx->locator_set_key(obj.loc);
+    std::sort(tail_objs.begin(), tail_objs.end());
+    for (auto& tail : tail_objs) {
+      const cls_rgw_obj& obj = *tail.obj;
+      tail.ctx->locator_set_key(obj.loc);
 
-	  const string& oid = obj.key.name; /* just stored raw oid there */
+      const string& oid = obj.key.name; /* just stored raw oid there */
 
-	  ldpp_dout(this, 5) << "RGWGC::process removing " << obj.pool <<
-	    ":" << obj.key.name << dendl;
-	  ObjectWriteOperation op;
-	  cls_refcount_put(op, info.tag, true);
+      ldpp_dout(this, 5) << "RGWGC::process removing " << obj.pool <<
+	":" << obj.key.name << dendl;
+      ObjectWriteOperation op;
+      cls_refcount_put(op, *tail.tag, true);
 
-	  ret = io_manager.schedule_io(ctx, oid, &op, index, info.tag);
-	  if (ret < 0) {
-	    ldpp_dout(this, 0) <<
-	      "WARNING: failed to schedule deletion for oid=" << oid << dendl;
-      if (transitioned_objects_cache[index]) {
-        //If deleting oid failed for any of them, we will not delete queue entries
-        goto done;
-      }
-	  }
-	  if (going_down()) {
-	    // leave early, even if tag isn't removed, it's ok since it
-	    // will be picked up next time around
-	    goto done;
-	  }
-	} // chains loop
-      } // else -- chains not empty
-    } // entries loop
-    if (transitioned_objects_cache[index] && entries.size() > 0) {
-      ret = io_manager.drain_ios();
+      ret = io_manager.schedule_io(tail.ctx, oid, &op, index, *tail.tag);
       if (ret < 0) {
-        goto done;
+	ldpp_dout(this, 0) <<
+	  "WARNING: failed to schedule deletion for oid=" << oid << dendl;
+	if (transitioned_objects_cache[index]) {
+	  //If deleting oid failed for any of them, we will not delete queue entries
+	  goto done;
+	}
       }
-      //Remove the entries from the queue
-      ldpp_dout(this, 5) << "RGWGC::process removing entries, marker: " << marker << dendl;
-      ret = io_manager.remove_queue_entries(index, entries.size());
-      if (ret < 0) {
-        ldpp_dout(this, 0) <<
-          "WARNING: failed to remove queue entries" << dendl;
-        goto done;
+      if (going_down()) {
+	// leave early, even if tag isn't removed, it's ok since it
+	// will be picked up next time around
+	goto done;
       }
+    } // tail objs loop
+
+    if (transitioned_objects_cache[index]) {
+      /* out of time, remove the entries processed so far */
+      if (queue_batch.add(num_entries, entries.size(), &truncated)) {
+        ret = io_manager.drain_ios();
+        if (ret < 0) {
+          goto done;
+        }
+        //Remove the entries from the queue
+        const uint32_t num_removed = queue_batch.take();
+        ldpp_dout(this, 5) << "RGWGC::process removing " << num_removed <<
+          " entries, marker: " << marker << dendl;
+        ret = num_removed ? io_manager.remove_queue_entries(index, num_removed) : 0;
+        if (ret < 0) {
+          ldpp_dout(this, 0) <<
+            "WARNING: failed to remove queue entries" << dendl;
+          goto done;
+        }
+      }
+    } else if (num_entries < entries.size()) {
+      goto done;
+    }
     }
   } while (truncated);
 
@@ -717,7 +770,6 @@ done:
    * hold the system if backend is unresponsive
    */
   l.unlock(&store->gc_pool_ctx, obj_names[index]);
-  delete ctx;
 
   return 0;
 }
@@ -0,0 +1,95 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include "common/ceph_time.h"
+
+
+/* the number of gc tail ios in flight adapts to the latency of the osds: the
+ * window shrinks by a quarter when an io takes longer than the target
+ * latency, and grows by one once a window's worth of ios completed in time,
+ * up to max. a zero target latency keeps the window at max */
+class RGWGCIOWindow {
+  size_t max;
+  size_t window;
+  size_t window_ios{0}; // tail ios completed since the last adjustment
+  ceph::timespan target_latency;
+
+public:
+  RGWGCIOWindow(size_t max, ceph::timespan target_latency)
+    : max(std::max<size_t>(1, max)), window(this->max),
+      target_latency(target_latency) {}
+
+  size_t size() const { return window; }
+
+  // account for a completed tail io; returns true if the window changed
+  bool adjust(ceph::timespan latency, bool waited) {
+    if (target_latency == ceph::timespan::zero()) {
+      return false;
+    }
+    ++window_ios;
+    if (latency > target_latency) {
+      /* only an io we had to wait for shows that the osds are slow, and
+       * the ios sent before a decrease don't count against the new window */
+      if (waited && window_ios >= window) {
+        window_ios = 0;
+        if (window > 1) {
+          window -= std::max<size_t>(1, window / 4);
+          return true;
+        }
+      }
+    } else if (window_ios >= window) {
+      window_ios = 0;
+      if (window < max) {
+        ++window;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/* placement groups are selected by the low bits of the object hash, so the
+ * bit-reversed hash sorts the objects of each pg next to each other,
+ * whatever the pg_num of the pool */
+inline uint32_t gc_pg_order(uint32_t hash)
+{
+  hash = ((hash >> 1) & 0x55555555) | ((hash & 0x55555555) << 1);
+  hash = ((hash >> 2) & 0x33333333) | ((hash & 0x33333333) << 2);
+  hash = ((hash >> 4) & 0x0f0f0f0f) | ((hash & 0x0f0f0f0f) << 4);
+  hash = ((hash >> 8) & 0x00ff00ff) | ((hash & 0x00ff00ff) << 8);
+  return (hash >> 16) | (hash << 16);
+}
+
+/* queue entries whose tail objects were all scheduled for removal; they are
+ * removed from the head of the queue in bulk once their ios drained */
+class RGWGCQueueBatch {
+  uint32_t max_batch;
+  uint32_t batch{0};
+
+public:
+  explicit RGWGCQueueBatch(uint32_t max_batch)
+    : max_batch(std::max<uint32_t>(1, max_batch)) {}
+
+  /* account for the entries processed out of a listed page. processing
+   * fewer entries than were listed means that we ran out of time, which
+   * ends the listing by clearing truncated. returns true when the batch
+   * has to be removed from the queue */
+  bool add(uint32_t processed, uint32_t listed, bool* truncated) {
+    batch += processed;
+    if (processed < listed) {
+      *truncated = false;
+    }
+    return batch >= max_batch || !*truncated;
+  }
+
+  // the number of entries to remove from the queue, resetting the batch
+  uint32_t take() {
+    uint32_t n = batch;
+    batch = 0;
+    return n;
+  }
+};
@@ -0,0 +1,464 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#include "rgw_hash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <thread>
+#include <vector>
+
+#include "include/crc32c.h"
+#include "include/ceph_assert.h"
+#include "common/ceph_context.h"
+#include "common/async/completion.h"
+#include "common/ceph_mutex.h"
+#include "rgw_b64.h"
+
+#ifdef HAVE_ISAL_CRYPTO_MB
+#include "md5_mb.h"
+#include "sha256_mb.h"
+#endif
+
+namespace rgw::hash {
+
+struct Digest::Stream {
+  virtual ~Stream() = default;
+  virtual void restart() = 0;
+  virtual void update(const unsigned char *input, size_t length) = 0;
+  virtual void final(unsigned char *digest) = 0;
+};
+
+namespace {
+
+template <typename T>
+struct OpenSSLStream : Digest::Stream {
+  T digest;
+  OpenSSLStream() {
+    // Allow use of MD5 digest in FIPS mode for non-cryptographic purposes
+    digest.SetFlags(EVP_MD_CTX_FLAG_NON_FIPS_ALLOW);
+  }
+  void restart() override {
+    digest.Restart();
+  }
+  void update(const unsigned char *input, size_t length) override {
+    digest.Update(input, length);
+  }
+  void final(unsigned char *out) override {
+    digest.Final(out);
+  }
+};
+
+std::unique_ptr<Digest::Stream> make_openssl_stream(Algorithm alg)
+{
+  switch (alg) {
+  case Algorithm::MD5:
+    return std::make_unique<OpenSSLStream<ceph::crypto::MD5>>();
+  case Algorithm::SHA256:
+    return std::make_unique<OpenSSLStream<ceph::crypto::SHA256>>();
+  }
+  ceph_abort();
+}
+
+} // anonymous namespace
+
+#ifdef HAVE_ISAL_CRYPTO_MB
+
+namespace {
+
+struct MD5Traits {
+  using Mgr = MD5_HASH_CTX_MGR;
+  using Ctx = MD5_HASH_CTX;
+  static void init(Mgr *mgr) {
+    md5_ctx_mgr_init(mgr);
+  }
+  static Ctx* submit(Mgr *mgr, Ctx *ctx, const void *buf, uint32_t len,
+                     HASH_CTX_FLAG flags) {
+    return md5_ctx_mgr_submit(mgr, ctx, buf, len, flags);
+  }
+  static Ctx* flush(Mgr *mgr) {
+    return md5_ctx_mgr_flush(mgr);
+  }
+  static void digest(const Ctx& ctx, unsigned char *out) {
+    // md5 words are little-endian
+    for (int i = 0; i < MD5_DIGEST_NWORDS; i++) {
+      const uint32_t w = ctx.job.result_digest[i];
+      *out++ = w;
+      *out++ = w >> 8;
+      *out++ = w >> 16;
+      *out++ = w >> 24;
+    }
+  }
+};
+
+struct SHA256Traits {
+  using Mgr = SHA256_HASH_CTX_MGR;
+  using Ctx = SHA256_HASH_CTX;
+  static void init(Mgr *mgr) {
+    sha256_ctx_mgr_init(mgr);
+  }
+  static Ctx* submit(Mgr *mgr, Ctx *ctx, const void *buf, uint32_t len,
+                     HASH_CTX_FLAG flags) {
+    return sha256_ctx_mgr_submit(mgr, ctx, buf, len, flags);
+  }
+  static Ctx* flush(Mgr *mgr) {
+    return sha256_ctx_mgr_flush(mgr);
+  }
+  static void digest(const Ctx& ctx, unsigned char *out) {
+    // sha256 words are big-endian
+    for (int i = 0; i < SHA256_DIGEST_NWORDS; i++) {
+      const uint32_t w = ctx.job.result_digest[i];
+      *out++ = w >> 24;
+      *out++ = w >> 16;
+      *out++ = w >> 8;
+      *out++ = w;
+    }
+  }
+};
+
+// A multi-buffer hash manager shared by a set of streams. Each caller queues
+// its update and then either waits for the thread that is currently running
+// a batch, or becomes that thread: it takes everything queued so far, submits
+// it to the manager, which hashes up to one buffer per SIMD lane at once,
+// and flushes the remaining lanes. Without contention, a batch holds just the
+// caller's own update and nobody waits. Callers with a yield context wait by
+// suspending their coroutine. Callers without one don't block their thread:
+// if the manager is busy, they hash their update alone on a manager of their
+// thread.
+template <typename Traits>
+class Shard {
+  using Completion = ceph::async::Completion<void(boost::system::error_code)>;
+ public:
+  struct Job {
+    typename Traits::Ctx *ctx;
+    const unsigned char *buf;
+    uint32_t len;
+    HASH_CTX_FLAG flags;
+    bool done = false;
+    std::unique_ptr<Completion> completion;
+  };
+
+  Shard() : mgr(std::make_unique<typename Traits::Mgr>()) {
+    Traits::init(mgr.get());
+  }
+
+  void run(Job& job, optional_yield y) {
+    std::unique_lock l{lock};
+    if (busy && !y) {
+      l.unlock();
+      run_alone(job);
+      return;
+    }
+    queue.push_back(&job);
+    while (!job.done) {
+      if (busy) {
+        // only callers with a yield context get here
+        boost::system::error_code ec;
+        async_wait(job, l, y, y.get_yield_context()[ec]);
+        l.lock();
+        continue;
+      }
+      busy = true;
+      std::vector<Job*> batch;
+      batch.swap(queue);
+      l.unlock();
+
+      // each stream has at most one update queued, since its caller waits
+      // for it to complete
+      for (auto j : batch) {
+        Traits::submit(mgr.get(), j->ctx, j->buf, j->len, j->flags);
+      }
+      while (Traits::flush(mgr.get()) != nullptr)
+        ;
+      for (auto j : batch) {
+        ceph_assert(hash_ctx_error(j->ctx) == HASH_CTX_ERROR_NONE);
+      }
+
+      l.lock();
+      for (auto j : batch) {
+        j->done = true;
+        wake(*j);
+      }
+      busy = false;
+      // the first of the updates queued meanwhile runs the next batch
+      for (auto j : queue) {
+        wake(*j);
+      }
+    }
+  }
+
+ private:
+  template <typename CompletionToken>
+  auto async_wait(Job& job, std::unique_lock<ceph::mutex>& l,
+                  optional_yield y, CompletionToken&& token) {
+    using boost::asio::async_completion;
+    using Signature = void(boost::system::error_code);
+    async_completion<CompletionToken, Signature> init(token);
+    job.completion = Completion::create(y.get_io_context().get_executor(),
+                                        std::move(init.completion_handler));
+    l.unlock();
+    return init.result.get();
+  }
+
+  static void wake(Job& job) {
+    if (job.completion) {
+      ceph::async::post(std::move(job.completion), boost::system::error_code{});
+    }
+  }
+
+  static void run_alone(Job& job) {
+    thread_local std::unique_ptr<typename Traits::Mgr> own = [] {
+      auto m = std::make_unique<typename Traits::Mgr>();
+      Traits::init(m.get());
+      return m;
+    }();
+    Traits::submit(own.get(), job.ctx, job.buf, job.len, job.flags);
+    while (Traits::flush(own.get()) != nullptr)
+      ;
+    ceph_assert(hash_ctx_error(job.ctx) == HASH_CTX_ERROR_NONE);
+  }
+
+ private:
+  ceph::mutex lock = ceph::make_mutex("rgw::hash::Shard");
+  bool busy = false;
+  std::vector<Job*> queue;
+  std::unique_ptr<typename Traits::Mgr> mgr;
+};
+
+template <typename Traits>
+class MultiBufferStream : public Digest::Stream {
+  // isa-l takes 32-bit lengths
+  static constexpr size_t max_update = 1u << 30;
+
+  Shard<Traits>& shard;
+  optional_yield y;
+  std::unique_ptr<typename Traits::Ctx> ctx;
+  bool started = false;
+
+  void submit(const unsigned char *buf, uint32_t len, HASH_CTX_FLAG flags) {
+    typename Shard<Traits>::Job job{ctx.get(), buf, len, flags};
+    shard.run(job, y);
+  }
+
+ public:
+  MultiBufferStream(Shard<Traits>& shard, optional_yield y)
+    : shard(shard), y(y), ctx(std::make_unique<typename Traits::Ctx>()) {
+    hash_ctx_init(ctx.get());
+  }
+
+  void restart() override {
+    hash_ctx_init(ctx.get());
+    started = false;
+  }
+
+  void update(const unsigned char *input, size_t length) override {
+    while (length > 0) {
+      const uint32_t len = std::min(length, max_update);
+      submit(input, len, started ? HASH_UPDATE : HASH_FIRST);
+      started = true;
+      input += len;
+      length -= len;
+    }
+  }
+
+  void final(unsigned char *out) override {
+    static const unsigned char empty[1] = {};
+    submit(empty, 0, started ? HASH_LAST : HASH_ENTIRE);
+    Traits::digest(*ctx, out);
+    restart();
+  }
+};
+
+} // anonymous namespace
+
+class Engine {
+  std::vector<std::unique_ptr<Shard<MD5Traits>>> md5_shards;
+  std::vector<std::unique_ptr<Shard<SHA256Traits>>> sha256_shards;
+  std::atomic<size_t> next_shard = 0;
+
+  template <typename Traits>
+  std::unique_ptr<Digest::Stream> make_stream(
+      std::vector<std::unique_ptr<Shard<Traits>>>& shards, optional_yield y) {
+    auto& shard = *shards[next_shard++ % shards.size()];
+    return std::make_unique<MultiBufferStream<Traits>>(shard, y);
+  }
+
+ public:
+  explicit Engine(CephContext *cct) {
+    // a batch is hashed on a single core, so share the lanes of each
+    // manager among the requests of a few cores
+    const size_t count = std::max(1u, std::thread::hardware_concurrency() / 4);
+    for (size_t i = 0; i < count; i++) {
+      md5_shards.push_back(std::make_unique<Shard<MD5Traits>>());
+      sha256_shards.push_back(std::make_unique<Shard<SHA256Traits>>());
+    }
+  }
+
+  std::unique_ptr<Digest::Stream> make_stream(Algorithm alg, optional_yield y) {
+    switch (alg) {
+    case Algorithm::MD5:
+      return make_stream(md5_shards, y);
+    case Algorithm::SHA256:
+      return make_stream(sha256_shards, y);
+    }
+    ceph_abort();
+  }
+
+  static Engine* get(CephContext *cct) {
+    if (!cct->_conf.get_val<bool>("rgw_multibuffer_hash")) {
+      return nullptr;
+    }
+    return &cct->lookup_or_create_singleton_object<Engine>(
+        "rgw::hash::Engine", false, cct);
+  }
+};
+
+bool multibuffer_enabled(CephContext *cct)
+{
+  return Engine::get(cct) != nullptr;
+}
+
+Digest::Digest(CephContext *cct, Algorithm alg, optional_yield y)
+{
+  if (auto engine = Engine::get(cct); engine) {
+    stream = engine->make_stream(alg, y);
+  } else {
+    stream = make_openssl_stream(alg);
+  }
+}
+
+#else // HAVE_ISAL_CRYPTO_MB
+
+bool multibuffer_enabled(CephContext *cct)
+{
+  return false;
+}
+
+Digest::Digest(CephContext *cct, Algorithm alg, optional_yield y)
+  : stream(make_openssl_stream(alg))
+{}
+
+#endif // HAVE_ISAL_CRYPTO_MB
+
+Digest::~Digest() = default;
+
+void Digest::Restart()
+{
+  stream->restart();
+}
+
+void Digest::Update(const unsigned char *input, size_t length)
+{
+  stream->update(input, length);
+}
+
+void Digest::Final(unsigned char *digest)
+{
+  stream->final(digest);
+}
+
+Checksum::Checksum(CephContext *cct, Type type, optional_yield y)
+  : type(type)
+{
+  if (type == Type::SHA256) {
+    sha256.emplace(cct, y);
+  }
+}
+
+std::optional<Checksum::Type> Checksum::parse(std::string_view name)
+{
+  auto equals = [name] (std::string_view s) {
+    return std::equal(name.begin(), name.end(), s.begin(), s.end(),
+                      [] (char a, char b) { return ::tolower(a) == b; });
+  };
+  if (equals("crc32c")) {
+    return Type::CRC32C;
+  }
+  if (equals("sha256")) {
+    return Type::SHA256;
+  }
+  return std::nullopt;
+}
+
+std::string_view Checksum::name(Type type)
+{
+  switch (type) {
+  case Type::CRC32C:
+    return "crc32c";
+  case Type::SHA256:
+    return "sha256";
+  }
+  ceph_abort();
+}
+
+bool Checksum::from_headers(
+    const char *sdk_algorithm,
+    const std::function<const char*(std::string_view)>& get_header,
+    std::optional<Type>* type, const char **value)
+{
+  if (sdk_algorithm) {
+    *type = parse(sdk_algorithm);
+  }
+  for (auto t : {Type::CRC32C, Type::SHA256}) {
+    const char *v = get_header(name(t));
+    if (!v) {
+      continue;
+    }
+    if (*value || (*type && **type != t)) {
+      return false;
+    }
+    *type = t;
+    *value = v;
+  }
+  return true;
+}
+
+void Checksum::update(const unsigned char *input, size_t length)
+{
+  switch (type) {
+  case Type::CRC32C:
+    // ceph_crc32c() is already accelerated on a single stream
+    crc = ceph_crc32c(crc, input, length);
+    break;
+  case Type::SHA256:
+    sha256->Update(input, length);
+    break;
+  }
+}
+
+std::string Checksum::final()
+{
+  switch (type) {
+  case Type::CRC32C:
+    {
+      const uint32_t value = ~crc;
+      const char buf[] = {
+        static_cast<char>(value >> 24), static_cast<char>(value >> 16),
+        static_cast<char>(value >> 8), static_cast<char>(value)
+      };
+      crc = ~0u;
+      return rgw::to_base64(std::string_view(buf, sizeof(buf)));
+    }
+  case Type::SHA256:
+    {
+      unsigned char buf[SHA256::digest_size];
+      sha256->Final(buf);
+      return rgw::to_base64(std::string_view(reinterpret_cast<char*>(buf),
+                                             sizeof(buf)));
+    }
+  }
+  ceph_abort();
+}
+
+} // namespace rgw::hash
@@ -0,0 +1,108 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation. See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "common/async/yield_context.h"
+#include "common/ceph_crypto.h"
+
+class CephContext;
+
+namespace rgw::hash {
+
+enum class Algorithm {
+  MD5,
+  SHA256,
+};
+
+// A streaming digest with the interface of ceph::crypto::MD5. When rgw is
+// built with isa-l_crypto, the updates of all the digests in flight are
+// batched onto the lanes of its multi-buffer hash managers (up to 16 streams
+// per AVX-512 core), so that concurrent uploads share the SIMD units instead
+// of hashing one buffer at a time. Otherwise, OpenSSL is used. With a yield
+// context, waiting for a batch suspends the coroutine; without one, an
+// update that would have to wait is hashed on its own instead.
+class Digest {
+ public:
+  struct Stream;
+
+  Digest(CephContext *cct, Algorithm alg, optional_yield y = null_yield);
+  ~Digest();
+
+  void Restart();
+  void Update(const unsigned char *input, size_t length);
+  void Final(unsigned char *digest);
+
+ private:
+  std::unique_ptr<Stream> stream;
+};
+
+class MD5 : public Digest {
+ public:
+  static constexpr size_t digest_size = CEPH_CRYPTO_MD5_DIGESTSIZE;
+  explicit MD5(CephContext *cct, optional_yield y = null_yield)
+    : Digest(cct, Algorithm::MD5, y) {}
+};
+
+class SHA256 : public Digest {
+ public:
+  static constexpr size_t digest_size = CEPH_CRYPTO_SHA256_DIGESTSIZE;
+  explicit SHA256(CephContext *cct, optional_yield y = null_yield)
+    : Digest(cct, Algorithm::SHA256, y) {}
+};
+
+// returns whether multi-buffer hashing is compiled in and enabled
+bool multibuffer_enabled(CephContext *cct);
+
+// S3 additional checksums (x-amz-checksum-*) of uploaded data
+class Checksum {
+ public:
+  enum class Type {
+    CRC32C,
+    SHA256,
+  };
+
+  Checksum(CephContext *cct, Type type, optional_yield y = null_yield);
+
+  // maps "CRC32C"/"SHA256" (in any case) to a type
+  static std::optional<Type> parse(std::string_view name);
+  // the x-amz-checksum-* header and attribute suffix, e.g. "crc32c"
+  static std::string_view name(Type type);
+  // picks the checksum of an upload from its x-amz-sdk-checksum-algorithm
+  // (if any) and its x-amz-checksum-* headers, looked up by name(). other
+  // algorithms are ignored, as all of them were before any was supported.
+  // returns false if the headers ask for different checksums
+  static bool from_headers(
+      const char *sdk_algorithm,
+      const std::function<const char*(std::string_view)>& get_header,
+      std::optional<Type>* type, const char **value);
+
+  Type get_type() const { return type; }
+
+  void update(const unsigned char *input, size_t length);
+  // returns the base64-encoded checksum
+  std::string final();
+
+ private:
+  Type type;
+  uint32_t crc = ~0u;
+  std::optional<SHA256> sha256;
+};
+
+} // namespace rgw::hash
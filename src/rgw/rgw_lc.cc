@@ -387,6 +387,11 @@ public:
     list_params.prefix = prefix;
   }
 
+  /* list a single index shard of the bucket */
+  void set_shard(int shard_id) {
+    list_params.shard_id = shard_id;
+  }
+
   int init(const DoutPrefixProvider *dpp) {
     return fetch(dpp);
   }
@@ -767,7 +772,7 @@ class RGWLC::WorkPool
 {
   using TVector = ceph::containers::tiny_vector<WorkQ, 3>;
   TVector wqs;
-  uint64_t ix;
+  std::atomic<uint64_t> ix;
 
 public:
   WorkPool(RGWLC::LCWorker* wk, uint16_t n_threads, uint32_t qmax)
@@ -791,9 +796,9 @@ public:
     }
   }
 
+  /* n.b., called concurrently by the listers of a bucket's index shards */
   void enqueue(WorkItem item) {
-    const auto tix = ix;
-    ix = (ix+1) % wqs.size();
+    const auto tix = ix++ % wqs.size();
     (wqs[tix]).enqueue(std::move(item));
   }
 
@@ -1503,8 +1508,220 @@ int LCOpRule::process(rgw_bucket_dir_entry& o,
 
 }
 
+static inline void get_lc_oid(CephContext *cct,
+			      const std::string& shard_id, string *oid);
+
+class SimpleBackoff
+{
+  const int max_retries;
+  std::chrono::milliseconds sleep_ms;
+  int retries{0};
+public:
+  SimpleBackoff(int max_retries, std::chrono::milliseconds initial_sleep_ms)
+    : max_retries(max_retries), sleep_ms(initial_sleep_ms)
+    {}
+  SimpleBackoff(const SimpleBackoff&) = delete;
+  SimpleBackoff& operator=(const SimpleBackoff&) = delete;
+
+  int get_retries() const {
+    return retries;
+  }
+
+  void reset() {
+    retries = 0;
+  }
+
+  bool wait_backoff(const fu2::unique_function<bool(void) const>& barrier) {
+    reset();
+    while (retries < max_retries) {
+      auto r = barrier();
+      if (r) {
+	return r;
+      }
+      std::this_thread::sleep_for(sleep_ms * 2 * retries++);
+    }
+    return false;
+  }
+};
+
+LCShardClaims::LCShardClaims(const DoutPrefixProvider* dpp,
+			     rgw::sal::Lifecycle* sal_lc,
+			     const std::string& lc_shard,
+			     const std::string& bucket_marker,
+			     time_t session, time_t ttl,
+			     const std::string& cookie)
+  : dpp(dpp), sal_lc(sal_lc), oid(lc_shard + ".shards"),
+    bucket_prefix(bucket_marker + ":"),
+    session_prefix(fmt::format("{}:{}:", bucket_marker, session)),
+    ttl(ttl), cookie(cookie)
+{}
+
+std::string LCShardClaims::key(int shard) const
+{
+  return session_prefix + std::to_string(shard);
+}
+
+bool LCShardClaims::expired(rgw::sal::Lifecycle::LCEntry& entry) const
+{
+  return entry.get_status() == lc_processing &&
+    time_t(entry.get_start_time()) + ttl < time(nullptr);
+}
+
+template <typename F>
+int LCShardClaims::for_each(const std::string& prefix, F&& f)
+{
+  std::string marker = prefix;
+  vector<std::unique_ptr<rgw::sal::Lifecycle::LCEntry>> entries;
+  do {
+    int ret = sal_lc->list_entries(oid, marker, 100, entries);
+    if (ret < 0) {
+      return ret;
+    }
+    for (auto& entry : entries) {
+      if (entry->get_bucket().compare(0, prefix.size(), prefix) != 0) {
+	return 0;
+      }
+      ret = f(*entry);
+      if (ret < 0) {
+	return ret;
+      }
+      marker = entry->get_bucket();
+    }
+  } while (!entries.empty());
+  return 0;
+}
+
+int LCShardClaims::claim(int shard)
+{
+  std::unique_ptr<rgw::sal::LCSerializer> lock =
+    sal_lc->get_serializer(lc_shard_claim_lock_name, oid, cookie);
+  int ret = 0;
+  SimpleBackoff backoff(10 /* max retries */, 10ms);
+  if (!backoff.wait_backoff([&] {
+	ret = lock->try_lock(dpp, utime_t(10, 0), null_yield);
+	return ret != -EBUSY && ret != -EEXIST;
+      })) {
+    return -EBUSY;
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  std::unique_lock<rgw::sal::LCSerializer> guard(*lock, std::adopt_lock);
+
+  std::unique_ptr<rgw::sal::Lifecycle::LCEntry> entry;
+  ret = sal_lc->get_entry(oid, key(shard), &entry);
+  if (ret == 0 && !expired(*entry)) {
+    return -EBUSY;
+  }
+  if (ret < 0 && ret != -ENOENT) {
+    return ret;
+  }
+  entry = sal_lc->get_entry();
+  entry->set_bucket(key(shard));
+  entry->set_start_time(time(nullptr));
+  entry->set_status(lc_processing);
+  return sal_lc->set_entry(oid, *entry);
+}
+
+int LCShardClaims::complete(int shard)
+{
+  auto entry = sal_lc->get_entry();
+  entry->set_bucket(key(shard));
+  entry->set_start_time(time(nullptr));
+  entry->set_status(lc_complete);
+  return sal_lc->set_entry(oid, *entry);
+}
+
+int LCShardClaims::release(int shard)
+{
+  auto entry = sal_lc->get_entry();
+  entry->set_bucket(key(shard));
+  int ret = sal_lc->rm_entry(oid, *entry);
+  return ret == -ENOENT ? 0 : ret;
+}
+
+int LCShardClaims::count(int* done, int* claimed)
+{
+  *done = 0;
+  *claimed = 0;
+  return for_each(session_prefix, [&] (auto& entry) {
+    if (entry.get_status() == lc_complete) {
+      ++*done;
+    } else if (!expired(entry)) {
+      ++*claimed;
+    }
+    return 0;
+  });
+}
+
+int LCShardClaims::clear()
+{
+  return for_each(bucket_prefix, [&] (auto& entry) {
+    int ret = sal_lc->rm_entry(oid, entry);
+    return ret == -ENOENT ? 0 : ret;
+  });
+}
+
+int RGWLC::bucket_lc_process_shard(rgw::sal::Bucket* bucket, int shard,
+				   multimap<string, lc_op>& prefix_map,
+				   LCWorker* worker, time_t stop_at, bool once,
+				   std::atomic<uint64_t>& listed)
+{
+  /* fetch information for zone checks */
+  rgw::sal::Zone* zone = store->get_zone();
+
+  for(auto prefix_iter = prefix_map.begin(); prefix_iter != prefix_map.end();
+      ++prefix_iter) {
+
+    if (worker_should_stop(stop_at, once) || going_down()) {
+      ldpp_dout(this, 5) << __func__ << " interval budget EXPIRED worker "
+		     << worker->ix
+		     << dendl;
+      return -ETIMEDOUT;
+    }
+
+    auto& op = prefix_iter->second;
+    if (!is_valid_op(op)) {
+      continue;
+    }
+    ldpp_dout(this, 20) << __func__ << "(): prefix=" << prefix_iter->first
+			<< " shard=" << shard << dendl;
+
+    if (! zone_check(op, zone)) {
+      ldpp_dout(this, 7) << "LC rule not executable in " << zone->get_tier_type()
+			 << " zone, skipping" << dendl;
+      continue;
+    }
+
+    LCObjsLister ol(store, bucket);
+    ol.set_prefix(prefix_iter->first);
+    ol.set_shard(shard);
+
+    int ret = ol.init(this);
+    if (ret < 0) {
+      if (ret == (-ENOENT))
+        return 0;
+      ldpp_dout(this, 0) << "ERROR: store->list_objects():" << dendl;
+      return ret;
+    }
+
+    op_env oenv(op, store, worker, bucket, ol);
+    LCOpRule orule(oenv);
+    orule.build(); // why can't ctor do it?
+    rgw_bucket_dir_entry* o{nullptr};
+    for (; ol.get_obj(this, &o /* , fetch_barrier */); ol.next()) {
+      orule.update();
+      std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
+      worker->workpool->enqueue(WorkItem{t1});
+      ++listed;
+    }
+  }
+  return 0;
+}
+
 int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
-			     time_t stop_at, bool once)
+			     time_t stop_at, bool once, time_t session,
+			     bool join)
 {
   RGWLifecycleConfiguration  config(cct);
   std::unique_ptr<rgw::sal::Bucket> bucket;
@@ -1516,7 +1733,8 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
   string bucket_name = result[1];
   string bucket_marker = result[2];
 
-  ldpp_dout(this, 5) << "RGWLC::bucket_lc_process ENTER " << bucket_name << dendl;
+  ldpp_dout(this, 5) << "RGWLC::bucket_lc_process ENTER " << bucket_name
+		     << (join ? " (joining)" : "") << dendl;
   if (unlikely(cct->_conf->rgwlc_skip_bucket_step)) {
     return 0;
   }
@@ -1535,6 +1753,16 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
     return ret;
   }
 
+  /* each index shard is listed separately, unsharded buckets are listed
+   * as a whole */
+  const uint32_t num_shards =
+    bucket->get_info().layout.current_index.layout.normal.num_shards;
+  const int num_partitions = std::max<uint32_t>(num_shards, 1);
+  /* other LC workers can only help with sharded buckets */
+  if (join && num_partitions == 1) {
+    return 0;
+  }
+
   auto stack_guard = make_scope_guard(
     [&worker]
       {
@@ -1568,9 +1796,6 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
       return -1;
     }
 
-  /* fetch information for zone checks */
-  rgw::sal::Zone* zone = store->get_zone();
-
   auto pf = [](RGWLC::LCWorker* wk, WorkQ* wq, WorkItem& wi) {
     auto wt =
       boost::get<std::tuple<LCOpRule, rgw_bucket_dir_entry>>(wi);
@@ -1594,98 +1819,163 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
 		      << prefix_map.size()
 		      << dendl;
 
-  rgw_obj_key pre_marker;
-  rgw_obj_key next_marker;
-  for(auto prefix_iter = prefix_map.begin(); prefix_iter != prefix_map.end();
-      ++prefix_iter) {
-
-    if (worker_should_stop(stop_at, once)) {
-      ldpp_dout(this, 5) << __func__ << " interval budget EXPIRED worker "
-		     << worker->ix
-		     << dendl;
-      return 0;
+  const time_t interval = (cct->_conf->rgw_lc_debug_interval > 0)
+    ? cct->_conf->rgw_lc_debug_interval
+    : 24*60*60;
+  string lc_shard;
+  get_lc_oid(cct, shard_id, &lc_shard);
+  /* the workers taking part in a session of a sharded bucket, scheduled or
+   * started by radosgw-admin, coordinate through claims on its shards */
+  std::optional<LCShardClaims> claims;
+  if (num_partitions > 1) {
+    claims.emplace(this, sal_lc.get(), lc_shard, bucket_marker, session,
+		   interval, worker->thr_name());
+  }
+
+  /* the listers of this worker take the shards in turn, starting at a
+   * random one so that the workers joining the session spread out, and
+   * enqueue the expirations and transitions into the worker's workpool */
+  const auto start = ceph::mono_clock::now();
+  const int first_shard =
+    ceph::util::generate_random_number(0, num_partitions - 1);
+  std::atomic<int> next_shard = 0;
+  std::atomic<uint32_t> shards_done = 0;
+  std::atomic<uint64_t> listed = 0;
+  std::atomic<int> error = 0;
+  std::atomic<bool> stopped = false;
+
+  auto process_shards = [&] {
+    for (int i = next_shard++; i < num_partitions && error == 0;
+	 i = next_shard++) {
+      if (worker_should_stop(stop_at, once) || going_down()) {
+	stopped = true;
+	break;
+      }
+      const int shard = (first_shard + i) % num_partitions;
+      if (claims) {
+	int r = claims->claim(shard);
+	if (r == -EBUSY) {
+	  ldpp_dout(this, 20) << __func__ << "(): bucket=" << bucket_name
+			      << " shard=" << shard
+			      << " claimed by another LC worker" << dendl;
+	  continue;
+	}
+	if (r < 0) {
+	  ldpp_dout(this, 0) << "ERROR: " << __func__ << "(): failed to claim "
+			     << "shard " << shard << " of bucket " << bucket_name
+			     << ": " << cpp_strerror(r) << dendl;
+	  error = r;
+	  break;
+	}
+      }
+      int r = bucket_lc_process_shard(bucket.get(),
+				      num_shards > 0 ? shard : RGW_NO_SHARD,
+				      prefix_map, worker, stop_at, once,
+				      listed);
+      if (r < 0) {
+	/* give the shard back to the other workers of the session */
+	if (claims) {
+	  claims->release(shard);
+	}
+	if (r == -ETIMEDOUT) {
+	  stopped = true;
+	} else {
+	  error = r;
+	}
+	break;
+      }
+      if (claims) {
+	r = claims->complete(shard);
+	if (r < 0) {
+	  ldpp_dout(this, 0) << "ERROR: " << __func__ << "(): failed to mark "
+			     << "shard " << shard << " of bucket " << bucket_name
+			     << " done: " << cpp_strerror(r) << dendl;
+	  error = r;
+	  break;
+	}
+      }
+      const double elapsed = std::chrono::duration<double>(
+	ceph::mono_clock::now() - start).count();
+      ldpp_dout(this, 5) << __func__ << "(): bucket=" << bucket_name
+			 << " shard=" << shard << " done, "
+			 << ++shards_done << "/" << num_partitions << " shards, "
+			 << listed.load() << " objects listed ("
+			 << (elapsed > 0 ? listed / elapsed : 0) << " objects/s)"
+			 << dendl;
     }
+  };
 
-    auto& op = prefix_iter->second;
-    if (!is_valid_op(op)) {
-      continue;
+  const int num_listers = std::min<int64_t>(
+    num_partitions,
+    std::max<int64_t>(1, cct->_conf.get_val<int64_t>("rgw_lc_max_shard_listers")));
+  std::vector<std::thread> listers;
+  listers.reserve(num_listers - 1);
+  for (int i = 1; i < num_listers; ++i) {
+    listers.push_back(make_named_thread("lc_lister", process_shards));
+  }
+  process_shards();
+  for (auto& t : listers) {
+    t.join();
+  }
+
+  /* the owner of the session takes the shards that the workers which joined
+   * it gave back or abandoned, and waits for the others to be done */
+  while (claims && !join && error == 0 && !stopped) {
+    int done = 0, claimed = 0;
+    int r = claims->count(&done, &claimed);
+    if (r < 0) {
+      error = r;
+      break;
     }
-    ldpp_dout(this, 20) << __func__ << "(): prefix=" << prefix_iter->first
-			<< dendl;
-    if (prefix_iter != prefix_map.begin() && 
-        (prefix_iter->first.compare(0, prev(prefix_iter)->first.length(),
-				    prev(prefix_iter)->first) == 0)) {
-      next_marker = pre_marker;
-    } else {
-      pre_marker = next_marker;
+    if (done == num_partitions) {
+      break;
     }
-
-    LCObjsLister ol(store, bucket.get());
-    ol.set_prefix(prefix_iter->first);
-
-    if (! zone_check(op, zone)) {
-      ldpp_dout(this, 7) << "LC rule not executable in " << zone->get_tier_type()
-			 << " zone, skipping" << dendl;
-      continue;
+    if (worker_should_stop(stop_at, once) || going_down()) {
+      stopped = true;
+      break;
     }
-
-    ret = ol.init(this);
-    if (ret < 0) {
-      if (ret == (-ENOENT))
-        return 0;
-      ldpp_dout(this, 0) << "ERROR: store->list_objects():" << dendl;
-      return ret;
+    if (done + claimed < num_partitions) {
+      next_shard = 0;
+      process_shards();
+    } else {
+      std::this_thread::sleep_for(1s);
     }
+  }
+  worker->workpool->drain();
 
-    op_env oenv(op, store, worker, bucket.get(), ol);
-    LCOpRule orule(oenv);
-    orule.build(); // why can't ctor do it?
-    rgw_bucket_dir_entry* o{nullptr};
-    for (; ol.get_obj(this, &o /* , fetch_barrier */); ol.next()) {
-      orule.update();
-      std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
-      worker->workpool->enqueue(WorkItem{t1});
+  const double elapsed = std::chrono::duration<double>(
+    ceph::mono_clock::now() - start).count();
+  ldpp_dout(this, 2) << __func__ << "(): bucket=" << bucket_name
+		     << " processed " << shards_done.load() << "/" << num_partitions
+		     << " shards, listed " << listed.load() << " objects in "
+		     << elapsed << "s ("
+		     << (elapsed > 0 ? listed / elapsed : 0) << " objects/s)"
+		     << dendl;
+
+  if (join) {
+    /* the owner of the session expires the multipart uploads */
+    return 0;
+  }
+  if (claims) {
+    int r = claims->clear();
+    if (r < 0) {
+      ldpp_dout(this, 0) << "WARNING: " << __func__ << "(): failed to clear "
+			 << "the shard claims of bucket " << bucket_name
+			 << ": " << cpp_strerror(r) << dendl;
     }
-    worker->workpool->drain();
+  }
+  if (error < 0) {
+    return error.load();
+  }
+  if (stopped) {
+    /* not all of the shards are done, the session isn't complete */
+    return -ETIMEDOUT;
   }
 
   ret = handle_multipart_expiration(bucket.get(), prefix_map, worker, stop_at, once);
   return ret;
 }
 
-class SimpleBackoff
-{
-  const int max_retries;
-  std::chrono::milliseconds sleep_ms;
-  int retries{0};
-public:
-  SimpleBackoff(int max_retries, std::chrono::milliseconds initial_sleep_ms)
-    : max_retries(max_retries), sleep_ms(initial_sleep_ms)
-    {}
-  SimpleBackoff(const SimpleBackoff&) = delete;
-  SimpleBackoff& operator=(const SimpleBackoff&) = delete;
-
-  int get_retries() const {
-    return retries;
-  }
-
-  void reset() {
-    retries = 0;
-  }
-
-  bool wait_backoff(const fu2::unique_function<bool(void) const>& barrier) {
-    reset();
-    while (retries < max_retries) {
-      auto r = barrier();
-      if (r) {
-	return r;
-      }
-      std::this_thread::sleep_for(sleep_ms * 2 * retries++);
-    }
-    return false;
-  }
-};
-
 int RGWLC::bucket_lc_post(int index, int max_lock_sec,
 			  rgw::sal::Lifecycle::LCEntry& entry, int& result,
 			  LCWorker* worker)
@@ -1936,6 +2226,8 @@ int RGWLC::process_bucket(int index, int max_lock_secs, LCWorker* worker,
 		     << dendl;
 
   entry->set_status(lc_processing);
+  /* starts a new session, see LCShardClaims */
+  entry->set_start_time(ceph_clock_now());
   ret = sal_lc->set_entry(obj_names[index], *entry);
   if (ret < 0) {
     ldpp_dout(this, 0) << "RGWLC::process_bucket() failed to set obj entry "
@@ -1949,7 +2241,8 @@ int RGWLC::process_bucket(int index, int max_lock_secs, LCWorker* worker,
 		     << dendl;
 
   lock.unlock();
-  ret = bucket_lc_process(entry->get_bucket(), worker, thread_stop_at(), once);
+  ret = bucket_lc_process(entry->get_bucket(), worker, thread_stop_at(), once,
+			  entry->get_start_time());
   bucket_lc_post(index, max_lock_secs, *entry, ret, worker);
 
   return ret;
@@ -2126,6 +2419,24 @@ int RGWLC::process(int index, int max_lock_secs, LCWorker* worker,
 	  if (advance_head(lc_shard, *head.get(), *entry.get(), now) < 0) {
 	    goto exit;
 	  }
+	  /* help with the index shards of the bucket that are not claimed
+	   * yet, and drop the lock meanwhile */
+	  lock->unlock();
+	  bucket_lc_process(entry->get_bucket(), worker, thread_stop_at(),
+			    once, entry->get_start_time(), true /* join */);
+	  if (! shard_lock.wait_backoff(lock_lambda)) {
+	    ldpp_dout(this, 0) << "RGWLC::process(): failed to aquire lock on "
+			       << lc_shard << " after " << shard_lock.get_retries()
+			       << dendl;
+	    return 0;
+	  }
+	  /* other workers advanced the head while the lock was dropped */
+	  ret = sal_lc->get_head(lc_shard, &head);
+	  if (ret < 0) {
+	    ldpp_dout(this, 0) << "RGWLC::process() failed to get obj head "
+			       << lc_shard << ", ret=" << ret << dendl;
+	    goto exit;
+	  }
 	  /* done with this shard */
 	  if (head->get_marker().empty()) {
 	    ldpp_dout(this, 5) <<
@@ -2209,7 +2520,8 @@ int RGWLC::process(int index, int max_lock_secs, LCWorker* worker,
     /* drop lock so other instances can make progress while this
      * bucket is being processed */
     lock->unlock();
-    ret = bucket_lc_process(entry->get_bucket(), worker, thread_stop_at(), once);
+    ret = bucket_lc_process(entry->get_bucket(), worker, thread_stop_at(), once,
+			    entry->get_start_time());
 
     /* postamble */
     //bucket_lc_post(index, max_lock_secs, entry, ret, worker);
@@ -29,6 +29,7 @@
 #define MAX_ID_LEN 255
 static std::string lc_oid_prefix = "lc";
 static std::string lc_index_lock_name = "lc_process";
+static std::string lc_shard_claim_lock_name = "lc_shard_claim";
 
 extern const char* LC_STATUS[];
 
@@ -513,6 +514,44 @@ public:
 };
 WRITE_CLASS_ENCODER(RGWLifecycleConfiguration)
 
+/* The index shards of a bucket that the LC workers taking part in one of
+ * its lifecycle sessions have claimed or finished. Each claim is an LC entry
+ * of the "<lc shard>.shards" object, keyed by
+ * "<bucket marker>:<session>:<index shard>", whose start time is the time
+ * the claim was taken and whose status is lc_processing until the shard is
+ * done and lc_complete after. Claims older than the ttl are abandoned and
+ * may be taken again. */
+class LCShardClaims {
+  const DoutPrefixProvider* dpp;
+  rgw::sal::Lifecycle* sal_lc;
+  const std::string oid;
+  const std::string bucket_prefix;
+  const std::string session_prefix;
+  const time_t ttl;
+  const std::string cookie;
+
+  std::string key(int shard) const;
+  bool expired(rgw::sal::Lifecycle::LCEntry& entry) const;
+  template <typename F>
+  int for_each(const std::string& prefix, F&& f);
+
+public:
+  LCShardClaims(const DoutPrefixProvider* dpp, rgw::sal::Lifecycle* sal_lc,
+		const std::string& lc_shard, const std::string& bucket_marker,
+		time_t session, time_t ttl, const std::string& cookie);
+
+  /* returns -EBUSY if the shard is claimed by another worker or done */
+  int claim(int shard);
+  int complete(int shard);
+  /* gives a claimed shard back, e.g. when the worker stops early */
+  int release(int shard);
+  /* the number of shards of the session that are done, and of those that
+   * are claimed but not done */
+  int count(int* done, int* claimed);
+  /* removes the claims of all the sessions of the bucket */
+  int clear();
+};
+
 class RGWLC : public DoutPrefixProvider {
   CephContext *cct;
   rgw::sal::Store* store;
@@ -591,7 +630,7 @@ public:
 		       std::vector<std::unique_ptr<rgw::sal::Lifecycle::LCEntry>>&,
 		       int& index);
   int bucket_lc_process(std::string& shard_id, LCWorker* worker, time_t stop_at,
-			bool once);
+			bool once, time_t session, bool join = false);
   int bucket_lc_post(int index, int max_lock_sec,
 		     rgw::sal::Lifecycle::LCEntry& entry, int& result, LCWorker* worker);
   bool going_down();
@@ -611,6 +650,10 @@ public:
 
   private:
 
+  int bucket_lc_process_shard(rgw::sal::Bucket* bucket, int shard,
+			      std::multimap<std::string, lc_op>& prefix_map,
+			      LCWorker* worker, time_t stop_at, bool once,
+			      std::atomic<uint64_t>& listed);
   int handle_multipart_expiration(rgw::sal::Bucket* target,
 				  const std::multimap<std::string, lc_op>& prefix_map,
 				  LCWorker* worker, time_t stop_at, bool once);
@@ -1,6 +1,7 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab ft=cpp
 
+#include "common/ceph_time.h"
 #include "common/errno.h"
 #include "common/Throttle.h"
 #include "common/WorkQueue.h"
@@ -37,6 +38,22 @@ void RGWLoadGenProcess::run()
   int num_buckets;
   conf->get_val("num_buckets", 1, &num_buckets);
 
+  int object_size;
+  conf->get_val("object_size", 4096, &object_size);
+
+  /* passes over the objects, to measure small gets */
+  int get_rounds;
+  conf->get_val("get_rounds", 1, &get_rounds);
+
+  ceph::mono_time start;
+  auto report = [&] (const char* method, int count) {
+    const double elapsed = std::chrono::duration<double>(
+      ceph::mono_clock::now() - start).count();
+    ldout(cct, 0) << "loadgen: " << count << " " << method << " requests in "
+        << elapsed << " sec: "
+        << (elapsed > 0 ? count / elapsed : 0) << " req/sec" << dendl;
+  };
+
   vector<string> buckets(num_buckets);
 
   std::atomic<bool> failed = { false };
@@ -65,28 +82,36 @@ void RGWLoadGenProcess::run()
     objs[i] = buckets[i % num_buckets] + "/" + buf;
   }
 
+  start = ceph::mono_clock::now();
   for (i = 0; i < num_objs; i++) {
-    gen_request("PUT", objs[i], 4096, &failed);
+    gen_request("PUT", objs[i], object_size, &failed);
   }
 
   checkpoint();
+  report("PUT", num_objs);
 
   if (failed) {
     derr << "ERROR: bucket creation failed" << dendl;
     goto done;
   }
 
-  for (i = 0; i < num_objs; i++) {
-    gen_request("GET", objs[i], 4096, NULL);
+  start = ceph::mono_clock::now();
+  for (int round = 0; round < get_rounds; round++) {
+    for (i = 0; i < num_objs; i++) {
+      gen_request("GET", objs[i], object_size, NULL);
+    }
   }
 
   checkpoint();
+  report("GET", num_objs * get_rounds);
 
+  start = ceph::mono_clock::now();
   for (i = 0; i < num_objs; i++) {
     gen_request("DELETE", objs[i], 0, NULL);
   }
 
   checkpoint();
+  report("DELETE", num_objs);
 
   for (i = 0; i < num_buckets; i++) {
     gen_request("DELETE", buckets[i], 0, NULL);
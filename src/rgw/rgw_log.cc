@@ -515,10 +515,45 @@ int OpsLogSocket::log_json(req_state* s, bufferlist& bl)
   return 0;
 }
 
-OpsLogRados::OpsLogRados(rgw::sal::Store* const& store): store(store)
+OpsLogRados::OpsLogRados(rgw::sal::Store* const& store)
+  : OpsLogRados(store->ctx(),
+                [&store] (const DoutPrefixProvider *dpp, const string& oid,
+                          bufferlist& bl) {
+                  string o = oid;
+                  return store->log_op(dpp, o, bl);
+                })
 {
 }
 
+OpsLogRados::OpsLogRados(CephContext* cct, Writer writer)
+  : cct(cct), writer(std::move(writer))
+{
+}
+
+OpsLogRados::~OpsLogRados()
+{
+  // the store is still open while the ops log sinks are destroyed
+  if (!batches.empty()) {
+    const DoutPrefix dp(cct, dout_subsys, "rgw OpsLogRados: ");
+    flush(&dp, batches);
+  }
+}
+
+int OpsLogRados::flush(const DoutPrefixProvider *dpp, std::map<std::string, bufferlist>& out)
+{
+  int ret = 0;
+  for (auto& [oid, bl] : out) {
+    int r = writer(dpp, oid, bl);
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: failed to log RADOS RGW ops log batch of "
+          << bl.length() << " bytes to " << oid << dendl;
+      ret = r;
+    }
+  }
+  out.clear();
+  return ret;
+}
+
 int OpsLogRados::log(req_state* s, struct rgw_log_entry& entry)
 {
   if (!s->cct->_conf->rgw_ops_log_rados) {
@@ -535,7 +570,34 @@ int OpsLogRados::log(req_state* s, struct rgw_log_entry& entry)
     localtime_r(&t, &bdt);
   string oid = render_log_object_name(s->cct->_conf->rgw_log_object_name, &bdt,
                                       entry.bucket_id, entry.bucket);
-  if (store->log_op(s, oid, bl) < 0) {
+
+  const uint64_t batch_size = s->cct->_conf->rgw_ops_log_rados_batch_size;
+  if (batch_size > 0) {
+    // the encoded entries are self-delimiting, so a batch reads back the
+    // same way as the entries appended one at a time
+    std::map<std::string, bufferlist> ready;
+    {
+      std::lock_guard l{lock};
+      const auto now = ceph::coarse_mono_clock::now();
+      if (batches.empty()) {
+        batch_start = now;
+      }
+      batch_bytes += bl.length();
+      batches[oid].claim_append(bl);
+      const auto interval = std::chrono::milliseconds(
+          s->cct->_conf->rgw_ops_log_rados_batch_interval_ms);
+      if (batch_bytes >= batch_size || now - batch_start >= interval) {
+        ready.swap(batches);
+        batch_bytes = 0;
+      }
+    }
+    if (!ready.empty() && flush(s, ready) < 0) {
+      return -1;
+    }
+    return 0;
+  }
+
+  if (writer(s, oid, bl) < 0) {
     ldpp_dout(s, 0) << "ERROR: failed to log RADOS RGW ops log entry for txn: " << s->trans_id << dendl;
     return -1;
   }
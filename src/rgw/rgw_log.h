@@ -9,6 +9,7 @@
 #include "common/OutputDataSocket.h"
 #include <vector>
 #include <fstream>
+#include <functional>
 #include "rgw_sal_fwd.h"
 
 class RGWOp;
@@ -267,11 +268,29 @@ public:
 };
 
 class OpsLogRados : public OpsLogSink {
-  // main()'s Store pointer as a reference, possibly modified by RGWRealmReloader
-  rgw::sal::Store* const& store;
+public:
+  // appends encoded entries to a log object
+  using Writer = std::function<int(const DoutPrefixProvider *dpp,
+                                   const std::string& oid, bufferlist& bl)>;
+private:
+  CephContext* const cct;
+  Writer writer;
 
+  // with rgw_ops_log_rados_batch_size, the encoded entries are buffered per
+  // log object and written with a single append. the batches are flushed
+  // by the request that fills them up or finds them too old, so that the
+  // store is never used outside of a request (or after a realm reload)
+  ceph::mutex lock = ceph::make_mutex("OpsLogRados");
+  std::map<std::string, bufferlist> batches;
+  uint64_t batch_bytes = 0;
+  ceph::coarse_mono_time batch_start;
+
+  int flush(const DoutPrefixProvider *dpp, std::map<std::string, bufferlist>& out);
 public:
+  // main()'s Store pointer as a reference, possibly modified by RGWRealmReloader
   OpsLogRados(rgw::sal::Store* const& store);
+  OpsLogRados(CephContext* cct, Writer writer);
+  ~OpsLogRados() override;
   int log(req_state* s, struct rgw_log_entry& entry) override;
 };
 
@@ -3890,9 +3890,8 @@ void RGWPutObj::execute(optional_yield y)
   char supplied_md5[CEPH_CRYPTO_MD5_DIGESTSIZE * 2 + 1];
   char calc_md5[CEPH_CRYPTO_MD5_DIGESTSIZE * 2 + 1];
   unsigned char m[CEPH_CRYPTO_MD5_DIGESTSIZE];
-  MD5 hash;
-  // Allow use of MD5 digest in FIPS mode for non-cryptographic purposes
-  hash.SetFlags(EVP_MD_CTX_FLAG_NON_FIPS_ALLOW);
+  rgw::hash::MD5 hash{s->cct, y};
+  std::optional<rgw::hash::Checksum> cksum;
   bufferlist bl, aclbl, bs;
   int len;
   
@@ -3923,6 +3922,10 @@ void RGWPutObj::execute(optional_yield y)
     return;
   }
 
+  if (checksum_type) {
+    cksum.emplace(s->cct, *checksum_type, y);
+  }
+
   if (supplied_md5_b64) {
     need_calc_md5 = true;
 
@@ -4095,7 +4098,8 @@ void RGWPutObj::execute(optional_yield y)
         ldpp_dout(this, 1) << "Cannot load plugin for compression type "
             << compression_type << dendl;
       } else {
-        compressor.emplace(s->cct, plugin, filter);
+        compressor.emplace(s->cct, plugin, filter,
+                           rgw::putobj::TransformPool::get(s->cct), y);
         filter = &*compressor;
         // always send incompressible hint when rgw is itself doing compression
         s->object->set_compressed();
@@ -4137,6 +4141,9 @@ void RGWPutObj::execute(optional_yield y)
     if (need_calc_md5) {
       hash.Update((const unsigned char *)data.c_str(), data.length());
     }
+    if (cksum) {
+      cksum->update((const unsigned char *)data.c_str(), data.length());
+    }
 
     /* update torrrent */
     torrent.update(data);
@@ -4204,6 +4211,23 @@ void RGWPutObj::execute(optional_yield y)
     return;
   }
 
+  if (cksum) {
+    checksum = cksum->final();
+    if (supplied_checksum && checksum != supplied_checksum) {
+      ldpp_dout(this, 5) << "x-amz-checksum-"
+          << rgw::hash::Checksum::name(cksum->get_type())
+          << " mismatch: supplied=" << supplied_checksum
+          << " calculated=" << checksum << dendl;
+      op_ret = -ERR_BAD_DIGEST;
+      return;
+    }
+    bufferlist cksum_bl;
+    cksum_bl.append(checksum);
+    emplace_attr(RGW_ATTR_CHECKSUM_PREFIX +
+                 std::string{rgw::hash::Checksum::name(cksum->get_type())},
+                 std::move(cksum_bl));
+  }
+
   policy.encode(aclbl);
   emplace_attr(RGW_ATTR_ACL, std::move(aclbl));
 
@@ -4386,9 +4410,7 @@ void RGWPostObj::execute(optional_yield y)
   do {
     char calc_md5[CEPH_CRYPTO_MD5_DIGESTSIZE * 2 + 1];
     unsigned char m[CEPH_CRYPTO_MD5_DIGESTSIZE];
-    MD5 hash;
-    // Allow use of MD5 digest in FIPS mode for non-cryptographic purposes
-    hash.SetFlags(EVP_MD_CTX_FLAG_NON_FIPS_ALLOW);
+    rgw::hash::MD5 hash{s->cct, y};
     ceph::buffer::list bl, aclbl;
     int len = 0;
 
@@ -4445,7 +4467,8 @@ void RGWPostObj::execute(optional_yield y)
           ldpp_dout(this, 1) << "Cannot load plugin for compression type "
                            << compression_type << dendl;
         } else {
-          compressor.emplace(s->cct, plugin, filter);
+          compressor.emplace(s->cct, plugin, filter,
+                             rgw::putobj::TransformPool::get(s->cct), y);
           filter = &*compressor;
         }
       }
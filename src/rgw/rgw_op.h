@@ -44,6 +44,7 @@
 #include "rgw_putobj.h"
 #include "rgw_sal.h"
 #include "rgw_compression_types.h"
+#include "rgw_hash.h"
 #include "rgw_log.h"
 
 #include "rgw_lc.h"
@@ -1215,6 +1216,11 @@ protected:
   std::map<std::string, std::string> crypt_http_responses;
   std::string user_data;
 
+  // S3 additional checksum (x-amz-checksum-*)
+  std::optional<rgw::hash::Checksum::Type> checksum_type;
+  const char *supplied_checksum = nullptr;
+  std::string checksum;
+
   std::string multipart_upload_id;
   std::string multipart_part_str;
   int multipart_part_num = 0;
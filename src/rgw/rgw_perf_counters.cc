@@ -35,6 +35,8 @@ int rgw_perf_start(CephContext *cct)
   plb.add_u64_counter(l_rgw_keystone_token_cache_miss, "keystone_token_cache_miss", "Keystone token cache miss");
 
   plb.add_u64_counter(l_rgw_gc_retire, "gc_retire_object", "GC object retires");
+  plb.add_u64_counter(l_rgw_gc_tail_remove, "gc_tail_remove", "GC tail object removals");
+  plb.add_u64(l_rgw_gc_io_window, "gc_io_window", "GC concurrent IO limit");
 
   plb.add_u64_counter(l_rgw_lc_expire_current, "lc_expire_current",
 		      "Lifecycle current expiration");
@@ -63,6 +65,15 @@ int rgw_perf_start(CephContext *cct)
   plb.add_u64_counter(l_rgw_lua_script_ok, "lua_script_ok", "Successfull executions of lua scripts");
   plb.add_u64_counter(l_rgw_lua_script_fail, "lua_script_fail", "Failed executions of lua scripts");
   plb.add_u64(l_rgw_lua_current_vms, "lua_current_vms", "Number of Lua VMs currently being executed");
+
+  plb.add_u64_counter(l_rgw_s3select_scanned_b, "s3select_scanned_b", "Bytes of objects read by s3select");
+  plb.add_u64_counter(l_rgw_s3select_skipped_b, "s3select_skipped_b", "Bytes of objects skipped by s3select");
+
+  plb.add_u64_counter(l_rgw_quota_sync_fetch, "quota_sync_fetch", "Quota stats read from storage on the request path");
+  plb.add_u64_counter(l_rgw_quota_stale_stats, "quota_stale_stats", "Quota checks served from expired stats during a refresh");
+
+  plb.add_u64_counter(l_rgw_get_obj_coalesce_reads, "get_obj_coalesce_reads", "Tail object reads sent by the GET read coalescer");
+  plb.add_u64_counter(l_rgw_get_obj_coalesced, "get_obj_coalesced", "Tail object reads served by a concurrent read of the same range");
   
   perfcounter = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(perfcounter);
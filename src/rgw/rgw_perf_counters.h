@@ -32,6 +32,8 @@ enum {
   l_rgw_keystone_token_cache_miss,
 
   l_rgw_gc_retire,
+  l_rgw_gc_tail_remove,
+  l_rgw_gc_io_window,
 
   l_rgw_lc_expire_current,
   l_rgw_lc_expire_noncurrent,
@@ -54,6 +56,15 @@ enum {
   l_rgw_lua_script_ok,
   l_rgw_lua_script_fail,
 
+  l_rgw_s3select_scanned_b,
+  l_rgw_s3select_skipped_b,
+
+  l_rgw_quota_sync_fetch,
+  l_rgw_quota_stale_stats,
+
+  l_rgw_get_obj_coalesce_reads,
+  l_rgw_get_obj_coalesced,
+
   l_rgw_last,
 };
 
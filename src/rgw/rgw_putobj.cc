@@ -13,6 +13,9 @@
  *
  */
 
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
 #include "rgw_putobj.h"
 
 namespace rgw::putobj {
@@ -96,4 +99,168 @@ int StripeProcessor::process(bufferlist&& data, uint64_t offset)
   return Pipe::process(std::move(data), offset - bounds.first);
 }
 
+TransformPool::TransformPool(CephContext *cct)
+  : threads(cct->_conf.get_val<uint64_t>("rgw_put_obj_transform_threads")),
+    window(cct->_conf.get_val<Option::size_t>("rgw_put_obj_transform_window"))
+{
+  pool = std::make_unique<boost::asio::thread_pool>(threads);
+}
+
+TransformPool::~TransformPool()
+{
+  pool->join();
+}
+
+bool TransformPool::try_get()
+{
+  uint64_t n = busy.load();
+  do {
+    if (n >= threads) {
+      return false;
+    }
+  } while (!busy.compare_exchange_weak(n, n + 1));
+  return true;
+}
+
+void TransformPool::put()
+{
+  --busy;
+}
+
+TransformPool* TransformPool::get(CephContext *cct)
+{
+  if (cct->_conf.get_val<uint64_t>("rgw_put_obj_transform_threads") == 0) {
+    return nullptr;
+  }
+  return &cct->lookup_or_create_singleton_object<TransformPool>(
+      "rgw::putobj::TransformPool", false, cct);
+}
+
+ParallelPipe::~ParallelPipe()
+{
+  // the pool threads reference this pipe until they're done
+  wait_idle();
+}
+
+template <typename CompletionToken>
+auto ParallelPipe::async_wait(std::unique_lock<ceph::mutex>& lock,
+                              CompletionToken&& token)
+{
+  using boost::asio::async_completion;
+  using Signature = void(boost::system::error_code);
+  async_completion<CompletionToken, Signature> init(token);
+  completion = Completion::create(y.get_io_context().get_executor(),
+                                  std::move(init.completion_handler));
+  lock.unlock();
+  return init.result.get();
+}
+
+void ParallelPipe::wait(Chunk& chunk)
+{
+  std::unique_lock lock{mutex};
+  if (chunk.done) {
+    return;
+  }
+  ceph_assert(waiter == nullptr);
+  waiter = &chunk;
+  if (y) {
+    boost::system::error_code ec;
+    async_wait(lock, y.get_yield_context()[ec]);
+  } else {
+    cond.wait(lock, [&chunk] { return chunk.done; });
+  }
+}
+
+void ParallelPipe::wait_idle()
+{
+  std::unique_lock lock{mutex};
+  cond.wait(lock, [this] { return in_flight == 0; });
+}
+
+void ParallelPipe::finish(const std::shared_ptr<Chunk>& chunk)
+{
+  std::unique_lock lock{mutex};
+  chunk->done = true;
+  --in_flight;
+  if (waiter == chunk.get()) {
+    waiter = nullptr;
+    if (completion) {
+      ceph::async::post(std::move(completion), boost::system::error_code{});
+    }
+  }
+  cond.notify_all();
+}
+
+int ParallelPipe::drain(uint64_t max_pending)
+{
+  while (!chunks.empty()) {
+    auto chunk = chunks.front();
+    {
+      std::unique_lock lock{mutex};
+      if (!chunk->done && pending_size <= max_pending) {
+        break;
+      }
+    }
+    wait(*chunk);
+    chunks.pop_front();
+    pending_size -= chunk->length;
+
+    int r = complete(std::move(chunk->in), std::move(chunk->out),
+                     chunk->result, chunk->offset);
+    if (r < 0) {
+      // don't pass on anything else
+      wait_idle();
+      chunks.clear();
+      pending_size = 0;
+      return r;
+    }
+  }
+  return 0;
+}
+
+int ParallelPipe::process(bufferlist&& data, uint64_t offset)
+{
+  if (data.length() == 0) { // flush
+    int r = drain(0);
+    if (r < 0) {
+      return r;
+    }
+    return complete({}, {}, 0, offset);
+  }
+
+  if (!pool) {
+    bufferlist out;
+    int r = transform(data, offset, &out);
+    return complete(std::move(data), std::move(out), r, offset);
+  }
+
+  auto chunk = std::make_shared<Chunk>();
+  chunk->length = data.length();
+  chunk->offset = offset;
+  chunk->in = std::move(data);
+  chunks.push_back(chunk);
+  pending_size += chunk->length;
+
+  if (!pool->try_get()) {
+    // queueing behind other requests' chunks would only add latency, so
+    // use this thread instead. the result still waits for its turn
+    chunk->result = transform(chunk->in, chunk->offset, &chunk->out);
+    std::lock_guard lock{mutex};
+    chunk->done = true;
+  } else {
+    {
+      std::lock_guard lock{mutex};
+      ++in_flight;
+    }
+    boost::asio::post(pool->get_pool(), [this, chunk] {
+        chunk->result = transform(chunk->in, chunk->offset, &chunk->out);
+        pool->put();
+        finish(chunk);
+      });
+  }
+
+  // pass on whatever is ready, and wait while the window is full
+  return drain(pool->get_window());
+}
+
 } // namespace rgw::putobj
@@ -15,9 +15,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include "include/buffer.h"
+#include "common/async/completion.h"
+#include "common/async/yield_context.h"
+#include "common/ceph_mutex.h"
 #include "rgw_sal.h"
 
+namespace boost::asio { class thread_pool; }
+
 namespace rgw::putobj {
 
 // for composing data processors into a pipeline
@@ -70,4 +78,87 @@ class StripeProcessor : public Pipe {
   int process(bufferlist&& data, uint64_t data_offset) override;
 };
 
+
+// thread pool shared by the ParallelPipes of all requests
+class TransformPool {
+  std::unique_ptr<boost::asio::thread_pool> pool;
+  uint64_t threads;
+  uint64_t window;
+  std::atomic<uint64_t> busy{0};
+ public:
+  explicit TransformPool(CephContext *cct);
+  ~TransformPool();
+
+  boost::asio::thread_pool& get_pool() { return *pool; }
+  uint64_t get_window() const { return window; }
+
+  // reserves a thread for a transform. returns false if all of them are
+  // already busy, in which case the caller transforms the data itself
+  bool try_get();
+  void put();
+
+  // returns nullptr if rgw_put_obj_transform_threads is 0
+  static TransformPool* get(CephContext *cct);
+};
+
+// pipe that applies a transform() to the data on a thread pool. up to a
+// window of bytes is transformed concurrently, and the results are passed
+// to complete() in their original order on the calling thread. without a
+// pool, or while all of its threads are busy, the data is transformed
+// inline
+class ParallelPipe : public Pipe {
+  struct Chunk {
+    bufferlist in;
+    bufferlist out;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    int result = 0;
+    bool done = false;
+  };
+
+  TransformPool *pool;
+  optional_yield y;
+  uint64_t pending_size = 0;
+  std::deque<std::shared_ptr<Chunk>> chunks; // submitted, in order
+
+  ceph::mutex mutex = ceph::make_mutex("ParallelPipe");
+  ceph::condition_variable cond;
+  uint64_t in_flight = 0;
+  Chunk *waiter = nullptr;
+  using Completion = ceph::async::Completion<void(boost::system::error_code)>;
+  std::unique_ptr<Completion> completion;
+
+  template <typename CompletionToken>
+  auto async_wait(std::unique_lock<ceph::mutex>& lock, CompletionToken&& token);
+  void wait(Chunk& chunk);
+  void finish(const std::shared_ptr<Chunk>& chunk);
+  // complete the chunks in order, waiting until at most max_pending bytes
+  // remain in flight
+  int drain(uint64_t max_pending);
+
+ protected:
+  // wait for outstanding transforms. derived classes must call this from
+  // their destructor because transform() may still be using their members
+  void wait_idle();
+  // may be called concurrently on several threads
+  virtual int transform(bufferlist& in, uint64_t offset, bufferlist *out) = 0;
+  // called in order with the input and the result of transform()
+  virtual int complete(bufferlist&& in, bufferlist&& out, int result,
+                       uint64_t offset) {
+    if (result < 0) {
+      return result;
+    }
+    return Pipe::process(std::move(out), offset);
+  }
+
+ public:
+  ParallelPipe(rgw::sal::DataProcessor *next, TransformPool *pool = nullptr,
+               optional_yield y = null_yield)
+    : Pipe(next), pool(pool), y(y)
+  {}
+  virtual ~ParallelPipe() override;
+
+  int process(bufferlist&& data, uint64_t offset) override;
+};
+
 } // namespace rgw::putobj
@@ -3211,6 +3211,7 @@ int RGWRados::Object::Write::_do_write_meta(const DoutPrefixProvider *dpp,
   int64_t poolid;
   bool orig_exists;
   uint64_t orig_size;
+  int prepare_r;
   
   if (!reset_obj) {    //Multipart upload, it has immutable head. 
     orig_exists = false;
@@ -3231,7 +3232,11 @@ int RGWRados::Object::Write::_do_write_meta(const DoutPrefixProvider *dpp,
 
   if (!index_op->is_prepared()) {
     tracepoint(rgw_rados, prepare_enter, req_id.c_str());
-    r = index_op->prepare(dpp, CLS_RGW_OP_ADD, &state->write_tag, y);
+    if (!versioned_op && store->overlap_index_prepare(target->get_meta_placement_rule())) {
+      r = index_op->start_prepare(dpp, CLS_RGW_OP_ADD, &state->write_tag, y);
+    } else {
+      r = index_op->prepare(dpp, CLS_RGW_OP_ADD, &state->write_tag, y);
+    }
     tracepoint(rgw_rados, prepare_exit, req_id.c_str());
     if (r < 0)
       return r;
@@ -3242,6 +3247,29 @@ int RGWRados::Object::Write::_do_write_meta(const DoutPrefixProvider *dpp,
   tracepoint(rgw_rados, operate_enter, req_id.c_str());
   r = rgw_rados_operate(dpp, ref.pool.ioctx(), ref.obj.oid, &op, null_yield);
   tracepoint(rgw_rados, operate_exit, req_id.c_str());
+  prepare_r = index_op->wait_prepare(dpp, y);
+  if (prepare_r < 0 && r >= 0) {
+    /* the head was written, but it has no pending entry in the index. retry
+     * the prepare the usual way, so that the entry can still be completed */
+    ldpp_dout(dpp, 1) << "WARNING: bucket index prepare for obj=" << obj
+        << " failed after the head write: ret=" << prepare_r << ", retrying" << dendl;
+    prepare_r = index_op->prepare(dpp, CLS_RGW_OP_ADD, &state->write_tag, y);
+    if (prepare_r == 0) {
+      prepare_r = -store->ctx()->_conf.get_val<int64_t>("rgw_inject_index_prepare_retry_err");
+    }
+    if (prepare_r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: bucket index prepare for obj=" << obj
+          << " failed after the head write: ret=" << prepare_r << dendl;
+      /* the head replaced the previous version, but the index still
+       * describes that version. handle it like a head write that timed out:
+       * keep the head and its tail, and leave the tail of the object it
+       * replaced orphaned instead of gc'ing it for a write that failed. the
+       * index entry is fixed by the next write of the object */
+      target->invalidate_state();
+      r = -ETIMEDOUT;
+      goto done_cancel;
+    }
+  }
   if (r < 0) { /* we can expect to get -ECANCELED if object was replaced under,
                 or -ENOENT if was removed, or -EEXIST if it did not exist
                 before and now it does */
@@ -5082,6 +5110,28 @@ int RGWRados::bucket_set_reshard(const DoutPrefixProvider *dpp, const RGWBucketI
   return CLSRGWIssueSetBucketResharding(index_pool.ioctx(), bucket_objs, entry, cct->_conf->rgw_bucket_index_max_aio)();
 }
 
+int RGWRados::reshard_log_list(BucketShard& bs, const string& marker, uint32_t max,
+                               list<string> *names, bool *is_truncated)
+{
+  auto& ref = bs.bucket_obj.get_ref();
+  return cls_rgw_reshard_log_list(ref.pool.ioctx(), ref.obj.oid, marker, max,
+                                  names, is_truncated);
+}
+
+int RGWRados::reshard_log_trim(const DoutPrefixProvider *dpp, const RGWBucketInfo& bucket_info,
+                               const rgw::bucket_index_layout_generation& index)
+{
+  RGWSI_RADOS::Pool index_pool;
+  map<int, string> bucket_objs;
+
+  int r = svc.bi_rados->open_bucket_index(dpp, bucket_info, std::nullopt, index, &index_pool, &bucket_objs, nullptr);
+  if (r < 0) {
+    return r;
+  }
+
+  return CLSRGWIssueReshardLogTrim(index_pool.ioctx(), bucket_objs, cct->_conf->rgw_bucket_index_max_aio)();
+}
+
 int RGWRados::defer_gc(const DoutPrefixProvider *dpp, RGWObjectCtx* rctx, RGWBucketInfo& bucket_info, rgw::sal::Object* obj, optional_yield y)
 {
   std::string oid, key;
@@ -6281,6 +6331,71 @@ int RGWRados::Bucket::UpdateIndex::prepare(const DoutPrefixProvider *dpp, RGWMod
   return 0;
 }
 
+RGWRados::Bucket::UpdateIndex::~UpdateIndex()
+{
+  if (prepare_aio) {
+    prepare_aio->drain();
+  }
+}
+
+int RGWRados::Bucket::UpdateIndex::start_prepare(const DoutPrefixProvider *dpp, RGWModifyOp op,
+                                                 const string *write_tag, optional_yield y)
+{
+  if (blind) {
+    return 0;
+  }
+  RGWRados *store = target->get_store();
+
+  if (write_tag && write_tag->length()) {
+    optag = string(write_tag->c_str(), write_tag->length());
+  } else {
+    if (optag.empty()) {
+      append_rand_alpha(store->ctx(), optag, optag, 32);
+    }
+  }
+
+  BucketShard *bs = nullptr;
+  int r = get_bucket_shard(&bs, dpp);
+  if (r < 0) {
+    ldpp_dout(dpp, 5) << "failed to get BucketShard object: ret=" << r << dendl;
+    return r;
+  }
+
+  prepare_op = op;
+  prepare_aio = rgw::make_throttle(1, y);
+  /* an error is returned by wait_prepare(), which may retry the op */
+  prepare_ret = store->cls_obj_prepare_op_async(dpp, *bs, op, optag, obj, bilog_flags,
+                                                prepare_aio.get(), y, zones_trace);
+  return 0;
+}
+
+int RGWRados::Bucket::UpdateIndex::wait_prepare(const DoutPrefixProvider *dpp, optional_yield y)
+{
+  if (!prepare_aio) {
+    return 0;
+  }
+  /* yields the coroutine of the request, if any */
+  auto completed = prepare_aio->drain();
+  prepare_aio.reset();
+  int r = prepare_ret;
+  if (r == 0) {
+    r = rgw::check_for_errors(completed);
+  }
+  if (r == 0) {
+    r = -target->get_store()->ctx()->_conf.get_val<int64_t>("rgw_inject_index_prepare_err");
+  }
+
+  if (r == -ERR_BUSY_RESHARDING) {
+    /* retry it the usual way, which waits for the reshard to finish */
+    return prepare(dpp, prepare_op, nullptr, y);
+  }
+  if (r < 0) {
+    return r;
+  }
+  prepared = true;
+  return 0;
+}
+
 int RGWRados::Bucket::UpdateIndex::complete(const DoutPrefixProvider *dpp, int64_t poolid, uint64_t epoch,
                                             uint64_t size, uint64_t accounted_size,
                                             ceph::real_time& ut, const string& etag,
@@ -6532,7 +6647,7 @@ int get_obj_data::flush(rgw::AioResultList&& results) {
       auto oid = completed.front().obj.get_ref().obj.oid;
       if (bl.length() <= g_conf()->rgw_get_obj_max_req_size && !d3n_bypass_cache_write) {
         lsubdout(g_ceph_context, rgw_datacache, 10) << "D3nDataCache: " << __func__ << "(): bl.length <= rgw_get_obj_max_req_size (default 4MB) - write to datacache, bl.length=" << bl.length() << dendl;
-        rgwrados->d3n_data_cache->put(bl, bl.length(), oid);
+        rgwrados->d3n_data_cache->put(bl, bl.length(), oid, d3n_obj_size);
       } else {
         lsubdout(g_ceph_context, rgw_datacache, 10) << "D3nDataCache: " << __func__ << "(): not writing to datacache - bl.length > rgw_get_obj_max_req_size (default 4MB), bl.length=" << bl.length() << " or d3n_bypass_cache_write=" << d3n_bypass_cache_write << dendl;
       }
@@ -6592,11 +6707,18 @@ int RGWRados::get_obj_iterate_cb(const DoutPrefixProvider *dpp,
   }
 
   ldpp_dout(dpp, 20) << "rados->get_obj_iterate_cb oid=" << read_obj.oid << " obj-ofs=" << obj_ofs << " read_ofs=" << read_ofs << " len=" << len << dendl;
-  op.read(read_ofs, len, nullptr, nullptr);
 
   const uint64_t cost = len;
   const uint64_t id = obj_ofs; // use logical object offset for sorting replies
 
+  if (!is_head_obj && cct->_conf->rgw_get_obj_coalesce_reads) {
+    /* tail objects are never modified once written, so concurrent reads of
+     * the same range return the same data */
+    auto completed = d->aio->get(obj, read_coalescer.read_op(read_obj, read_ofs, len, d->yield), cost, id);
+    return d->flush(std::move(completed));
+  }
+
+  op.read(read_ofs, len, nullptr, nullptr);
   auto completed = d->aio->get(obj, rgw::Aio::librados_op(std::move(op), d->yield), cost, id);
 
   return d->flush(std::move(completed));
@@ -8440,6 +8562,36 @@ int RGWRados::cls_obj_prepare_op(const DoutPrefixProvider *dpp, BucketShard& bs,
   return ret;
 }
 
+int RGWRados::cls_obj_prepare_op_async(const DoutPrefixProvider *dpp, BucketShard& bs, RGWModifyOp op, string& tag,
+                                       rgw_obj& obj, uint16_t bilog_flags, rgw::Aio *aio, optional_yield y,
+                                       rgw_zone_set *_zones_trace)
+{
+  const bool bitx = cct->_conf->rgw_bucket_index_transaction_instrumentation;
+  ldout_bitx(bitx, dpp, 10) << "ENTERING " << __func__ << ": bucket-shard=" << bs << " obj=" << obj << " tag=" << tag << " op=" << op << dendl_bitx;
+
+  rgw_zone_set zones_trace;
+  if (_zones_trace) {
+    zones_trace = *_zones_trace;
+  }
+  zones_trace.insert(svc.zone->get_zone().id, bs.bucket.get_key());
+
+  ObjectWriteOperation o;
+  cls_rgw_obj_key key(obj.key.get_index_key_name(), obj.key.instance);
+  cls_rgw_guard_bucket_resharding(o, -ERR_BUSY_RESHARDING);
+  cls_rgw_bucket_prepare_op(o, op, tag, key, obj.key.get_loc(), svc.zone->get_zone().log_data, bilog_flags, zones_trace);
+  auto completed = aio->get(bs.bucket_obj, rgw::Aio::librados_op(std::move(o), y), 1, 0);
+  int ret = rgw::check_for_errors(completed);
+  ldout_bitx(bitx, dpp, 10) << "EXITING " << __func__ << ": ret=" << ret << dendl_bitx;
+  return ret;
+}
+
+bool RGWRados::overlap_index_prepare(const rgw_placement_rule& placement_rule)
+{
+  const auto& placement_pools = svc.zone->get_zone_params().placement_pools;
+  auto iter = placement_pools.find(placement_rule.name);
+  return iter != placement_pools.end() && iter->second.overlap_index_prepare;
+}
+
 int RGWRados::cls_obj_complete_op(BucketShard& bs, const rgw_obj& obj, RGWModifyOp op, string& tag,
                                   int64_t pool, uint64_t epoch,
                                   rgw_bucket_dir_entry& ent, RGWObjCategory category,
@@ -8652,18 +8804,37 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     const std::string& oid_name;
     RGWRados::ent_map_t::iterator cursor;
     RGWRados::ent_map_t::iterator end;
+    uint32_t page_size;
+    // where to continue listing this shard from once it's exhausted
+    cls_rgw_obj_key next_marker;
 
     // manages an iterator through a shard and provides other
     // accessors
     ShardTracker(size_t _shard_idx,
 		 rgw_cls_list_ret& _result,
-		 const std::string& _oid_name):
+		 const std::string& _oid_name,
+		 uint32_t _page_size):
       shard_idx(_shard_idx),
       result(_result),
       oid_name(_oid_name),
-      cursor(_result.dir.m.begin()),
-      end(_result.dir.m.end())
-    {}
+      page_size(_page_size)
+    {
+      reset();
+    }
+
+    // (re)start iterating over the current contents of result
+    void reset() {
+      cursor = result.dir.m.begin();
+      end = result.dir.m.end();
+      if (!result.marker.empty()) {
+	next_marker = result.marker;
+      } else if (!result.dir.m.empty()) {
+	// older OSDs do not return a marker
+	next_marker = result.dir.m.rbegin()->second.key;
+      } else {
+	next_marker = cls_rgw_obj_key();
+      }
+    }
 
     inline const std::string& entry_name() const {
       return cursor->first;
@@ -8699,7 +8870,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
   std::vector<ShardTracker> results_trackers;
   results_trackers.reserve(shard_list_results.size());
   for (auto& r : shard_list_results) {
-    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first]);
+    results_trackers.emplace_back(r.first, r.second, shard_oids[r.first],
+				  num_entries_per_shard);
 
     // if any *one* shard's result is trucated, the entire result is
     // truncated
@@ -8726,10 +8898,42 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     ++tracker_idx;
   }
 
-  rgw_bucket_dir_entry*
-    last_entry_visited = nullptr; // to set last_entry (marker)
-  std::map<std::string, bufferlist> updates;
+  // once a truncated shard runs out of entries, fetch its next page
+  // (growing the page size each time) instead of returning early, so
+  // that a listing does not have to re-query every shard for every page
+  // it returns
   uint32_t count = 0;
+  auto refill_tracker = [&](ShardTracker& t) -> int {
+    if (t.next_marker.empty()) {
+      return 0;
+    }
+    t.page_size = std::min(
+      num_entries,
+      std::max(t.page_size * 2,
+	       calc_ordered_bucket_list_per_shard(num_entries - count,
+						  shard_count)));
+    ldpp_dout(dpp, 20) << __func__ << ": refilling shard " << t.shard_idx <<
+      " after \"" << t.next_marker << "\" with " << t.page_size <<
+      " entries" << dendl;
+
+    std::map<int, std::string> oids{{int(t.shard_idx), t.oid_name}};
+    std::map<int, rgw_cls_list_ret> results;
+    int ret = CLSRGWIssueBucketList(ioctx, t.next_marker, prefix, delimiter,
+				    t.page_size, list_versions, oids, results,
+				    1)();
+    if (ret < 0) {
+      return ret;
+    }
+    t.result = std::move(results[t.shard_idx]);
+    t.reset();
+    *cls_filtered = *cls_filtered && t.result.cls_filtered;
+    return 0;
+  };
+
+  // the entry used to set last_entry (marker); a copy since trackers
+  // may be refilled
+  std::optional<rgw_obj_index_key> last_entry_visited;
+  std::map<std::string, bufferlist> updates;
   while (count < num_entries && !candidates.empty()) {
     r = 0;
     // select the next entry in lexical order (first key in map);
@@ -8738,7 +8942,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     tracker_idx = candidates.begin()->second;
     auto& tracker = results_trackers.at(tracker_idx);
 
-    const std::string& name = tracker.entry_name();
+    const std::string name = tracker.entry_name();
     rgw_bucket_dir_entry& dirent = tracker.dir_entry();
 
     ldpp_dout(dpp, 20) << __func__ << ": currently processing " <<
@@ -8778,7 +8982,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
 	dirent.key << dendl;
 
       auto [it, inserted] = m.insert_or_assign(name, std::move(dirent));
-      last_entry_visited = &it->second;
+      last_entry_visited = it->second.key;
       if (inserted) {
 	++count;
       } else {
@@ -8789,7 +8993,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     } else {
       ldpp_dout(dpp, 10) << __func__ << ": skipping " <<
 	dirent.key.name << "[" << dirent.key.instance << "]" << dendl;
-      last_entry_visited = &tracker.dir_entry();
+      last_entry_visited = dirent.key;
     }
 
     // refresh the candidates map
@@ -8803,6 +9007,16 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     for (auto idx : vidx) {
       auto& tracker_match = results_trackers.at(idx);
       tracker_match.advance();
+      if (tracker_match.at_end() && tracker_match.is_truncated() &&
+	  count < num_entries) {
+	r = refill_tracker(tracker_match);
+	if (r < 0) {
+	  ldpp_dout(dpp, 0) << __func__ <<
+	    ": CLSRGWIssueBucketList for " << bucket_info.bucket <<
+	    " shard " << tracker_match.shard_idx << " failed" << dendl;
+	  return r;
+	}
+      }
       next_candidate(cct, tracker_match, candidates, idx);
       if (tracker_match.at_end() && tracker_match.is_truncated()) {
         need_to_stop = true;
@@ -8816,7 +9030,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       // fewer than what was requested
       ldpp_dout(dpp, 10) << __func__ <<
 	": stopped accumulating results at count=" << count <<
-	", dirent=\"" << dirent.key <<
+	", dirent=\"" << name <<
 	"\", because its shard is truncated and exhausted" << dendl;
       break;
     }
@@ -8858,8 +9072,8 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       count << ", which is truncated" << dendl;
   }
 
-  if (last_entry_visited != nullptr && last_entry) {
-    *last_entry = last_entry_visited->key;
+  if (last_entry_visited && last_entry) {
+    *last_entry = *last_entry_visited;
     ldpp_dout(dpp, 20) << __func__ <<
       ": returning, last_entry=" << *last_entry << dendl;
   } else {
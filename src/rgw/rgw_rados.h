@@ -911,6 +911,11 @@ public:
       bool blind;
       bool prepared{false};
       rgw_zone_set *zones_trace{nullptr};
+      // the in-flight prepare op sent by start_prepare(), and its result if
+      // it completed right away
+      std::unique_ptr<rgw::Aio> prepare_aio;
+      int prepare_ret{0};
+      RGWModifyOp prepare_op{CLS_RGW_OP_UNKNOWN};
 
       int init_bs(const DoutPrefixProvider *dpp) {
         int r =
@@ -933,6 +938,7 @@ public:
                                                               bs(target->get_store()) {
                                                                 blind = (target->get_bucket_info().layout.current_index.layout.type == rgw::BucketIndexType::Indexless);
                                                               }
+      ~UpdateIndex();
 
       int get_bucket_shard(BucketShard **pbs, const DoutPrefixProvider *dpp) {
         if (!bs_initialized) {
@@ -954,6 +960,11 @@ public:
       }
 
       int prepare(const DoutPrefixProvider *dpp, RGWModifyOp, const std::string *write_tag, optional_yield y);
+      // send the prepare op without waiting for it, so that it overlaps with
+      // the head object write. wait_prepare() must be called before complete()
+      // or cancel()
+      int start_prepare(const DoutPrefixProvider *dpp, RGWModifyOp, const std::string *write_tag, optional_yield y);
+      int wait_prepare(const DoutPrefixProvider *dpp, optional_yield y);
       int complete(const DoutPrefixProvider *dpp, int64_t poolid, uint64_t epoch, uint64_t size,
                    uint64_t accounted_size, ceph::real_time& ut,
                    const std::string& etag, const std::string& content_type,
@@ -1072,6 +1083,8 @@ public:
   };
 
   D3nDataCache* d3n_data_cache{nullptr};
+  // joins concurrent GETs of the same tail object ranges
+  rgw::ReadCoalescer read_coalescer;
 
   int rewrite_obj(rgw::sal::Object* obj, const DoutPrefixProvider *dpp, optional_yield y);
 
@@ -1383,6 +1396,10 @@ public:
                              const DoutPrefixProvider *dpp);
 
   int cls_obj_prepare_op(const DoutPrefixProvider *dpp, BucketShard& bs, RGWModifyOp op, std::string& tag, rgw_obj& obj, uint16_t bilog_flags, optional_yield y, rgw_zone_set *zones_trace = nullptr);
+  // whether PUTs to the placement target send their index prepare op along
+  // with the head object write
+  bool overlap_index_prepare(const rgw_placement_rule& placement_rule);
+  int cls_obj_prepare_op_async(const DoutPrefixProvider *dpp, BucketShard& bs, RGWModifyOp op, std::string& tag, rgw_obj& obj, uint16_t bilog_flags, rgw::Aio *aio, optional_yield y, rgw_zone_set *zones_trace = nullptr);
   int cls_obj_complete_op(BucketShard& bs, const rgw_obj& obj, RGWModifyOp op, std::string& tag, int64_t pool, uint64_t epoch,
                           rgw_bucket_dir_entry& ent, RGWObjCategory category, std::list<rgw_obj_index_key> *remove_objs, uint16_t bilog_flags, rgw_zone_set *zones_trace = nullptr);
   int cls_obj_complete_add(BucketShard& bs, const rgw_obj& obj, std::string& tag, int64_t pool, uint64_t epoch, rgw_bucket_dir_entry& ent,
@@ -1490,6 +1507,10 @@ public:
                          std::map<RGWObjCategory, RGWStorageStats> *calculated_stats);
   int bucket_rebuild_index(const DoutPrefixProvider *dpp, RGWBucketInfo& bucket_info);
   int bucket_set_reshard(const DoutPrefixProvider *dpp, const RGWBucketInfo& bucket_info, const cls_rgw_bucket_instance_entry& entry);
+  int reshard_log_list(BucketShard& bs, const std::string& marker, uint32_t max,
+                       std::list<std::string> *names, bool *is_truncated);
+  int reshard_log_trim(const DoutPrefixProvider *dpp, const RGWBucketInfo& bucket_info,
+                       const rgw::bucket_index_layout_generation& index);
   int remove_objs_from_index(const DoutPrefixProvider *dpp,
 			     RGWBucketInfo& bucket_info,
 			     const std::list<rgw_obj_index_key>& oid_list);
@@ -1609,6 +1630,7 @@ struct get_obj_data {
 
   D3nGetObjData d3n_get_data;
   std::atomic_bool d3n_bypass_cache_write{false};
+  std::atomic<uint64_t> d3n_obj_size{0};
 
   int flush(rgw::AioResultList&& results);
 
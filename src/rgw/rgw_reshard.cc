@@ -502,6 +502,7 @@ static int init_reshard(rgw::sal::RadosStore* store,
 			std::map<std::string, bufferlist>& bucket_attrs,
                         ReshardFaultInjector& fault,
                         uint32_t new_num_shards,
+                        bool& online,
                         const DoutPrefixProvider *dpp)
 {
   int ret = init_target_layout(store, bucket_info, bucket_attrs, fault, new_num_shards, dpp);
@@ -509,15 +510,34 @@ static int init_reshard(rgw::sal::RadosStore* store,
     return ret;
   }
 
-  if (ret = fault.check("block_writes");
-      ret == 0) { // no fault injected, block writes to the current index shards
-    ret = set_resharding_status(dpp, store, bucket_info,
-                                cls_rgw_reshard_status::IN_PROGRESS);
+  if (online) {
+    // drop the names recorded by an earlier attempt. osds without support
+    // for the reshard log fail this, and the writes get blocked instead
+    ret = store->getRados()->reshard_log_trim(dpp, bucket_info,
+                                              bucket_info.layout.current_index);
+    if (ret == -EOPNOTSUPP) {
+      ldpp_dout(dpp, 1) << "WARNING: " << __func__ << " the bucket index "
+          "does not support online resharding, blocking writes" << dendl;
+      online = false;
+      ret = 0;
+    }
+  }
+
+  if (ret == 0) {
+    // an online reshard only records the writes to the current index shards
+    // until its cutover, otherwise they are blocked for the whole reshard
+    const auto status = online ? cls_rgw_reshard_status::IN_LOGRECORD :
+                                 cls_rgw_reshard_status::IN_PROGRESS;
+    if (ret = fault.check(online ? "logrecord_writes" : "block_writes");
+        ret == 0) { // no fault injected, set the status of the index shards
+      ret = set_resharding_status(dpp, store, bucket_info, status);
+    }
   }
 
   if (ret < 0) {
-    ldpp_dout(dpp, 0) << "ERROR: " << __func__ << " failed to pause "
-        "writes to the current index: " << cpp_strerror(ret) << dendl;
+    ldpp_dout(dpp, 0) << "ERROR: " << __func__ << " failed to "
+        << (online ? "record" : "pause") << " writes to the current index: "
+        << cpp_strerror(ret) << dendl;
     // clean up the target layout (ignore errors)
     revert_target_layout(store, bucket_info, bucket_attrs, fault, dpp);
     return ret;
@@ -525,6 +545,25 @@ static int init_reshard(rgw::sal::RadosStore* store,
   return 0;
 } // init_reshard
 
+// block writes to the current index shards of an online reshard, so that the
+// entries modified since they were copied can be copied again
+static int block_writes(rgw::sal::RadosStore* store,
+                        RGWBucketInfo& bucket_info,
+                        ReshardFaultInjector& fault,
+                        const DoutPrefixProvider *dpp)
+{
+  int ret = fault.check("block_writes");
+  if (ret == 0) { // no fault injected, block writes to the current index shards
+    ret = set_resharding_status(dpp, store, bucket_info,
+                                cls_rgw_reshard_status::IN_PROGRESS);
+  }
+  if (ret < 0) {
+    ldpp_dout(dpp, 0) << "ERROR: " << __func__ << " failed to pause "
+        "writes to the current index: " << cpp_strerror(ret) << dendl;
+  }
+  return ret;
+} // block_writes
+
 static int cancel_reshard(rgw::sal::RadosStore* store,
                           RGWBucketInfo& bucket_info,
 			  std::map<std::string, bufferlist>& bucket_attrs,
@@ -540,6 +579,10 @@ static int cancel_reshard(rgw::sal::RadosStore* store,
     ret = 0; // non-fatal error
   }
 
+  // drop the names recorded by an online reshard (ignore errors)
+  store->getRados()->reshard_log_trim(dpp, bucket_info,
+                                      bucket_info.layout.current_index);
+
   if (bucket_info.layout.target_index) {
     return revert_target_layout(store, bucket_info, bucket_attrs, fault, dpp);
   }
@@ -667,6 +710,9 @@ static int commit_reshard(rgw::sal::RadosStore* store,
   if (log == logs.end()) {
     // delete the index objects (ignore errors)
     store->svc()->bi->clean_index(dpp, bucket_info, prev.current_index);
+  } else {
+    // drop the names recorded by an online reshard (ignore errors)
+    store->getRados()->reshard_log_trim(dpp, bucket_info, prev.current_index);
   }
   return 0;
 } // commit_reshard
@@ -785,6 +831,88 @@ int RGWBucketReshardLock::renew(const Clock::time_point& now) {
 }
 
 
+static uint64_t entries_per_sec(uint64_t entries, ceph::timespan elapsed)
+{
+  const double secs = std::chrono::duration<double>(elapsed).count();
+  return secs > 0 ? entries / secs : entries;
+}
+
+// returns the shard of the target layout for the index entries of an object
+static int get_target_shard(rgw::sal::RadosStore* store,
+                            const RGWBucketInfo& bucket_info,
+                            const rgw::bucket_index_layout_generation& target,
+                            const rgw_obj_key& key, int *shard_index)
+{
+  rgw_obj obj(bucket_info.bucket, key);
+  RGWMPObj mp;
+  if (key.ns == RGW_OBJ_NS_MULTIPART && mp.from_meta(key.name)) {
+    // place the multipart .meta object on the same shard as its head object
+    obj.index_hash_source = mp.get_key();
+  }
+  int target_shard_id;
+  int ret = store->getRados()->get_target_shard_id(target.layout.normal,
+                                                   obj.get_hash_object(),
+                                                   &target_shard_id);
+  if (ret < 0) {
+    ldout(store->ctx(), -1) << "ERROR: get_target_shard_id() returned ret=" << ret << dendl;
+    return ret;
+  }
+  *shard_index = (target_shard_id > 0 ? target_shard_id : 0);
+  return 0;
+}
+
+// lists the index entries of an object on a bucket index shard
+static int list_object_entries(rgw::sal::RadosStore* store,
+                               RGWRados::BucketShard& bs,
+                               const std::string& name, int max_entries,
+                               std::map<std::string, rgw_cls_bi_entry> *entries)
+{
+  std::string marker;
+  bool is_truncated = true;
+  while (is_truncated) {
+    std::list<rgw_cls_bi_entry> page;
+    int ret = store->getRados()->bi_list(bs, name, marker, max_entries,
+                                         &page, &is_truncated);
+    if (ret < 0) {
+      return ret;
+    }
+    for (auto& entry : page) {
+      marker = entry.idx;
+      cls_rgw_obj_key key;
+      RGWObjCategory category;
+      rgw_bucket_category_stats stats;
+      entry.get_info(&key, &category, &stats);
+      // the name filter also matches names that it is a prefix of
+      if (key.name == name) {
+        entries->emplace(entry.idx, std::move(entry));
+      }
+    }
+  }
+  return 0;
+}
+
+int RGWBucketReshard::renew_lock(const DoutPrefixProvider *dpp)
+{
+  Clock::time_point now = Clock::now();
+  if (!reshard_lock.should_renew(now)) {
+    return 0;
+  }
+  // assume outer locks have timespans at least the size of ours, so
+  // can call inside conditional
+  if (outer_reshard_lock) {
+    int ret = outer_reshard_lock->renew(now);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  int ret = reshard_lock.renew(now);
+  if (ret < 0) {
+    ldpp_dout(dpp, -1) << "Error renewing bucket lock: " << ret << dendl;
+    return ret;
+  }
+  return 0;
+}
+
 int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& current,
                                  const rgw::bucket_index_layout_generation& target,
                                  int max_entries,
@@ -821,9 +949,16 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
     (*out) << "total entries:";
   }
 
+  const auto start = Clock::now();
   const int num_source_shards = current.layout.normal.num_shards;
   string marker;
   for (int i = 0; i < num_source_shards; ++i) {
+    if (i > 0) {
+      ldpp_dout(dpp, 5) << __func__ << " INFO: copied " << i << "/"
+          << num_source_shards << " shards, " << total_entries << " entries ("
+          << entries_per_sec(total_entries, Clock::now() - start)
+          << " entries/s)" << dendl;
+    }
     bool is_truncated = true;
     marker.clear();
     const std::string null_object_filter; // empty string since we're not filtering by object
@@ -861,42 +996,20 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
 	  ldpp_dout(dpp, 10) << "Dropping entry with empty name, idx=" << marker << dendl;
 	  continue;
 	}
-	rgw_obj obj(bucket_info.bucket, key);
-	RGWMPObj mp;
-	if (key.ns == RGW_OBJ_NS_MULTIPART && mp.from_meta(key.name)) {
-	  // place the multipart .meta object on the same shard as its head object
-	  obj.index_hash_source = mp.get_key();
-	}
-	ret = store->getRados()->get_target_shard_id(bucket_info.layout.target_index->layout.normal,
-						     obj.get_hash_object(), &target_shard_id);
+	ret = get_target_shard(store, bucket_info, target, key, &target_shard_id);
 	if (ret < 0) {
-	  ldpp_dout(dpp, -1) << "ERROR: get_target_shard_id() returned ret=" << ret << dendl;
 	  return ret;
 	}
 
-	int shard_index = (target_shard_id > 0 ? target_shard_id : 0);
-
-	ret = target_shards_mgr.add_entry(shard_index, entry, account,
+	ret = target_shards_mgr.add_entry(target_shard_id, entry, account,
 					  category, stats);
 	if (ret < 0) {
 	  return ret;
 	}
 
-	Clock::time_point now = Clock::now();
-	if (reshard_lock.should_renew(now)) {
-	  // assume outer locks have timespans at least the size of ours, so
-	  // can call inside conditional
-	  if (outer_reshard_lock) {
-	    ret = outer_reshard_lock->renew(now);
-	    if (ret < 0) {
-	      return ret;
-	    }
-	  }
-	  ret = reshard_lock.renew(now);
-	  if (ret < 0) {
-	    ldpp_dout(dpp, -1) << "Error renewing bucket lock: " << ret << dendl;
-	    return ret;
-	  }
+	ret = renew_lock(dpp);
+	if (ret < 0) {
+	  return ret;
 	}
 	if (verbose_json_out) {
 	  formatter->close_section();
@@ -920,9 +1033,145 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
     ldpp_dout(dpp, -1) << "ERROR: failed to reshard" << dendl;
     return -EIO;
   }
+
+  const auto elapsed = Clock::now() - start;
+  ldpp_dout(dpp, 1) << __func__ << " INFO: copied " << total_entries
+      << " entries of bucket \"" << bucket_info.bucket.name << "\" in "
+      << std::chrono::duration<double>(elapsed).count() << "s ("
+      << entries_per_sec(total_entries, elapsed) << " entries/s)" << dendl;
   return 0;
 } // RGWBucketReshard::do_reshard
 
+// copy the current index entries of an object from its source shard to its
+// target shard, replacing the ones copied before it was last modified
+static int replay_object(rgw::sal::RadosStore* store,
+                         const RGWBucketInfo& bucket_info,
+                         RGWRados::BucketShard& source,
+                         const rgw::bucket_index_layout_generation& target,
+                         const std::string& name,
+                         int max_entries,
+                         const DoutPrefixProvider *dpp)
+{
+  int target_shard_id;
+  int ret = get_target_shard(store, bucket_info, target,
+                             rgw_obj_key(cls_rgw_obj_key(name)),
+                             &target_shard_id);
+  if (ret < 0) {
+    return ret;
+  }
+  RGWRados::BucketShard bs(store->getRados());
+  ret = bs.init(dpp, bucket_info, target, target_shard_id);
+  if (ret < 0) {
+    return ret;
+  }
+
+  std::map<std::string, rgw_cls_bi_entry> source_entries;
+  ret = list_object_entries(store, source, name, max_entries, &source_entries);
+  if (ret < 0) {
+    return ret;
+  }
+  std::map<std::string, rgw_cls_bi_entry> target_entries;
+  ret = list_object_entries(store, bs, name, max_entries, &target_entries);
+  if (ret < 0) {
+    return ret;
+  }
+
+  // replace the copied entries and their stats with the current ones. the
+  // stats are unsigned, so a decrease is added as its two's complement
+  std::map<RGWObjCategory, rgw_bucket_category_stats> stats;
+  auto account = [&stats] (rgw_cls_bi_entry& entry, bool add) {
+    cls_rgw_obj_key key;
+    RGWObjCategory category;
+    rgw_bucket_category_stats entry_stats;
+    if (!entry.get_info(&key, &category, &entry_stats)) {
+      return;
+    }
+    auto& s = stats[category];
+    if (add) {
+      s.num_entries += entry_stats.num_entries;
+      s.total_size += entry_stats.total_size;
+      s.total_size_rounded += entry_stats.total_size_rounded;
+      s.actual_size += entry_stats.actual_size;
+    } else {
+      s.num_entries -= entry_stats.num_entries;
+      s.total_size -= entry_stats.total_size;
+      s.total_size_rounded -= entry_stats.total_size_rounded;
+      s.actual_size -= entry_stats.actual_size;
+    }
+  };
+
+  librados::ObjectWriteOperation op;
+  std::set<std::string> removed;
+  for (auto& [idx, entry] : target_entries) {
+    if (!source_entries.count(idx)) {
+      removed.insert(idx);
+    }
+    account(entry, false);
+  }
+  if (!removed.empty()) {
+    op.omap_rm_keys(removed);
+  }
+  for (auto& [idx, entry] : source_entries) {
+    store->getRados()->bi_put(op, bs, entry);
+    account(entry, true);
+  }
+  cls_rgw_bucket_update_stats(op, false, stats);
+
+  ret = bs.bucket_obj.operate(dpp, &op, null_yield);
+  if (ret < 0) {
+    ldpp_dout(dpp, -1) << "ERROR: " << __func__ << " failed to update entries of "
+        << name << " on target shard " << target_shard_id << ": "
+        << cpp_strerror(-ret) << dendl;
+  }
+  return ret;
+} // replay_object
+
+int RGWBucketReshard::replay_reshard_log(const rgw::bucket_index_layout_generation& current,
+                                         const rgw::bucket_index_layout_generation& target,
+                                         int max_entries,
+                                         uint64_t *replayed,
+                                         const DoutPrefixProvider *dpp)
+{
+  const int num_source_shards = current.layout.normal.num_shards;
+  for (int i = 0; i < num_source_shards; ++i) {
+    RGWRados::BucketShard bs(store->getRados());
+    int ret = bs.init(dpp, bucket_info, current, i);
+    if (ret < 0) {
+      return ret;
+    }
+
+    std::string marker;
+    bool is_truncated = true;
+    while (is_truncated) {
+      std::list<std::string> names;
+      ret = store->getRados()->reshard_log_list(bs, marker, max_entries,
+                                                &names, &is_truncated);
+      if (ret < 0) {
+        ldpp_dout(dpp, -1) << "ERROR: " << __func__ << " failed to list the "
+            "reshard log of shard " << i << ": " << cpp_strerror(-ret) << dendl;
+        return ret;
+      }
+      for (const auto& name : names) {
+        marker = name;
+        if (name.empty()) {
+          continue;
+        }
+        ret = replay_object(store, bucket_info, bs, target, name,
+                            max_entries, dpp);
+        if (ret < 0) {
+          return ret;
+        }
+        ++*replayed;
+      }
+      ret = renew_lock(dpp);
+      if (ret < 0) {
+        return ret;
+      }
+    }
+  }
+  return 0;
+} // RGWBucketReshard::replay_reshard_log
+
 int RGWBucketReshard::get_status(const DoutPrefixProvider *dpp, list<cls_rgw_bucket_instance_entry> *status)
 {
   return store->svc()->bi_rados->get_reshard_status(dpp, bucket_info, status);
@@ -952,7 +1201,9 @@ int RGWBucketReshard::execute(int num_shards,
   }
 
   // prepare the target index and add its layout the bucket info
-  ret = init_reshard(store, bucket_info, bucket_attrs, fault, num_shards, dpp);
+  bool online = store->ctx()->_conf.get_val<bool>("rgw_reshard_online");
+  ret = init_reshard(store, bucket_info, bucket_attrs, fault, num_shards,
+                     online, dpp);
   if (ret < 0) {
     return ret;
   }
@@ -964,6 +1215,18 @@ int RGWBucketReshard::execute(int num_shards,
                      max_op_entries, verbose, out, formatter, dpp);
   }
 
+  // with an online reshard, writes are only blocked from here on
+  const auto blocked = Clock::now();
+  uint64_t replayed = 0;
+  if (ret == 0 && online) {
+    ret = block_writes(store, bucket_info, fault, dpp);
+    if (ret == 0) {
+      ret = replay_reshard_log(bucket_info.layout.current_index,
+                               *bucket_info.layout.target_index,
+                               max_op_entries, &replayed, dpp);
+    }
+  }
+
   if (ret < 0) {
     cancel_reshard(store, bucket_info, bucket_attrs, fault, dpp);
 
@@ -977,6 +1240,19 @@ int RGWBucketReshard::execute(int num_shards,
     return ret;
   }
 
+  if (online) {
+    const double cutover = std::chrono::duration<double>(
+        Clock::now() - blocked).count();
+    ldpp_dout(dpp, 1) << __func__ << " INFO: copied " << replayed
+        << " objects modified during the reshard of bucket \""
+        << bucket_info.bucket.name << "\", writes were blocked for "
+        << cutover << "s" << dendl;
+    if (out && !(verbose && formatter)) {
+      (*out) << "objects modified during reshard: " << replayed << std::endl;
+      (*out) << "writes blocked for: " << cutover << "s" << std::endl;
+    }
+  }
+
   ldpp_dout(dpp, 1) << __func__ << " INFO: reshard of bucket \""
       << bucket_info.bucket.name << "\" completed successfully" << dendl;
   return 0;
@@ -83,6 +83,7 @@ class RGWBucketReshard {
   // allocated in at once
   static const std::initializer_list<uint16_t> reshard_primes;
 
+  int renew_lock(const DoutPrefixProvider *dpp);
   int do_reshard(const rgw::bucket_index_layout_generation& current,
                  const rgw::bucket_index_layout_generation& target,
                  int max_entries,
@@ -90,6 +91,13 @@ class RGWBucketReshard {
                  std::ostream *os,
 		 Formatter *formatter,
                  const DoutPrefixProvider *dpp);
+  // copy the entries of the objects modified while do_reshard() ran, which
+  // the current index shards recorded in their reshard log
+  int replay_reshard_log(const rgw::bucket_index_layout_generation& current,
+                         const rgw::bucket_index_layout_generation& target,
+                         int max_entries,
+                         uint64_t *replayed,
+                         const DoutPrefixProvider *dpp);
 public:
 
   // pass nullptr for the final parameter if no outer reshard lock to
@@ -746,9 +746,7 @@ void dump_range(req_state* const s,
 }
 
 
-int dump_body(req_state* const s,
-              const char* const buf,
-              const size_t len)
+static void ratelimit_body(req_state* const s, const size_t len)
 {
   bool healthchk = false;
   // we dont want to limit health checks
@@ -760,6 +758,13 @@ int dump_body(req_state* const s,
     if(!rgw::sal::Bucket::empty(s->bucket.get()))
       s->ratelimit_data->decrease_bytes(method, s->ratelimit_bucket_marker, len, &s->bucket_ratelimit);
   }
+}
+
+int dump_body(req_state* const s,
+              const char* const buf,
+              const size_t len)
+{
+  ratelimit_body(s, len);
   try {
     return RESTFUL_IO(s)->send_body(buf, len);
   } catch (rgw::io::Exception& e) {
@@ -767,9 +772,51 @@ int dump_body(req_state* const s,
   }
 }
 
+int dump_body(req_state* const s, const ceph::buffer::list& bl,
+              size_t ofs, size_t len)
+{
+  // send large buffers in place; c_str() would copy a fragmented bufferlist,
+  // as read from rados, into a contiguous one first. small buffers are still
+  // gathered, to avoid a write to the socket for each
+  static constexpr size_t min_send = 64 * 1024;
+  ratelimit_body(s, len);
+  size_t sent = 0;
+  std::string pending;
+  try {
+    for (const auto& bp : bl.buffers()) {
+      if (len == 0) {
+        break;
+      }
+      if (ofs >= bp.length()) {
+        ofs -= bp.length();
+        continue;
+      }
+      const size_t n = std::min<size_t>(bp.length() - ofs, len);
+      if (n < min_send) {
+        pending.append(bp.c_str() + ofs, n);
+      }
+      if (!pending.empty() && (n >= min_send || pending.size() >= min_send)) {
+        sent += RESTFUL_IO(s)->send_body(pending.data(), pending.size());
+        pending.clear();
+      }
+      if (n >= min_send) {
+        sent += RESTFUL_IO(s)->send_body(bp.c_str() + ofs, n);
+      }
+      ofs = 0;
+      len -= n;
+    }
+    if (!pending.empty()) {
+      sent += RESTFUL_IO(s)->send_body(pending.data(), pending.size());
+    }
+  } catch (rgw::io::Exception& e) {
+    return -e.code().value();
+  }
+  return sent;
+}
+
 int dump_body(req_state* const s, /* const */ ceph::buffer::list& bl)
 {
-  return dump_body(s, bl.c_str(), bl.length());
+  return dump_body(s, bl, 0, bl.length());
 }
 
 int dump_body(req_state* const s, const std::string& str)
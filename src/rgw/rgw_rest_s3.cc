@@ -556,7 +556,7 @@ done:
 
 send_data:
   if (get_data && !op_ret) {
-    int r = dump_body(s, bl.c_str() + bl_ofs, bl_len);
+    int r = dump_body(s, bl, bl_ofs, bl_len);
     if (r < 0)
       return r;
   }
@@ -2592,6 +2592,24 @@ int RGWPutObj_ObjStore_S3::get_params(optional_yield y)
     return -EINVAL;
   }
 
+  /* handle additional checksums */
+  const char *cksum_alg = s->info.env->get("HTTP_X_AMZ_SDK_CHECKSUM_ALGORITHM");
+  auto get_cksum_header = [this] (std::string_view name) {
+    std::string header = "HTTP_X_AMZ_CHECKSUM_";
+    for (auto c : name) {
+      header.push_back(::toupper(c));
+    }
+    return s->info.env->get(header.c_str());
+  };
+  if (!rgw::hash::Checksum::from_headers(cksum_alg, get_cksum_header,
+                                         &checksum_type, &supplied_checksum)) {
+    ldpp_dout(this, 5) << "conflicting checksum headers" << dendl;
+    return -ERR_INVALID_REQUEST;
+  }
+  if (cksum_alg && !checksum_type) {
+    ldpp_dout(this, 10) << "ignoring unsupported checksum algorithm: " << cksum_alg << dendl;
+  }
+
   append = s->info.args.exists("append");
   if (append) {
     string pos_str = s->info.args.get("position");
@@ -2654,6 +2672,11 @@ void RGWPutObj_ObjStore_S3::send_response()
       dump_content_length(s, 0);
       dump_header_if_nonempty(s, "x-amz-version-id", version_id);
       dump_header_if_nonempty(s, "x-amz-expiration", expires);
+      if (checksum_type && !checksum.empty()) {
+        dump_header_prefixed(s, "x-amz-checksum-",
+                             rgw::hash::Checksum::name(*checksum_type),
+                             checksum);
+      }
       for (auto &it : crypt_http_responses)
         dump_header(s, it.first, it.second);
     } else {
@@ -2749,7 +2772,9 @@ int RGWPutObj_ObjStore_S3::get_encrypt_filter(
        * We use crypto mode that configured as if we were decrypting. */
       res = rgw_s3_prepare_decrypt(s, obj->get_attrs(), &block_crypt, crypt_http_responses);
       if (res == 0 && block_crypt != nullptr)
-        filter->reset(new RGWPutObj_BlockEncrypt(s, s->cct, cb, std::move(block_crypt)));
+        filter->reset(new RGWPutObj_BlockEncrypt(s, s->cct, cb, std::move(block_crypt),
+                                                 rgw::putobj::TransformPool::get(s->cct),
+                                                 s->yield));
     }
     /* it is ok, to not have encryption at all */
   }
@@ -2758,7 +2783,9 @@ int RGWPutObj_ObjStore_S3::get_encrypt_filter(
     std::unique_ptr<BlockCrypt> block_crypt;
     res = rgw_s3_prepare_encrypt(s, attrs, &block_crypt, crypt_http_responses);
     if (res == 0 && block_crypt != nullptr) {
-      filter->reset(new RGWPutObj_BlockEncrypt(s, s->cct, cb, std::move(block_crypt)));
+      filter->reset(new RGWPutObj_BlockEncrypt(s, s->cct, cb, std::move(block_crypt),
+                                                 rgw::putobj::TransformPool::get(s->cct),
+                                                 s->yield));
     }
   }
   return res;
@@ -3306,7 +3333,9 @@ int RGWPostObj_ObjStore_S3::get_encrypt_filter(
   int res = rgw_s3_prepare_encrypt(s, attrs, &block_crypt,
                                    crypt_http_responses);
   if (res == 0 && block_crypt != nullptr) {
-    filter->reset(new RGWPutObj_BlockEncrypt(s, s->cct, cb, std::move(block_crypt)));
+    filter->reset(new RGWPutObj_BlockEncrypt(s, s->cct, cb, std::move(block_crypt),
+                                                 rgw::putobj::TransformPool::get(s->cct),
+                                                 s->yield));
   }
   return res;
 }
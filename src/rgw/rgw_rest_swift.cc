@@ -1557,7 +1557,7 @@ int RGWGetObj_ObjStore_SWIFT::send_response_data(bufferlist& bl,
 
 send_data:
   if (get_data && !op_ret) {
-    const auto r = dump_body(s, bl.c_str() + bl_ofs, bl_len);
+    const auto r = dump_body(s, bl, bl_ofs, bl_len);
     if (r < 0) {
       return r;
     }
@@ -2,6 +2,7 @@
 // vim: ts=8 sw=2 smarttab ft=cpp
 
 #include "rgw_s3select_private.h"
+#include "rgw_perf_counters.h"
 
 #define dout_subsys ceph_subsys_rgw
 
@@ -261,6 +262,7 @@ void aws_response_handler::send_stats_response()
 RGWSelectObj_ObjStore_S3::RGWSelectObj_ObjStore_S3():
   m_buff_header(std::make_unique<char[]>(1000)),
   m_parquet_type(false),
+  m_requested_ofs(0),
   chunk_number(0)
 {
   set_get_data(true);
@@ -539,15 +541,34 @@ int RGWSelectObj_ObjStore_S3::range_request(int64_t ofs, int64_t len, void* buff
 {
   //purpose: implementation for arrow::ReadAt, this may take several async calls.
   //send_response_date(call_back) accumulate buffer, upon completion control is back to ReadAt.
-  range_req_str = "bytes=" + std::to_string(ofs) + "-" + std::to_string(ofs+len-1);
+  if (ofs >= m_requested_ofs &&
+      ofs + len <= m_requested_ofs + static_cast<int64_t>(requested_buffer.size())) {
+    //the range was fetched by a previous (extended) request
+    ldout(s->cct, 10) << "S3select: range-request served from buffer offset: " << ofs << " length: " << len << dendl;
+    memcpy(buff, requested_buffer.data() + (ofs - m_requested_ofs), len);
+    return len;
+  }
+  //the reader asks for each page/column-chunk separately; small requests are extended,
+  //so that the following ones (footer, adjacent column-chunks) do not cost another round-trip
+  const int64_t min_read = s->cct->_conf.get_val<Option::size_t>("rgw_s3select_parquet_min_read");
+  const auto [fetch_ofs, fetch_len] = rgw::s3select::parquet_read_extent(ofs, len, s->obj_size, min_read);
+  range_req_str = "bytes=" + std::to_string(fetch_ofs) + "-" + std::to_string(fetch_ofs+fetch_len-1);
   range_str = range_req_str.c_str();
   range_parsed = false;
   RGWGetObj::parse_range();
   requested_buffer.clear();
-  m_request_range = len;
-  ldout(s->cct, 10) << "S3select: calling execute(async):" << " request-offset :" << ofs << " request-length :" << len << " buffer size : " << requested_buffer.size() << dendl;
+  m_requested_ofs = fetch_ofs;
+  m_request_range = fetch_len;
+  ldout(s->cct, 10) << "S3select: calling execute(async):" << " request-offset :" << ofs << " request-length :" << len
+                    << " fetch-offset :" << fetch_ofs << " fetch-length :" << fetch_len << dendl;
   RGWGetObj::execute(y);
-  memcpy(buff, requested_buffer.data(), len);
+  m_aws_response_handler.update_processed_size(requested_buffer.size());
+  if (requested_buffer.size() < static_cast<size_t>(ofs - fetch_ofs + len)) {
+    ldout(s->cct, 10) << "S3select: range-request failed, buffer-size:" << requested_buffer.size() << " op_ret:" << op_ret << dendl;
+    requested_buffer.clear();
+    return op_ret < 0 ? op_ret : -EIO;
+  }
+  memcpy(buff, requested_buffer.data() + (ofs - fetch_ofs), len);
   ldout(s->cct, 10) << "S3select: done waiting, buffer is complete buffer-size:" << requested_buffer.size() << dendl;
   return len;
 }
@@ -564,8 +585,8 @@ void RGWSelectObj_ObjStore_S3::execute(optional_yield y)
 #endif
   if (m_parquet_type) {
     //parquet processing
-    range_request(0, 4, parquet_magic, y);
-    if(memcmp(parquet_magic, parquet_magic1, 4) && memcmp(parquet_magic, parquet_magicE, 4)) {
+    if (range_request(0, 4, parquet_magic, y) < 0 ||
+        (memcmp(parquet_magic, parquet_magic1, 4) && memcmp(parquet_magic, parquet_magicE, 4))) {
       ldout(s->cct, 10) << s->object->get_name() << " does not contain parquet magic" << dendl;
       op_ret = -ERR_INVALID_REQUEST;
       return;
@@ -576,7 +597,17 @@ void RGWSelectObj_ObjStore_S3::execute(optional_yield y)
       ldout(s->cct, 10) << "S3select: failed to process query <" << m_sql_query << "> on object " << s->object->get_name() << dendl;
       op_ret = -ERR_INVALID_REQUEST;
     } else {
-      ldout(s->cct, 10) << "S3select: complete query with success " << dendl;
+      //only the footer and the column-chunks the reader asked for were fetched
+      const uint64_t scanned = std::min<uint64_t>(m_aws_response_handler.get_processed_size(), s->obj_size);
+      ldout(s->cct, 10) << "S3select: complete query with success, scanned " << scanned
+                        << " skipped " << s->obj_size - scanned << " of " << s->obj_size << " bytes" << dendl;
+      if (perfcounter) {
+        perfcounter->inc(l_rgw_s3select_scanned_b, scanned);
+        perfcounter->inc(l_rgw_s3select_skipped_b, s->obj_size - scanned);
+      }
+      m_aws_response_handler.init_stats_response();
+      m_aws_response_handler.send_stats_response();
+      m_aws_response_handler.init_end_response();
     }
   } else {
     //CSV processing
@@ -646,6 +677,9 @@ int RGWSelectObj_ObjStore_S3::csv_processing(bufferlist& bl, off_t ofs, off_t le
     }
   }
   if (m_aws_response_handler.get_processed_size() == s->obj_size) {
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_s3select_scanned_b, s->obj_size);
+    }
     if (status >=0) {
       m_aws_response_handler.init_stats_response();
       m_aws_response_handler.send_stats_response();
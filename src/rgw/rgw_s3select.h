@@ -2,7 +2,28 @@
 // vim: ts=8 sw=2 smarttab ft=cpp
 //
 
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+class RGWOp;
+
 namespace rgw::s3select {
 RGWOp* create_s3select_op();
-}
 
+// the (offset, length) to fetch for a Parquet read of len bytes at ofs.
+// shorter reads than min_read are extended to it, backwards near the end of the
+// object, so that the footer length and the footer before it are fetched together.
+inline std::pair<int64_t, int64_t> parquet_read_extent(int64_t ofs, int64_t len,
+                                                       int64_t obj_size, int64_t min_read)
+{
+  if (len >= min_read) {
+    return {ofs, len};
+  }
+  const int64_t start = std::max<int64_t>(0, std::min(ofs, obj_size - min_read));
+  const int64_t end = std::min(obj_size, std::max(ofs + len, start + min_read));
+  return {start, end - start};
+}
+}
@@ -193,6 +193,8 @@ private:
 #endif
   //a request for range may statisfy by several calls to send_response_date;
   size_t m_request_range;
+  //object offset of requested_buffer, which also serves later requests within it
+  int64_t m_requested_ofs;
   std::string requested_buffer;
   std::string range_req_str;
   std::function<int(std::string&)> fp_result_header_format;
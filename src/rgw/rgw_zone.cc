@@ -3347,6 +3347,7 @@ void RGWZonePlacementInfo::dump(Formatter *f) const
   encode_json("storage_classes", storage_classes, f);
   encode_json("data_extra_pool", data_extra_pool, f);
   encode_json("index_type", (uint32_t)index_type, f);
+  encode_json("overlap_index_prepare", overlap_index_prepare, f);
 
   /* no real need for backward compatibility of compression_type and data_pool in here,
    * rather not clutter the output */
@@ -3360,6 +3361,7 @@ void RGWZonePlacementInfo::decode_json(JSONObj *obj)
   uint32_t it;
   JSONDecoder::decode_json("index_type", it, obj);
   index_type = (rgw::BucketIndexType)it;
+  JSONDecoder::decode_json("overlap_index_prepare", overlap_index_prepare, obj);
 
   /* backward compatibility, these are now defined in storage_classes */
   string standard_compression_type;
@@ -1252,3 +1252,101 @@ TEST_F(cls_rgw, bi_log_trim)
     EXPECT_FALSE(truncated);
   }
 }
+
+static int guard_resharding(librados::IoCtx& ioctx, const std::string& oid)
+{
+  librados::ObjectWriteOperation op;
+  cls_rgw_guard_bucket_resharding(op, -EBUSY);
+  op.create(false);
+  return ioctx.operate(oid, &op);
+}
+
+static int reshard_log_trim(librados::IoCtx& ioctx, const std::string& oid)
+{
+  librados::ObjectWriteOperation op;
+  cls_rgw_reshard_log_trim(op);
+  return ioctx.operate(oid, &op);
+}
+
+TEST_F(cls_rgw, reshard_log)
+{
+  string bucket_oid = str_int("bucket", 7);
+
+  ObjectWriteOperation op;
+  cls_rgw_bucket_init_index(op);
+  ASSERT_EQ(0, ioctx.operate(bucket_oid, &op));
+
+  // nothing is recorded before resharding starts
+  {
+    cls_rgw_obj_key obj = str_int("before", 0);
+    string tag = str_int("tag", 0);
+    string loc = str_int("loc", 0);
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc);
+    rgw_bucket_dir_entry_meta meta;
+    index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, 1, obj, meta);
+  }
+  ASSERT_EQ(-ENODATA, reshard_log_trim(ioctx, bucket_oid));
+
+  // writes are allowed and recorded while in logrecord
+  cls_rgw_bucket_instance_entry entry;
+  entry.set_status(cls_rgw_reshard_status::IN_LOGRECORD);
+  ASSERT_EQ(0, cls_rgw_set_bucket_resharding(ioctx, bucket_oid, entry));
+  ASSERT_EQ(0, guard_resharding(ioctx, bucket_oid));
+
+  for (int i = 0; i < 10; i++) {
+    cls_rgw_obj_key obj = str_int("obj", i);
+    string tag = str_int("tag", i);
+    string loc = str_int("loc", i);
+    index_prepare(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, obj, loc);
+    rgw_bucket_dir_entry_meta meta;
+    index_complete(ioctx, bucket_oid, CLS_RGW_OP_ADD, tag, 1, obj, meta);
+  }
+  {
+    list<string> names;
+    bool truncated{false};
+    ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, "", 4,
+                                          &names, &truncated));
+    EXPECT_EQ(4u, names.size());
+    EXPECT_TRUE(truncated);
+    const string marker = names.back();
+    ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, marker, 128,
+                                          &names, &truncated));
+    EXPECT_EQ(6u, names.size());
+    EXPECT_FALSE(truncated);
+    EXPECT_EQ(str_int("obj", 9), names.back());
+  }
+
+  // the bucket index listing doesn't include the log
+  {
+    map<int, string> oids = { {0, bucket_oid} };
+    map<int, struct rgw_cls_list_ret> list_results;
+    cls_rgw_obj_key start_key("", "");
+    rgw_cls_list_ret& ret = list_results[0];
+    ObjectReadOperation rop;
+    cls_rgw_bucket_list_op(rop, start_key, "", "", 1000, true, &ret);
+    ASSERT_EQ(0, ioctx.operate(bucket_oid, &rop, nullptr));
+    EXPECT_EQ(11u, ret.dir.m.size());
+  }
+
+  // writes are blocked while in progress
+  entry.set_status(cls_rgw_reshard_status::IN_PROGRESS);
+  ASSERT_EQ(0, cls_rgw_set_bucket_resharding(ioctx, bucket_oid, entry));
+  ASSERT_EQ(-EBUSY, guard_resharding(ioctx, bucket_oid));
+
+  // trim until the log is empty
+  int ret = 0;
+  while ((ret = reshard_log_trim(ioctx, bucket_oid)) == 0)
+    ;
+  ASSERT_EQ(-ENODATA, ret);
+  {
+    list<string> names;
+    bool truncated{false};
+    ASSERT_EQ(0, cls_rgw_reshard_log_list(ioctx, bucket_oid, "", 128,
+                                          &names, &truncated));
+    EXPECT_TRUE(names.empty());
+    EXPECT_FALSE(truncated);
+  }
+
+  ASSERT_EQ(0, cls_rgw_clear_bucket_resharding(ioctx, bucket_oid));
+  ASSERT_EQ(0, guard_resharding(ioctx, bucket_oid));
+}
@@ -17,6 +17,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "gtest/gtest.h"
 #include "common/ceph_context.h"
 #include "common/config.h"
@@ -24,6 +25,7 @@
 #include "compressor/CompressionPlugin.h"
 #include "global/global_context.h"
 #include "osd/OSDMap.h"
+#include "zstd_dicts/dict.4242.h"
 
 using namespace std;
 
@@ -388,6 +390,122 @@ INSTANTIATE_TEST_SUITE_P(
 #endif
     "zstd"));
 
+TEST(ZstdCompressor, missing_dictionary)
+{
+  CompressorRef zstd = Compressor::create(g_ceph_context, "zstd");
+  ASSERT_TRUE(zstd);
+  bufferlist in, out;
+  in.append("This is a short string.  There are many strings like it but this one is mine.");
+
+  // a dictionary that isn't loaded falls back to plain zstd
+  std::optional<int32_t> compressor_message = 12345;
+  int res = zstd->compress(in, out, compressor_message);
+  ASSERT_EQ(0, res);
+  EXPECT_FALSE(compressor_message);
+  bufferlist after;
+  res = zstd->decompress(out, after, compressor_message);
+  ASSERT_EQ(0, res);
+  EXPECT_TRUE(in.contents_equal(after));
+
+  // but data referencing an unknown dictionary can't be decompressed
+  after.clear();
+  res = zstd->decompress(out, after, std::optional<int32_t>(12345));
+  EXPECT_EQ(-ENOENT, res);
+}
+
+// a dictionary trained with 'zstd --train --maxdict=2048 --dictID=4242' on
+// small json documents. the compressors of a context load their dictionaries
+// once, so each test uses a context of its own
+class ZstdDictionaryTest : public ::testing::Test {
+public:
+  static constexpr int32_t dict_id = 4242;
+  std::string dir;
+  CephContext *cct = nullptr;
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/test_zstd_dict.XXXXXX";
+    ASSERT_TRUE(mkdtemp(tmpl));
+    dir = tmpl;
+    bufferlist bl;
+    bl.append((char*)zstd_dict_a, sizeof(zstd_dict_a));
+    ASSERT_EQ(0, bl.write_file((dir + "/dict.4242").c_str()));
+
+    cct = (new CephContext(CEPH_ENTITY_TYPE_CLIENT))->get();
+    cct->_conf.set_val("plugin_dir", g_conf().get_val<std::string>("plugin_dir"));
+    cct->_conf.set_val("compressor_zstd_dict_dir", dir);
+    cct->_conf.apply_changes(nullptr);
+  }
+  void TearDown() override {
+    if (cct) {
+      cct->put();
+    }
+    ::unlink((dir + "/dict.4242").c_str());
+    ::rmdir(dir.c_str());
+  }
+
+  static bufferlist make_document() {
+    bufferlist bl;
+    for (int i = 0; i < 100; i++) {
+      bl.append("{\"pool\":\"bucket-" + std::to_string(i) +
+		"\",\"owner\":\"osd-" + std::to_string(i % 7) +
+		"\",\"version\":\"epoch-" + std::to_string(i * 3) + "\"}");
+    }
+    return bl;
+  }
+};
+
+TEST_F(ZstdDictionaryTest, round_trip)
+{
+  CompressorRef zstd = Compressor::create(cct, "zstd");
+  ASSERT_TRUE(zstd);
+  bufferlist in = make_document();
+
+  std::optional<int32_t> compressor_message = dict_id;
+  bufferlist out;
+  ASSERT_EQ(0, zstd->compress(in, out, compressor_message));
+  ASSERT_TRUE(compressor_message);
+  EXPECT_EQ(dict_id, *compressor_message);
+
+  bufferlist after;
+  ASSERT_EQ(0, zstd->decompress(out, after, compressor_message));
+  EXPECT_TRUE(in.contents_equal(after));
+
+  // the dictionary helps on data that looks like what it was trained on
+  std::optional<int32_t> no_dict = 0;
+  bufferlist plain;
+  ASSERT_EQ(0, zstd->compress(in, plain, no_dict));
+  EXPECT_FALSE(no_dict);
+  EXPECT_LT(out.length(), plain.length());
+}
+
+TEST_F(ZstdDictionaryTest, dictionary_from_frame)
+{
+  cct->_conf.set_val("compressor_zstd_dict_id", std::to_string(dict_id));
+  cct->_conf.apply_changes(nullptr);
+  CompressorRef zstd = Compressor::create(cct, "zstd");
+  ASSERT_TRUE(zstd);
+  bufferlist in = make_document();
+
+  // compressor_zstd_dict_id applies when the caller doesn't pick one
+  std::optional<int32_t> compressor_message;
+  bufferlist out;
+  ASSERT_EQ(0, zstd->compress(in, out, compressor_message));
+  ASSERT_TRUE(compressor_message);
+  EXPECT_EQ(dict_id, *compressor_message);
+
+  // without compressor_message, like msgr does, the dictionary id is taken
+  // from the zstd frame header
+  bufferlist after;
+  ASSERT_EQ(0, zstd->decompress(out, after, std::nullopt));
+  EXPECT_TRUE(in.contents_equal(after));
+
+  // and a compressor that doesn't have it loaded refuses the data
+  CompressorRef other = Compressor::create(g_ceph_context, "zstd");
+  ASSERT_TRUE(other);
+  after.clear();
+  EXPECT_EQ(-ENOENT, other->decompress(out, after, std::nullopt));
+}
+
 #if defined(__x86_64__) || defined(__aarch64__)
 
 TEST(ZlibCompressor, zlib_isal_compatibility)
@@ -0,0 +1,130 @@
+static const unsigned char zstd_dict_a[] = {
+0x37,0xa4,0x30,0xec,0x92,0x10,0x0,0x0,0x1a,0x10,0xd8,0x41,0xa,0xe9,0xc,0xc3,
+0x30,0xc,0x83,0x93,0x14,0xe6,0x34,0x4c,0x0,0x99,0xa4,0x4c,0x49,0xca,0x5e,0x70,
+0x87,0x52,0x2,0xf3,0x0,0x0,0x0,0x12,0x8b,0xa,0xc8,0x95,0xab,0x19,0x0,0x0,
+0x4,0x0,0xc6,0xc,0x16,0x7,0xa2,0x90,0x16,0x51,0x6b,0xe4,0x91,0x96,0x42,0xc8,
+0x10,0x3,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+0x0,0xe4,0x10,0x67,0xca,0xf7,0x4,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0,
+0x0,0x0,0x0,0x0,0x1,0x0,0x0,0x0,0x4,0x0,0x0,0x0,0x8,0x0,0x0,0x0,
+0x74,0x2d,0x34,0x34,0x33,0x22,0x2c,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x22,
+0x3a,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x2d,0x34,0x39,0x22,0x2c,0x22,0x6d,0x74,
+0x69,0x6d,0x65,0x22,0x3a,0x22,0x6f,0x77,0x6e,0x65,0x72,0x2d,0x32,0x35,0x33,0x22,
+0x2c,0x22,0x70,0x6c,0x61,0x63,0x65,0x6d,0x65,0x6e,0x74,0x22,0x3a,0x22,0x6f,0x62,
+0x6a,0x65,0x63,0x74,0x2d,0x36,0x39,0x38,0x22,0x7d,0x7b,0x22,0x6d,0x74,0x69,0x6d,
+0x65,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,0x65,0x2d,0x38,0x34,0x30,0x22,0x2c,0x22,
+0x65,0x70,0x6f,0x63,0x68,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,0x65,0x2d,0x37,0x33,
+0x30,0x22,0x2c,0x22,0x70,0x6c,0x61,0x63,0x65,0x6d,0x65,0x6e,0x74,0x22,0x3a,0x22,
+0x6d,0x74,0x69,0x6d,0x65,0x2d,0x39,0x33,0x33,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,
+0x3a,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,0x2d,0x38,0x36,0x33,0x22,0x2c,0x22,
+0x73,0x6e,0x61,0x70,0x73,0x68,0x6f,0x74,0x22,0x3a,0x22,0x65,0x70,0x6f,0x63,0x68,
+0x2d,0x38,0x32,0x35,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,0x3a,0x22,0x73,0x6e,0x61,
+0x70,0x73,0x68,0x6f,0x74,0x2d,0x35,0x32,0x35,0x22,0x2c,0x22,0x6f,0x77,0x6e,0x65,
+0x72,0x22,0x3a,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x2d,0x38,0x31,0x37,0x22,
+0x2c,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,0x22,0x3a,0x22,0x70,0x6f,0x6f,0x6c,
+0x2d,0x32,0x33,0x38,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,0x3a,0x22,0x76,0x65,0x72,
+0x73,0x69,0x6f,0x6e,0x2d,0x31,0x35,0x38,0x22,0x2c,0x22,0x65,0x70,0x6f,0x63,0x68,
+0x22,0x3a,0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x2d,0x35,0x35,0x37,0x22,0x2c,0x22,
+0x6f,0x62,0x6a,0x65,0x63,0x74,0x22,0x3a,0x22,0x65,0x70,0x6f,0x63,0x68,0x2d,0x39,
+0x35,0x32,0x22,0x2c,0x22,0x65,0x70,0x6f,0x63,0x68,0x22,0x3a,0x22,0x76,0x65,0x72,
+0x73,0x69,0x6f,0x6e,0x2d,0x33,0x39,0x30,0x22,0x7d,0x7b,0x22,0x70,0x6c,0x61,0x63,
+0x65,0x6d,0x65,0x6e,0x74,0x22,0x3a,0x22,0x6f,0x73,0x64,0x2d,0x33,0x36,0x39,0x22,
+0x2c,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,
+0x65,0x2d,0x31,0x34,0x31,0x22,0x2c,0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x22,0x3a,
+0x22,0x70,0x6c,0x61,0x63,0x65,0x6d,0x65,0x6e,0x74,0x2d,0x38,0x39,0x39,0x22,0x2c,
+0x22,0x65,0x70,0x6f,0x63,0x68,0x22,0x3a,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,
+0x2d,0x36,0x30,0x38,0x22,0x2c,0x22,0x70,0x6f,0x6f,0x6c,0x22,0x3a,0x22,0x76,0x65,
+0x72,0x73,0x69,0x6f,0x6e,0x38,0x39,0x30,0x22,0x2c,0x22,0x6f,0x62,0x6a,0x65,0x63,
+0x74,0x22,0x3a,0x22,0x6f,0x73,0x64,0x2d,0x33,0x30,0x22,0x2c,0x22,0x6f,0x73,0x64,
+0x22,0x3a,0x22,0x6f,0x77,0x6e,0x65,0x72,0x2d,0x39,0x32,0x37,0x22,0x2c,0x22,0x62,
+0x75,0x63,0x6b,0x65,0x74,0x22,0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x36,0x31,0x30,
+0x22,0x2c,0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x6f,0x77,0x6e,0x65,0x72,
+0x2d,0x39,0x39,0x37,0x22,0x2c,0x22,0x70,0x6f,0x6f,0x6c,0x22,0x3a,0x22,0x73,0x6e,
+0x61,0x70,0x73,0x68,0x6f,0x74,0x2d,0x37,0x34,0x36,0x22,0x2c,0x22,0x70,0x6f,0x6f,
+0x6c,0x22,0x3a,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x2d,0x32,0x33,0x32,0x22,
+0x2c,0x22,0x73,0x6e,0x61,0x70,0x73,0x68,0x6f,0x74,0x22,0x3a,0x22,0x62,0x75,0x63,
+0x6b,0x65,0x74,0x2d,0x38,0x35,0x37,0x22,0x2c,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,
+0x6e,0x22,0x3a,0x22,0x70,0x6f,0x6f,0x6c,0x2d,0x32,0x32,0x39,0x22,0x2c,0x22,0x62,
+0x75,0x63,0x6b,0x65,0x74,0x22,0x3a,0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x2d,0x31,
+0x36,0x22,0x2c,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x22,0x3a,0x22,0x72,0x65,0x70,
+0x6c,0x69,0x63,0x61,0x2d,0x39,0x33,0x35,0x22,0x7d,0x7b,0x22,0x6f,0x73,0x64,0x22,
+0x3a,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x2d,0x33,0x22,0x2c,0x22,0x76,0x65,0x72,
+0x73,0x69,0x6f,0x6e,0x22,0x3a,0x22,0x6f,0x77,0x6e,0x65,0x72,0x2d,0x36,0x33,0x32,
+0x22,0x2c,0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x22,0x3a,0x22,0x6f,0x62,0x6a,0x65,
+0x63,0x74,0x2d,0x38,0x33,0x22,0x2c,0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,
+0x72,0x65,0x70,0x6c,0x69,0x63,0x61,0x2d,0x31,0x32,0x37,0x22,0x2c,0x22,0x6f,0x77,
+0x6e,0x65,0x72,0x22,0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x35,0x37,0x32,0x22,0x2c,
+0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,
+0x2d,0x34,0x32,0x36,0x22,0x2c,0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x65,
+0x70,0x6f,0x63,0x68,0x2d,0x37,0x36,0x22,0x2c,0x22,0x65,0x70,0x6f,0x63,0x68,0x22,
+0x3a,0x22,0x6f,0x77,0x6e,0x65,0x72,0x2d,0x34,0x36,0x31,0x22,0x2c,0x22,0x70,0x6c,
+0x61,0x63,0x65,0x6d,0x65,0x6e,0x74,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,0x65,0x2d,
+0x37,0x39,0x37,0x22,0x2c,0x22,0x65,0x70,0x6f,0x63,0x68,0x22,0x3a,0x22,0x73,0x6e,
+0x61,0x70,0x73,0x68,0x6f,0x74,0x2d,0x34,0x30,0x37,0x22,0x2c,0x22,0x73,0x69,0x7a,
+0x65,0x22,0x3a,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x2d,0x36,0x32,0x32,0x22,
+0x2c,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x22,0x3a,0x22,0x73,0x6e,0x61,0x70,0x73,
+0x68,0x6f,0x74,0x2d,0x36,0x31,0x38,0x22,0x7d,0x7b,0x22,0x73,0x69,0x7a,0x65,0x22,
+0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x38,0x38,0x36,0x22,0x2c,0x22,0x6d,0x74,0x69,
+0x6d,0x65,0x22,0x3a,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,0x2d,0x31,0x30,0x36,
+0x22,0x2c,0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x22,0x3a,0x22,0x72,0x65,0x70,0x6c,
+0x69,0x63,0x61,0x2d,0x31,0x30,0x38,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,0x6d,0x65,
+0x6e,0x74,0x22,0x3a,0x22,0x65,0x70,0x6f,0x63,0x68,0x2d,0x33,0x30,0x30,0x22,0x2c,
+0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,
+0x2d,0x31,0x36,0x34,0x22,0x2c,0x22,0x6d,0x74,0x69,0x6d,0x65,0x22,0x3a,0x22,0x62,
+0x75,0x63,0x6b,0x65,0x74,0x2d,0x38,0x31,0x30,0x22,0x2c,0x22,0x76,0x65,0x72,0x73,
+0x69,0x6f,0x6e,0x22,0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x31,0x33,0x37,0x22,0x2c,
+0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,0x65,0x2d,0x31,
+0x32,0x22,0x2c,0x22,0x73,0x69,0x7a,0x65,0x22,0x3a,0x22,0x70,0x6f,0x6f,0x6c,0x2d,
+0x34,0x34,0x36,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,0x3a,0x22,0x6f,0x73,0x64,0x2d,
+0x39,0x38,0x33,0x22,0x2c,0x22,0x73,0x6e,0x61,0x70,0x73,0x68,0x6f,0x74,0x22,0x3a,
+0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x2d,0x37,0x22,0x2c,0x22,0x65,0x70,0x6f,0x63,
+0x68,0x22,0x3a,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x2d,0x35,0x36,0x32,0x22,0x2c,
+0x22,0x70,0x6c,0x61,0x63,0x65,0x6d,0x65,0x6e,0x74,0x22,0x3a,0x22,0x76,0x65,0x72,
+0x73,0x69,0x6f,0x6e,0x2d,0x37,0x35,0x32,0x22,0x7d,0x7b,0x22,0x70,0x6f,0x6f,0x6c,
+0x22,0x3a,0x22,0x65,0x70,0x6f,0x63,0x68,0x2d,0x32,0x30,0x33,0x22,0x2c,0x22,0x65,
+0x70,0x6f,0x63,0x68,0x22,0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x35,0x38,0x34,0x22,
+0x2c,0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x70,0x6c,0x61,0x63,0x65,0x6d,
+0x65,0x6e,0x74,0x2d,0x36,0x33,0x31,0x22,0x2c,0x22,0x73,0x69,0x7a,0x65,0x22,0x3a,
+0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x2d,0x31,0x33,0x36,0x22,0x2c,0x22,0x65,0x70,
+0x6f,0x63,0x68,0x22,0x3a,0x22,0x70,0x6f,0x6f,0x6c,0x2d,0x31,0x38,0x22,0x2c,0x22,
+0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x70,0x6f,0x6f,0x6c,0x2d,0x34,0x35,0x31,
+0x22,0x2c,0x22,0x70,0x6f,0x6f,0x6c,0x22,0x3a,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,
+0x61,0x2d,0x35,0x32,0x37,0x22,0x2c,0x22,0x73,0x6e,0x61,0x70,0x73,0x68,0x6f,0x74,
+0x22,0x3a,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,0x2d,0x39,0x39,0x36,0x22,0x2c,
+0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,0x65,0x2d,
+0x36,0x38,0x31,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,
+0x65,0x2d,0x34,0x35,0x31,0x22,0x2c,0x22,0x73,0x69,0x7a,0x65,0x22,0x3a,0x22,0x6f,
+0x73,0x64,0x2d,0x36,0x37,0x37,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,0x3a,0x22,0x65,
+0x70,0x6f,0x63,0x68,0x2d,0x33,0x33,0x39,0x22,0x7d,0x7b,0x22,0x70,0x6f,0x6f,0x6c,
+0x22,0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x33,0x36,0x32,0x22,0x2c,0x22,0x76,0x65,
+0x72,0x73,0x69,0x6f,0x6e,0x22,0x3a,0x22,0x70,0x6f,0x6f,0x6c,0x2d,0x33,0x39,0x34,
+0x22,0x2c,0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x6f,0x62,0x6a,0x65,0x63,
+0x74,0x2d,0x39,0x37,0x32,0x22,0x2c,0x22,0x70,0x6f,0x6f,0x6c,0x22,0x3a,0x22,0x70,
+0x6f,0x6f,0x6c,0x2d,0x35,0x38,0x37,0x22,0x2c,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,
+0x22,0x3a,0x22,0x73,0x6e,0x61,0x70,0x6d,0x65,0x6e,0x74,0x22,0x3a,0x22,0x72,0x65,
+0x70,0x6c,0x69,0x63,0x61,0x2d,0x33,0x39,0x33,0x22,0x2c,0x22,0x70,0x6c,0x61,0x63,
+0x65,0x6d,0x65,0x6e,0x74,0x22,0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x34,0x37,0x38,
+0x22,0x2c,0x22,0x70,0x6f,0x6f,0x6c,0x22,0x3a,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,
+0x2d,0x39,0x37,0x36,0x22,0x2c,0x22,0x62,0x75,0x63,0x6b,0x65,0x74,0x22,0x3a,0x22,
+0x70,0x6c,0x61,0x63,0x65,0x6d,0x65,0x6e,0x74,0x2d,0x32,0x33,0x31,0x22,0x2c,0x22,
+0x6f,0x73,0x64,0x22,0x3a,0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x2d,0x38,0x32,0x30,
+0x22,0x2c,0x22,0x73,0x69,0x7a,0x65,0x22,0x3a,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,
+0x6e,0x2d,0x36,0x33,0x33,0x22,0x2c,0x22,0x6f,0x73,0x64,0x22,0x3a,0x22,0x76,0x65,
+0x72,0x73,0x69,0x6f,0x6e,0x2d,0x34,0x33,0x39,0x22,0x2c,0x22,0x6d,0x74,0x69,0x6d,
+0x65,0x22,0x3a,0x22,0x6f,0x73,0x64,0x2d,0x35,0x39,0x31,0x22,0x2c,0x22,0x62,0x75,
+0x63,0x6b,0x65,0x74,0x22,0x3a,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x2d,0x34,
+0x37,0x31,0x22,0x7d,0x7b,0x22,0x65,0x70,0x6f,0x63,0x68,0x22,0x3a,0x22,0x65,0x70,
+0x6f,0x63,0x68,0x2d,0x35,0x31,0x31,0x22,0x2c,0x22,0x76,0x65,0x72,0x73,0x69,0x6f,
+0x6e,0x22,0x3a,0x22,0x6f,0x73,0x64,0x2d,0x32,0x34,0x31,0x22,0x2c,0x22,0x65,0x70,
+0x6f,0x63,0x68,0x22,0x3a,0x22,0x73,0x69,0x7a,0x65,0x2d,0x34,0x35,0x37,0x22,0x2c,
+0x22,0x6f,0x62,0x6a,0x65,0x63,0x74,0x22,0x3a,0x22,0x6d,0x74,0x69,0x6d,0x65,0x2d,
+0x37,0x38,0x30,0x22,0x2c,0x22,0x65,0x70,0x6f,0x63,0x68,0x22,0x3a,0x22,0x70,0x6f,
+0x6f,0x6c,0x2d,0x31,0x22,0x2c,0x22,0x6d,0x74,0x69,0x6d,0x65,0x22,0x3a,0x22,0x6f,
+0x73,0x64,0x2d,0x38,0x37,0x33,0x22,0x2c,0x22,0x72,0x65,0x70,0x6c,0x69,0x63,0x61,
+0x22,0x3a,0x22,0x6f,0x73,0x64,0x2d,0x31,0x30,0x38,0x22,0x2c,0x22,0x6d,0x74,0x69,
+0x6d,0x65,0x22,0x3a,0x22,0x70,0x6f,0x6f,0x6c,0x2d,0x38,0x39,0x39,0x22,0x2c,0x22,
+0x73,0x6e,0x61,0x70,0x73,0x68,0x6f,0x74,0x22,0x3a,0x22,0x6f,0x73,0x64,0x2d,0x35,
+0x35,0x22,0x2c,0x22,0x6f,0x77,0x6e,0x65,0x72,0x22,0x3a,0x22,0x62,0x75,0x63,0x6b,
+0x65,0x74,0x2d,0x33,0x32,0x33,0x22,0x2c,0x22,0x70,0x6f,0x6f,0x6c,0x22,0x3a,0x22,
+0x6f,0x77,0x6e,0x65,0x72,0x2d,0x38,0x35,0x34,0x22,0x2c,0x22,0x76,0x65,0x72,0x73,
+0x69,0x6f,0x6e,0x22,0x3a,0x22,0x70,0x6c,0x61,0x63,0x65,0x6d,0x65,0x6e,0x74,0x2d
+};
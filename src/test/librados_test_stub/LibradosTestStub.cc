@@ -558,6 +558,13 @@ uint64_t IoCtx::get_last_version() {
   return ctx->get_last_version();
 }
 
+int IoCtx::get_object_pg_hash_position2(const std::string& oid,
+                                        uint32_t *pg_hash_position) {
+  // the in-memory cluster has a single PG per pool
+  *pg_hash_position = 0;
+  return 0;
+}
+
 std::string IoCtx::get_pool_name() {
   TestIoCtxImpl *ctx = reinterpret_cast<TestIoCtxImpl*>(io_ctx_impl);
   return ctx->get_pool_name();
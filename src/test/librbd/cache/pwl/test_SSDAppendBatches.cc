@@ -0,0 +1,90 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "librbd/cache/pwl/ssd/Types.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace librbd {
+namespace cache {
+namespace pwl {
+namespace ssd {
+
+using namespace std;
+
+struct TestSSDAppendBatches : public ::testing::Test {
+  // first free entries the pool root advanced to, in order
+  vector<uint64_t> roots;
+
+  void complete(AppendBatches& batches, uint64_t seq,
+                uint64_t first_free_entry) {
+    batches.complete(seq, first_free_entry, nullptr,
+      [this](uint64_t first_free_entry, Context *ctx) {
+        roots.push_back(first_free_entry);
+      });
+  }
+};
+
+TEST_F(TestSSDAppendBatches, InOrder) {
+  AppendBatches batches(2);
+  ASSERT_EQ(1U, batches.start());
+  ASSERT_EQ(2U, batches.start());
+  ASSERT_FALSE(batches.can_start());
+
+  complete(batches, 1, 10);
+  ASSERT_EQ(vector<uint64_t>{10}, roots);
+  ASSERT_TRUE(batches.can_start());
+  complete(batches, 2, 20);
+  ASSERT_EQ((vector<uint64_t>{10, 20}), roots);
+  ASSERT_EQ(0U, batches.get_in_flight());
+}
+
+TEST_F(TestSSDAppendBatches, OutOfOrder) {
+  AppendBatches batches(4);
+  for (uint64_t seq = 1; seq <= 3; seq++) {
+    ASSERT_EQ(seq, batches.start());
+  }
+
+  // batch 2 and 3 complete before batch 1: the root doesn't advance over
+  // them, and they still count as in flight
+  complete(batches, 3, 30);
+  complete(batches, 2, 20);
+  ASSERT_TRUE(roots.empty());
+  ASSERT_EQ(3U, batches.get_in_flight());
+
+  // until batch 1 completes, then it advances over all of them in order
+  complete(batches, 1, 10);
+  ASSERT_EQ((vector<uint64_t>{10, 20, 30}), roots);
+  ASSERT_EQ(0U, batches.get_in_flight());
+
+  // and the following batches are still ordered
+  ASSERT_EQ(4U, batches.start());
+  ASSERT_EQ(5U, batches.start());
+  complete(batches, 5, 50);
+  ASSERT_EQ(3U, roots.size());
+  complete(batches, 4, 40);
+  ASSERT_EQ((vector<uint64_t>{10, 20, 30, 40, 50}), roots);
+}
+
+TEST_F(TestSSDAppendBatches, Gap) {
+  AppendBatches batches(4);
+  for (uint64_t seq = 1; seq <= 4; seq++) {
+    ASSERT_EQ(seq, batches.start());
+  }
+  ASSERT_FALSE(batches.can_start());
+
+  // batch 3 is held back by batch 2, but not batch 1
+  complete(batches, 1, 10);
+  complete(batches, 3, 30);
+  complete(batches, 4, 40);
+  ASSERT_EQ(vector<uint64_t>{10}, roots);
+  ASSERT_TRUE(batches.can_start());
+
+  complete(batches, 2, 20);
+  ASSERT_EQ((vector<uint64_t>{10, 20, 30, 40}), roots);
+}
+
+} // namespace ssd
+} // namespace pwl
+} // namespace cache
+} // namespace librbd
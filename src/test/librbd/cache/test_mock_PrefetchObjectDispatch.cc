@@ -0,0 +1,206 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "test/librbd/test_mock_fixture.h"
+#include "test/librbd/test_support.h"
+#include "test/librbd/mock/MockImageCtx.h"
+#include "include/rbd/librbd.hpp"
+#include "librbd/cache/PrefetchObjectDispatch.h"
+#include "librbd/io/ObjectDispatchSpec.h"
+
+namespace librbd {
+namespace {
+
+struct MockTestImageCtx : public MockImageCtx {
+  MockTestImageCtx(ImageCtx &image_ctx) : MockImageCtx(image_ctx) {
+  }
+};
+
+} // anonymous namespace
+} // namespace librbd
+
+#include "librbd/cache/PrefetchObjectDispatch.cc"
+
+namespace librbd {
+namespace cache {
+
+using ::testing::_;
+using ::testing::Invoke;
+
+struct TestMockCachePrefetchObjectDispatch : public TestMockFixture {
+  typedef PrefetchObjectDispatch<librbd::MockTestImageCtx>
+    MockPrefetchObjectDispatch;
+
+  TestMockCachePrefetchObjectDispatch() {
+    EXPECT_EQ(0, _rados.conf_set("rbd_prefetch_cache_size", "1048576"));
+    EXPECT_EQ(0, _rados.conf_set("rbd_prefetch_trigger_requests", "1"));
+    EXPECT_EQ(0, _rados.conf_set("rbd_prefetch_min_bytes", "4096"));
+    EXPECT_EQ(0, _rados.conf_set("rbd_prefetch_max_bytes", "8192"));
+  }
+
+  void expect_prefetch(MockTestImageCtx &mock_image_ctx, uint64_t object_no,
+                       uint64_t object_off, uint64_t object_len,
+                       io::ObjectDispatchSpec** spec) {
+    EXPECT_CALL(*mock_image_ctx.io_object_dispatcher, send(_))
+      .WillOnce(Invoke([object_no, object_off, object_len, spec]
+                       (io::ObjectDispatchSpec* s) {
+                  auto read = boost::get<io::ObjectDispatchSpec::ReadRequest>(
+                    &s->request);
+                  ASSERT_TRUE(read != nullptr);
+                  ASSERT_EQ(object_no, read->object_no);
+                  ASSERT_EQ(1U, read->extents->size());
+                  ASSERT_EQ(object_off, read->extents->front().offset);
+                  ASSERT_EQ(object_len, read->extents->front().length);
+                  *spec = s;
+                }));
+  }
+
+  void complete_prefetch(io::ObjectDispatchSpec* spec, char c) {
+    auto read = boost::get<io::ObjectDispatchSpec::ReadRequest>(
+      &spec->request);
+    auto& extent = read->extents->front();
+    extent.bl.append(std::string(extent.length, c));
+    spec->dispatch_result = io::DISPATCH_RESULT_COMPLETE;
+    spec->dispatcher_ctx.complete(0);
+  }
+
+  bool read(MockPrefetchObjectDispatch &dispatch,
+            MockTestImageCtx &mock_image_ctx, uint64_t object_off,
+            uint64_t object_len, io::ReadExtents* extents,
+            C_SaferCond* on_dispatched) {
+    extents->clear();
+    extents->emplace_back(object_off, object_len);
+    Context* on_finish = nullptr;
+    io::DispatchResult dispatch_result;
+    int object_dispatch_flags = 0;
+    return dispatch.read(
+      0, extents, mock_image_ctx.get_data_io_context(), 0, 0, {}, nullptr,
+      &object_dispatch_flags, &dispatch_result, &on_finish, on_dispatched);
+  }
+
+  bool write(MockPrefetchObjectDispatch &dispatch,
+             MockTestImageCtx &mock_image_ctx, uint64_t object_off,
+             uint64_t object_len, Context** on_finish) {
+    ceph::bufferlist data;
+    data.append(std::string(object_len, 'b'));
+    int object_dispatch_flags = 0;
+    uint64_t journal_tid;
+    io::DispatchResult dispatch_result;
+    return dispatch.write(
+      0, object_off, std::move(data), mock_image_ctx.get_data_io_context(), 0,
+      0, std::nullopt, {}, &object_dispatch_flags, &journal_tid,
+      &dispatch_result, on_finish, nullptr);
+  }
+};
+
+TEST_F(TestMockCachePrefetchObjectDispatch, SequentialHit) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  expect_op_work_queue(mock_image_ctx);
+  MockPrefetchObjectDispatch dispatch(&mock_image_ctx);
+
+  io::ReadExtents extents;
+  C_SaferCond cond1;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 0, 4096, &extents, &cond1));
+
+  io::ObjectDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 0, 8192, 4096, &spec);
+  C_SaferCond cond2;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 4096, 4096, &extents, &cond2));
+  ASSERT_TRUE(spec != nullptr);
+  complete_prefetch(spec, 'a');
+
+  // the window grows on a hit so the next prefetch is issued as well
+  expect_prefetch(mock_image_ctx, 0, 12288, 8192, &spec);
+  C_SaferCond cond3;
+  ASSERT_TRUE(read(dispatch, mock_image_ctx, 8192, 4096, &extents, &cond3));
+  ASSERT_EQ(0, cond3.wait());
+  ASSERT_EQ(std::string(4096, 'a'), extents.front().bl.to_str());
+
+  C_SaferCond on_shut_down;
+  dispatch.shut_down(&on_shut_down);
+  complete_prefetch(spec, 'b');
+  ASSERT_EQ(0, on_shut_down.wait());
+}
+
+TEST_F(TestMockCachePrefetchObjectDispatch, WriteInvalidates) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockPrefetchObjectDispatch dispatch(&mock_image_ctx);
+
+  io::ReadExtents extents;
+  C_SaferCond cond1;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 0, 4096, &extents, &cond1));
+
+  io::ObjectDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 0, 8192, 4096, &spec);
+  C_SaferCond cond2;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 4096, 4096, &extents, &cond2));
+  ASSERT_TRUE(spec != nullptr);
+
+  // a write racing with the prefetch must not leave stale data behind
+  C_SaferCond write_finish;
+  Context* on_finish = &write_finish;
+  ASSERT_FALSE(write(dispatch, mock_image_ctx, 8192, 4096, &on_finish));
+  complete_prefetch(spec, 'a');
+
+  expect_prefetch(mock_image_ctx, 0, 12288, 4096, &spec);
+  C_SaferCond cond3;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 8192, 4096, &extents, &cond3));
+  complete_prefetch(spec, 'a');
+
+  on_finish->complete(0);
+  ASSERT_EQ(0, write_finish.wait());
+
+  C_SaferCond on_shut_down;
+  dispatch.shut_down(&on_shut_down);
+  ASSERT_EQ(0, on_shut_down.wait());
+}
+
+TEST_F(TestMockCachePrefetchObjectDispatch, PrefetchCompletesDuringWrite) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockPrefetchObjectDispatch dispatch(&mock_image_ctx);
+
+  io::ReadExtents extents;
+  C_SaferCond cond1;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 0, 4096, &extents, &cond1));
+
+  io::ObjectDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 0, 8192, 4096, &spec);
+  C_SaferCond cond2;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 4096, 4096, &extents, &cond2));
+  ASSERT_TRUE(spec != nullptr);
+
+  // the prefetch completes after the write was dispatched but before it
+  // completed, so it may hold either the old or the new data
+  C_SaferCond write_finish;
+  Context* on_finish = &write_finish;
+  ASSERT_FALSE(write(dispatch, mock_image_ctx, 8192, 8192, &on_finish));
+  complete_prefetch(spec, 'a');
+
+  // neither is it cached nor is the rest of the written extent prefetched
+  // while the write is in flight
+  EXPECT_CALL(*mock_image_ctx.io_object_dispatcher, send(_)).Times(0);
+  C_SaferCond cond3;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 8192, 4096, &extents, &cond3));
+
+  on_finish->complete(0);
+  ASSERT_EQ(0, write_finish.wait());
+
+  C_SaferCond cond4;
+  ASSERT_FALSE(read(dispatch, mock_image_ctx, 8192, 4096, &extents, &cond4));
+
+  C_SaferCond on_shut_down;
+  dispatch.shut_down(&on_shut_down);
+  ASSERT_EQ(0, on_shut_down.wait());
+}
+
+} // namespace cache
+} // namespace librbd
@@ -0,0 +1,163 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Measure how long it takes to compute the diff of an image.
+ *
+ * Run against an existing image (e.g. on a vstart cluster) after writing
+ * some data between snapshots.  The diff is computed the same way as
+ * "rbd export-diff" and "rbd diff" do, and the tool reports the elapsed time
+ * together with the number and size of the changed extents.  Use
+ * --rbd_concurrent_diff_ops to compare different concurrency levels.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "common/ceph_argparse.h"
+#include "common/ceph_time.h"
+#include "common/common_init.h"
+#include "common/errno.h"
+#include "global/global_init.h"
+#include "include/rados/librados.hpp"
+#include "include/rbd/librbd.hpp"
+
+using namespace std;
+
+static void usage()
+{
+  cout << "usage: ceph_test_librbd_diff_iterate_bench [options] <image>\n"
+       << "  --pool <name>          pool to use (default: rbd)\n"
+       << "  --from-snap <name>     compute the diff since this snapshot\n"
+       << "  --snap <name>          compute the diff up to this snapshot\n"
+       << "  --whole-object         compare whole objects\n"
+       << "  --no-parent            don't include parent data\n"
+       << "  --iterations <n>       number of runs (default: 3)\n"
+       << std::endl;
+  generic_client_usage();
+}
+
+struct DiffStats {
+  uint64_t extents = 0;
+  uint64_t data_bytes = 0;
+  uint64_t zero_bytes = 0;
+};
+
+static int diff_cb(uint64_t off, size_t len, int exists, void *arg)
+{
+  auto stats = static_cast<DiffStats*>(arg);
+  ++stats->extents;
+  if (exists) {
+    stats->data_bytes += len;
+  } else {
+    stats->zero_bytes += len;
+  }
+  return 0;
+}
+
+int main(int argc, const char **argv)
+{
+  auto args = argv_to_vec(argc, argv);
+  if (ceph_argparse_need_usage(args)) {
+    usage();
+    exit(0);
+  }
+
+  string pool = "rbd";
+  string from_snap;
+  string snap;
+  bool whole_object = false;
+  bool include_parent = true;
+  unsigned iterations = 3;
+  string val;
+  for (auto i = args.begin(); i != args.end(); ) {
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_witharg(args, i, &val, "--pool", (char*)NULL)) {
+      pool = val;
+    } else if (ceph_argparse_witharg(args, i, &val, "--from-snap", (char*)NULL)) {
+      from_snap = val;
+    } else if (ceph_argparse_witharg(args, i, &val, "--snap", (char*)NULL)) {
+      snap = val;
+    } else if (ceph_argparse_flag(args, i, "--whole-object", (char*)NULL)) {
+      whole_object = true;
+    } else if (ceph_argparse_flag(args, i, "--no-parent", (char*)NULL)) {
+      include_parent = false;
+    } else if (ceph_argparse_witharg(args, i, &val, "--iterations", (char*)NULL)) {
+      iterations = std::max(1, atoi(val.c_str()));
+    } else {
+      ++i;
+    }
+  }
+
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+
+  if (args.size() != 1) {
+    usage();
+    return 1;
+  }
+  string image_name = args[0];
+
+  librados::Rados rados;
+  int r = rados.init_with_context(g_ceph_context);
+  if (r < 0) {
+    cerr << "failed to initialize rados: " << cpp_strerror(r) << std::endl;
+    return 1;
+  }
+  r = rados.connect();
+  if (r < 0) {
+    cerr << "failed to connect: " << cpp_strerror(r) << std::endl;
+    return 1;
+  }
+  librados::IoCtx ioctx;
+  r = rados.ioctx_create(pool.c_str(), ioctx);
+  if (r < 0) {
+    cerr << "failed to open pool " << pool << ": " << cpp_strerror(r)
+	 << std::endl;
+    return 1;
+  }
+
+  librbd::RBD rbd;
+  librbd::Image image;
+  r = rbd.open_read_only(ioctx, image, image_name.c_str(),
+			 snap.empty() ? nullptr : snap.c_str());
+  if (r < 0) {
+    cerr << "failed to open image " << image_name << ": " << cpp_strerror(r)
+	 << std::endl;
+    return 1;
+  }
+  uint64_t size;
+  r = image.size(&size);
+  if (r < 0) {
+    cerr << "failed to get image size: " << cpp_strerror(r) << std::endl;
+    return 1;
+  }
+
+  for (unsigned i = 0; i < iterations; ++i) {
+    DiffStats stats;
+    auto start = ceph::mono_clock::now();
+    r = image.diff_iterate2(from_snap.empty() ? nullptr : from_snap.c_str(),
+			    0, size, include_parent, whole_object, diff_cb,
+			    &stats);
+    double elapsed = std::chrono::duration<double>(
+      ceph::mono_clock::now() - start).count();
+    if (r < 0) {
+      cerr << "diff failed: " << cpp_strerror(r) << std::endl;
+      return 1;
+    }
+    cout << "run " << i << " elapsed " << elapsed << " sec"
+	 << " extents " << stats.extents
+	 << " data_bytes " << stats.data_bytes
+	 << " zero_bytes " << stats.zero_bytes
+	 << " scanned " << (elapsed > 0 ? size / elapsed / (1 << 20) : 0)
+	 << " MiB/sec" << std::endl;
+  }
+
+  image.close();
+  ioctx.close();
+  rados.shutdown();
+  return 0;
+}
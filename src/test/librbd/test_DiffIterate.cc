@@ -0,0 +1,82 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "test/librbd/test_fixture.h"
+#include "test/librbd/test_support.h"
+#include "librbd/api/DiffIterate.h"
+#include "librbd/object_map/Types.h"
+
+namespace librbd {
+
+class TestDiffIterate : public TestFixture {
+public:
+  typedef api::DiffIterate<> DiffIterate;
+
+  void SetUp() override {
+    TestFixture::SetUp();
+    m_cct = reinterpret_cast<CephContext*>(m_ioctx.cct());
+
+    // two objects per stripe period
+    m_layout.stripe_unit = 1 << 20;
+    m_layout.stripe_count = 2;
+    m_layout.object_size = 1 << 22;
+    m_layout.pool_id = 1;
+
+    m_object_diff_state.resize(4);
+    for (uint64_t object_no = 0; object_no < 4; ++object_no) {
+      m_object_diff_state[object_no] = object_map::DIFF_STATE_DATA;
+    }
+  }
+
+  bool is_period_unchanged(uint64_t period_no, bool parent_overlap) {
+    uint64_t period = 8 << 20;
+    return DiffIterate::is_extent_unchanged(m_cct, m_layout,
+                                            period_no * period, period,
+                                            m_object_diff_state,
+                                            parent_overlap);
+  }
+
+  CephContext *m_cct;
+  file_layout_t m_layout;
+  BitVector<2> m_object_diff_state;
+};
+
+TEST_F(TestDiffIterate, UnchangedData) {
+  ASSERT_TRUE(is_period_unchanged(0, false));
+  ASSERT_TRUE(is_period_unchanged(1, false));
+  ASSERT_TRUE(is_period_unchanged(0, true));
+  ASSERT_TRUE(is_period_unchanged(1, true));
+}
+
+TEST_F(TestDiffIterate, UpdatedObject) {
+  m_object_diff_state[3] = object_map::DIFF_STATE_DATA_UPDATED;
+  ASSERT_TRUE(is_period_unchanged(0, false));
+  ASSERT_FALSE(is_period_unchanged(1, false));
+
+  m_object_diff_state[3] = object_map::DIFF_STATE_DATA;
+  m_object_diff_state[0] = object_map::DIFF_STATE_HOLE_UPDATED;
+  ASSERT_FALSE(is_period_unchanged(0, false));
+  ASSERT_TRUE(is_period_unchanged(1, false));
+}
+
+TEST_F(TestDiffIterate, Hole) {
+  m_object_diff_state[1] = object_map::DIFF_STATE_HOLE;
+  m_object_diff_state[2] = object_map::DIFF_STATE_HOLE;
+  m_object_diff_state[3] = object_map::DIFF_STATE_HOLE;
+  ASSERT_TRUE(is_period_unchanged(0, false));
+  ASSERT_TRUE(is_period_unchanged(1, false));
+}
+
+TEST_F(TestDiffIterate, HoleParentOverlap) {
+  m_object_diff_state[1] = object_map::DIFF_STATE_HOLE;
+  ASSERT_FALSE(is_period_unchanged(0, true));
+  ASSERT_TRUE(is_period_unchanged(1, true));
+}
+
+TEST_F(TestDiffIterate, BeyondObjectMap) {
+  m_object_diff_state.resize(3);
+  ASSERT_TRUE(is_period_unchanged(0, false));
+  ASSERT_FALSE(is_period_unchanged(1, false));
+}
+
+} // namespace librbd
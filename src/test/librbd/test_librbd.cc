@@ -6623,6 +6623,136 @@ TYPED_TEST(DiffIterateTest, DiffIterateIgnoreParent)
   ASSERT_TRUE(two.subset_of(diff));
 }
 
+TYPED_TEST(DiffIterateTest, DiffIterateUnchangedObjects)
+{
+  librados::IoCtx ioctx;
+  ASSERT_EQ(0, this->_rados.ioctx_create(this->m_pool_name.c_str(), ioctx));
+
+  {
+    librbd::RBD rbd;
+    librbd::Image image;
+    int order = 22;
+    std::string name = this->get_temp_image_name();
+    ssize_t size = 16 << 20;
+
+    ASSERT_EQ(0, create_image_pp(rbd, ioctx, name.c_str(), size, &order));
+    ASSERT_EQ(0, rbd.open(ioctx, image, name.c_str(), NULL));
+
+    ceph::bufferlist bl;
+    bl.append(std::string(size, '1'));
+    ASSERT_EQ(size, image.write(0, size, bl));
+    ASSERT_EQ(0, image.snap_create("snap"));
+
+    ceph::bufferlist bl2;
+    bl2.append(std::string(4096, '2'));
+    ASSERT_EQ(4096, image.write(8388608, 4096, bl2));
+
+    // objects left untouched since the snapshot must not be reported
+    // whether or not the object map diff lets them be skipped
+    for (bool fast_diff : {true, false}) {
+      uint64_t features;
+      ASSERT_EQ(0, image.features(&features));
+      if (!fast_diff && (features & RBD_FEATURE_FAST_DIFF) != 0) {
+        ASSERT_EQ(0, image.update_features(RBD_FEATURE_FAST_DIFF, false));
+      } else if (fast_diff && (features & RBD_FEATURE_FAST_DIFF) == 0) {
+        continue;
+      }
+
+      std::vector<diff_extent> extents;
+      ASSERT_EQ(0, image.diff_iterate2("snap", 0, size, true,
+                                       this->whole_object, vector_iterate_cb,
+                                       &extents));
+      ASSERT_EQ(1u, extents.size());
+      if (this->whole_object) {
+        ASSERT_EQ(diff_extent(8388608, 4194304, true, 4194304), extents[0]);
+      } else {
+        ASSERT_EQ(diff_extent(8388608, 4096, true, 0), extents[0]);
+      }
+    }
+
+    ASSERT_PASSED(this->validate_object_map, image);
+  }
+
+  ioctx.close();
+}
+
+TYPED_TEST(DiffIterateTest, DiffIterateParentOverlapHoles)
+{
+  REQUIRE_FEATURE(RBD_FEATURE_LAYERING);
+
+  librados::IoCtx ioctx;
+  ASSERT_EQ(0, this->_rados.ioctx_create(this->m_pool_name.c_str(), ioctx));
+
+  {
+    librbd::RBD rbd;
+    librbd::Image image;
+    int order = 22;
+    std::string name = this->get_temp_image_name();
+    ssize_t size = 16 << 20;
+
+    ASSERT_EQ(0, create_image_pp(rbd, ioctx, name.c_str(), size, &order));
+    ASSERT_EQ(0, rbd.open(ioctx, image, name.c_str(), NULL));
+
+    uint64_t features;
+    ASSERT_EQ(0, image.features(&features));
+    uint64_t object_size = 0;
+    if (this->whole_object) {
+      object_size = 1 << order;
+    }
+
+    ceph::bufferlist bl;
+    bl.append(std::string(size, '1'));
+    ASSERT_EQ(size, image.write(0, size, bl));
+    ASSERT_EQ(0, image.snap_create("snap"));
+    ASSERT_EQ(0, image.snap_protect("snap"));
+
+    std::string clone_name = this->get_temp_image_name();
+    ASSERT_EQ(0, rbd.clone(ioctx, name.c_str(), "snap", ioctx,
+                           clone_name.c_str(), features, &order));
+    librbd::Image clone;
+    ASSERT_EQ(0, rbd.open(ioctx, clone, clone_name.c_str(), NULL));
+
+    ceph::bufferlist bl2;
+    bl2.append(std::string(4096, '2'));
+    ASSERT_EQ(4096, clone.write(4194304, 4096, bl2));
+
+    // holes in the clone still expose parent data within the overlap and
+    // must not be skipped, while the written object is always reported
+    for (bool fast_diff : {true, false}) {
+      ASSERT_EQ(0, clone.features(&features));
+      if (!fast_diff && (features & RBD_FEATURE_FAST_DIFF) != 0) {
+        ASSERT_EQ(0, clone.update_features(RBD_FEATURE_FAST_DIFF, false));
+      } else if (fast_diff && (features & RBD_FEATURE_FAST_DIFF) == 0) {
+        continue;
+      }
+
+      std::vector<diff_extent> extents;
+      ASSERT_EQ(0, clone.diff_iterate2(NULL, 0, size, true,
+                                       this->whole_object, vector_iterate_cb,
+                                       &extents));
+      ASSERT_EQ(4u, extents.size());
+      ASSERT_EQ(diff_extent(0, 4194304, true, object_size), extents[0]);
+      ASSERT_EQ(diff_extent(4194304, 4194304, true, object_size), extents[1]);
+      ASSERT_EQ(diff_extent(8388608, 4194304, true, object_size), extents[2]);
+      ASSERT_EQ(diff_extent(12582912, 4194304, true, object_size),
+                extents[3]);
+      extents.clear();
+
+      // without the parent the holes are unchanged and skipped
+      ASSERT_EQ(0, clone.diff_iterate2(NULL, 0, size, false,
+                                       this->whole_object, vector_iterate_cb,
+                                       &extents));
+      ASSERT_EQ(1u, extents.size());
+      ASSERT_EQ(diff_extent(4194304, 4194304, true, object_size), extents[0]);
+    }
+
+    ASSERT_PASSED(this->validate_object_map, image);
+    ASSERT_PASSED(this->validate_object_map, clone);
+  }
+
+  ioctx.close();
+}
+
 TYPED_TEST(DiffIterateTest, DiffIterateCallbackError)
 {
   librados::IoCtx ioctx;
@@ -1582,6 +1582,69 @@ TEST_P(StoreTestSpecificAUSize, ReproBug41901Test) {
 }
 
 
+TEST_P(StoreTestSpecificAUSize, CompressedBlobReadCache) {
+  if(string(GetParam()) != "bluestore")
+    return;
+  if (smr) {
+    cout << "SKIP (smr)" << std::endl;
+    return;
+  }
+  StartDeferred(0x1000);
+  auto settingsBookmark = BookmarkSettings();
+  SetVal(g_conf(), "bluestore_compression_mode", "force");
+  SetVal(g_conf(), "bluestore_default_buffered_read", "false");
+  SetVal(g_conf(), "bluestore_default_buffered_write", "false");
+  SetVal(g_conf(), "bluestore_cache_decompressed_blobs", "true");
+  g_conf().apply_changes(nullptr);
+
+  int r;
+  coll_t cid;
+  ghobject_t hoid(hobject_t(sobject_t("Object 1", CEPH_NOSNAP)));
+  const PerfCounters* logger = store->get_perf_counters();
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  bufferlist orig;
+  orig.append(string(0x10000, 'a'));
+  {
+    ObjectStore::Transaction t;
+    t.write(cid, hoid, 0, orig.length(), orig);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  uint64_t avoided = logger->get(l_bluestore_decompress_avoided_bytes);
+  {
+    // first read decompresses the blob and keeps it around
+    bufferlist bl, expected;
+    r = store->read(ch, hoid, 0, 0x1000, bl);
+    ASSERT_EQ(r, 0x1000);
+    expected.substr_of(orig, 0, 0x1000);
+    ASSERT_TRUE(bl_eq(expected, bl));
+    ASSERT_EQ(avoided, logger->get(l_bluestore_decompress_avoided_bytes));
+  }
+  {
+    // the next one is served from the cache
+    bufferlist bl, expected;
+    r = store->read(ch, hoid, 0x1000, 0x1000, bl);
+    ASSERT_EQ(r, 0x1000);
+    expected.substr_of(orig, 0x1000, 0x1000);
+    ASSERT_TRUE(bl_eq(expected, bl));
+    ASSERT_EQ(avoided + 0x1000,
+	      logger->get(l_bluestore_decompress_avoided_bytes));
+  }
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTestSpecificAUSize, BluestoreStatFSTest) {
   if(string(GetParam()) != "bluestore")
     return;
@@ -1111,6 +1111,63 @@ TEST(BlueFS, truncate_fsync) {
   }
 }
 
+TEST(BlueFS, wal_size_to_allocation) {
+  uint64_t size = 1048576 * 128;
+  TempBdev bdev{size};
+
+  ConfSaver conf(g_ceph_context->_conf);
+  conf.SetVal("bluefs_alloc_size", "65536");
+  conf.SetVal("bluefs_wal_size_to_allocation", "true");
+  conf.ApplyChanges();
+
+  const unsigned num_syncs = 100;
+  char data[4096];
+  memset(data, 'a', sizeof(data));
+
+  BlueFS fs(g_ceph_context);
+  ASSERT_EQ(0, fs.add_block_device(BlueFS::BDEV_DB, bdev.path, false, 1048576));
+  uuid_d fsid;
+  ASSERT_EQ(0, fs.mkfs(fsid, { BlueFS::BDEV_DB, false, false }));
+  ASSERT_EQ(0, fs.mount());
+  ASSERT_EQ(0, fs.maybe_verify_layout({ BlueFS::BDEV_DB, false, false }));
+  {
+    BlueFS::FileWriter *h;
+    ASSERT_EQ(0, fs.mkdir("db.wal"));
+    ASSERT_EQ(0, fs.open_for_write("db.wal", "000001.log", &h, false));
+    ASSERT_EQ(0, fs.preallocate(h->file, 0, 1048576));
+    h->append(data, sizeof(data));
+    ASSERT_EQ(0, fs.fsync(h));
+    // appends into preallocated space don't touch the metadata log
+    uint64_t logged = fs.get_perf_counters()->get(l_bluefs_logged_bytes);
+    for (unsigned i = 1; i < num_syncs; ++i) {
+      h->append(data, sizeof(data));
+      ASSERT_EQ(0, fs.fsync(h));
+    }
+    ASSERT_EQ(logged, fs.get_perf_counters()->get(l_bluefs_logged_bytes));
+    fs.close_writer(h);
+  }
+  fs.umount(true);
+
+  ASSERT_EQ(0, fs.mount());
+  {
+    uint64_t file_size;
+    utime_t mtime;
+    ASSERT_EQ(0, fs.stat("db.wal", "000001.log", &file_size, &mtime));
+    ASSERT_GE(file_size, 1048576u);
+
+    BlueFS::FileReader *h;
+    ASSERT_EQ(0, fs.open_for_read("db.wal", "000001.log", &h));
+    bufferlist bl;
+    ASSERT_EQ((int64_t)(num_syncs * sizeof(data)),
+	      fs.read(h, 0, num_syncs * sizeof(data), &bl, NULL));
+    for (unsigned i = 0; i < num_syncs; ++i) {
+      ASSERT_EQ(0, memcmp(data, bl.c_str() + i * sizeof(data), sizeof(data)));
+    }
+    delete h;
+  }
+  fs.umount();
+}
+
 int main(int argc, char **argv) {
   auto args = argv_to_vec(argc, argv);
   map<string,string> defaults = {
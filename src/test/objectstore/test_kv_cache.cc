@@ -0,0 +1,108 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include "common/PriorityCache.h"
+#include "global/global_context.h"
+#include "kv/rocksdb_cache/BinnedLRUCache.h"
+
+using namespace std;
+
+static void noop_deleter(const rocksdb::Slice& key, void* value)
+{
+}
+
+TEST(BinnedLRUCache, hits_and_misses)
+{
+  auto cache = rocksdb_cache::NewBinnedLRUCache(g_ceph_context, 1 << 20, 2,
+                                                false, 0.0);
+  ASSERT_TRUE(cache);
+  auto binned = static_pointer_cast<rocksdb_cache::BinnedLRUCache>(cache);
+  ASSERT_EQ(0u, binned->get_hits());
+  ASSERT_EQ(0u, binned->get_misses());
+
+  // keys spread over the shards
+  static int value;
+  for (int i = 0; i < 10; i++) {
+    string key = "key" + to_string(i);
+    ASSERT_EQ(nullptr, cache->Lookup(key));
+    rocksdb::Cache::Handle* h = nullptr;
+    ASSERT_TRUE(cache->Insert(key, &value, 1, noop_deleter, &h).ok());
+    cache->Release(h);
+  }
+  ASSERT_EQ(0u, binned->get_hits());
+  ASSERT_EQ(10u, binned->get_misses());
+
+  for (int n = 0; n < 3; n++) {
+    for (int i = 0; i < 10; i++) {
+      auto h = cache->Lookup("key" + to_string(i));
+      ASSERT_NE(nullptr, h);
+      cache->Release(h);
+    }
+  }
+  ASSERT_EQ(30u, binned->get_hits());
+  ASSERT_EQ(10u, binned->get_misses());
+
+  // an erased key misses again
+  cache->Erase("key0");
+  ASSERT_EQ(nullptr, cache->Lookup("key0"));
+  ASSERT_EQ(30u, binned->get_hits());
+  ASSERT_EQ(11u, binned->get_misses());
+}
+
+TEST(PriorityCache, balance_by_hits_busiest_gets_more)
+{
+  constexpr int64_t size = 256ul*1024*1024;
+  map<string, PriorityCache::HitShare> shares;
+  shares["kv"] = {0, size, 0, 0.4};
+  shares["kv_onode"] = {0, size, 0, 0.4};
+
+  // the same hits on the same committed size keep the split as it was
+  shares["kv"].hits = 1000;
+  shares["kv_onode"].hits = 1000;
+  PriorityCache::balance_by_hits(0.8, shares);
+  EXPECT_DOUBLE_EQ(0.4, shares["kv"].ratio);
+  EXPECT_DOUBLE_EQ(0.4, shares["kv_onode"].ratio);
+  EXPECT_EQ(1000u, shares["kv"].last_hits);
+
+  // only the hits since the previous balance count
+  for (int i = 0; i < 10; i++) {
+    shares["kv"].hits += 100000;
+    shares["kv_onode"].hits += 100;
+    PriorityCache::balance_by_hits(0.8, shares);
+    EXPECT_NEAR(0.8, shares["kv"].ratio + shares["kv_onode"].ratio, 1e-9);
+  }
+  EXPECT_GT(shares["kv"].ratio, 0.7);
+  // but the idle one keeps about its floor
+  EXPECT_NEAR(0.8 * 0.05 / 2, shares["kv_onode"].ratio, 0.002);
+}
+
+TEST(PriorityCache, balance_by_hits_density)
+{
+  // as many hits on a quarter of the memory is worth four times as much
+  map<string, PriorityCache::HitShare> shares;
+  shares["small"] = {0, 256ul*1024*1024, 0, 0.5};
+  shares["large"] = {0, 1024ul*1024*1024, 0, 0.5};
+  for (int i = 0; i < 20; i++) {
+    shares["small"].hits += 1000000;
+    shares["large"].hits += 1000000;
+    PriorityCache::balance_by_hits(1.0, shares);
+  }
+  EXPECT_NEAR(0.8, shares["small"].ratio, 0.01);
+  EXPECT_NEAR(0.2, shares["large"].ratio, 0.01);
+}
+
+TEST(PriorityCache, balance_by_hits_small_caches)
+{
+  // caches below the minimum size are treated as if they had it, so that a
+  // nearly empty one doesn't grab all the memory with a few hits
+  map<string, PriorityCache::HitShare> shares;
+  shares["empty"] = {10, 0, 0, 0.5};
+  shares["full"] = {10, 64ul*1024*1024, 0, 0.5};
+  PriorityCache::balance_by_hits(1.0, shares);
+  EXPECT_DOUBLE_EQ(0.5, shares["empty"].ratio);
+  EXPECT_DOUBLE_EQ(0.5, shares["full"].ratio);
+}
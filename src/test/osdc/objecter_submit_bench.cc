@@ -0,0 +1,184 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Measure the client side cost of submitting ops through the Objecter.
+ *
+ * A number of threads keep a fixed queue depth of cheap ops (stat) in
+ * flight against a set of pre-created objects and the tool reports the
+ * achieved ops/sec as well as ops per second of client CPU time, which is
+ * what changes when the submission path gets cheaper.
+ */
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/ceph_argparse.h"
+#include "common/ceph_time.h"
+#include "common/common_init.h"
+#include "common/errno.h"
+#include "global/global_init.h"
+#include "include/rados/librados.hpp"
+
+using namespace std;
+
+static void usage()
+{
+  cout << "usage: ceph_test_objecter_submit_bench [options]\n"
+       << "  --pool <name>          pool to use (default: rbd)\n"
+       << "  --objects <n>          number of objects (default: 1024)\n"
+       << "  --threads <n>          submitting threads (default: 8)\n"
+       << "  --queue-depth <n>      ops in flight per thread (default: 16)\n"
+       << "  --seconds <n>          run time (default: 30)\n"
+       << "  --no-setup             don't create the objects\n"
+       << std::endl;
+  generic_client_usage();
+}
+
+static double cpu_seconds()
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0 +
+	 ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+}
+
+static string obj_name(unsigned i)
+{
+  return "objecter_submit_bench_" + to_string(i);
+}
+
+int main(int argc, const char **argv)
+{
+  auto args = argv_to_vec(argc, argv);
+  if (ceph_argparse_need_usage(args)) {
+    usage();
+    exit(0);
+  }
+
+  string pool = "rbd";
+  unsigned num_objects = 1024;
+  unsigned num_threads = 8;
+  unsigned queue_depth = 16;
+  unsigned seconds = 30;
+  bool setup = true;
+  string val;
+  for (auto i = args.begin(); i != args.end(); ) {
+    if (ceph_argparse_double_dash(args, i)) {
+      break;
+    } else if (ceph_argparse_witharg(args, i, &val, "--pool", (char*)NULL)) {
+      pool = val;
+    } else if (ceph_argparse_witharg(args, i, &val, "--objects", (char*)NULL)) {
+      num_objects = std::max(1, atoi(val.c_str()));
+    } else if (ceph_argparse_witharg(args, i, &val, "--threads", (char*)NULL)) {
+      num_threads = std::max(1, atoi(val.c_str()));
+    } else if (ceph_argparse_witharg(args, i, &val, "--queue-depth", (char*)NULL)) {
+      queue_depth = std::max(1, atoi(val.c_str()));
+    } else if (ceph_argparse_witharg(args, i, &val, "--seconds", (char*)NULL)) {
+      seconds = std::max(1, atoi(val.c_str()));
+    } else if (ceph_argparse_flag(args, i, "--no-setup", (char*)NULL)) {
+      setup = false;
+    } else {
+      ++i;
+    }
+  }
+
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+
+  librados::Rados rados;
+  int r = rados.init_with_context(g_ceph_context);
+  if (r < 0) {
+    cerr << "failed to initialize rados: " << cpp_strerror(r) << std::endl;
+    return 1;
+  }
+  r = rados.connect();
+  if (r < 0) {
+    cerr << "failed to connect: " << cpp_strerror(r) << std::endl;
+    return 1;
+  }
+  librados::IoCtx ioctx;
+  r = rados.ioctx_create(pool.c_str(), ioctx);
+  if (r < 0) {
+    cerr << "failed to open pool " << pool << ": " << cpp_strerror(r)
+	 << std::endl;
+    return 1;
+  }
+
+  if (setup) {
+    for (unsigned i = 0; i < num_objects; ++i) {
+      r = ioctx.create(obj_name(i), false);
+      if (r < 0) {
+	cerr << "failed to create " << obj_name(i) << ": " << cpp_strerror(r)
+	     << std::endl;
+	return 1;
+      }
+    }
+  }
+
+  std::atomic<bool> stop = false;
+  std::atomic<uint64_t> completed = 0;
+  std::atomic<int> errors = 0;
+
+  auto complete = [&](librados::AioCompletion *c) {
+    c->wait_for_complete();
+    if (c->get_return_value() < 0) {
+      ++errors;
+    }
+    c->release();
+    ++completed;
+  };
+  auto worker = [&](unsigned id) {
+    std::deque<librados::AioCompletion*> in_flight;
+    unsigned next = id;
+    while (!stop) {
+      while (in_flight.size() < queue_depth) {
+	auto c = librados::Rados::aio_create_completion();
+	int r = ioctx.aio_stat(obj_name(next % num_objects), c,
+			       nullptr, nullptr);
+	ceph_assert(r == 0);
+	next += num_threads;
+	in_flight.push_back(c);
+      }
+      complete(in_flight.front());
+      in_flight.pop_front();
+    }
+    for (auto c : in_flight) {
+      complete(c);
+    }
+  };
+
+  double cpu_start = cpu_seconds();
+  auto start = ceph::mono_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker, i);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  stop = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+  double elapsed = std::chrono::duration<double>(
+    ceph::mono_clock::now() - start).count();
+  double cpu = cpu_seconds() - cpu_start;
+
+  uint64_t ops = completed;
+  cout << "threads " << num_threads << " queue_depth " << queue_depth
+       << " ops " << ops << " errors " << errors << "\n"
+       << "ops/sec " << ops / elapsed << "\n"
+       << "cpu seconds " << cpu << "\n"
+       << "ops/sec per core " << (cpu > 0 ? ops / cpu : 0) << std::endl;
+
+  ioctx.close();
+  rados.shutdown();
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+/*
+ * Measure the throughput of the ETag and checksum computation of concurrent
+ * uploads, with and without multi-buffer hashing.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include "common/ceph_context.h"
+#include "rgw/rgw_hash.h"
+
+int main(int argc, char **argv)
+{
+  int thread_count = 64;
+  size_t buffer_size = 4 << 20;
+  size_t object_size = 4 << 20;
+  int runtime = 10;
+  std::string algorithm;
+  bool multibuffer = true;
+  try
+  {
+    using namespace boost::program_options;
+    options_description desc{"Options"};
+    desc.add_options()
+      ("help,h", "Help screen")
+      ("threads", value<int>()->default_value(64), "number of concurrent uploads")
+      ("buffer_size", value<size_t>()->default_value(4 << 20), "size of each hash update")
+      ("object_size", value<size_t>()->default_value(4 << 20), "size of each upload")
+      ("runtime", value<int>()->default_value(10), "for how many seconds the test will run")
+      ("algorithm", value<std::string>()->default_value("md5"), "md5, sha256 or crc32c")
+      ("multibuffer", value<bool>()->default_value(true), "batch the updates of concurrent uploads");
+    variables_map vm;
+    store(parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << std::endl;
+      return EXIT_SUCCESS;
+    }
+    thread_count = vm["threads"].as<int>();
+    buffer_size = vm["buffer_size"].as<size_t>();
+    object_size = vm["object_size"].as<size_t>();
+    runtime = vm["runtime"].as<int>();
+    algorithm = vm["algorithm"].as<std::string>();
+    multibuffer = vm["multibuffer"].as<bool>();
+  }
+  catch (const boost::program_options::error &ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (algorithm != "md5" && algorithm != "sha256" && algorithm != "crc32c") {
+    std::cerr << "unknown algorithm " << algorithm << std::endl;
+    return EXIT_FAILURE;
+  }
+  buffer_size = std::max<size_t>(1, std::min(buffer_size, object_size));
+
+  std::unique_ptr<CephContext> cct = std::make_unique<CephContext>(CEPH_ENTITY_TYPE_ANY);
+  cct->_conf.set_val_or_die("rgw_multibuffer_hash", multibuffer ? "true" : "false");
+  cct->_conf.apply_changes(nullptr);
+  std::cout << "multi-buffer hashing "
+            << (rgw::hash::multibuffer_enabled(cct.get()) ? "enabled" : "disabled")
+            << std::endl;
+
+  const std::string buffer(buffer_size, 'a');
+  const auto data = reinterpret_cast<const unsigned char*>(buffer.data());
+  std::atomic<bool> stop = false;
+  std::atomic<uint64_t> total_bytes = 0;
+  std::atomic<uint64_t> total_objects = 0;
+
+  auto upload = [&] {
+    uint64_t bytes = 0;
+    uint64_t objects = 0;
+    unsigned char digest[rgw::hash::SHA256::digest_size];
+    while (!stop) {
+      std::optional<rgw::hash::Digest> hash;
+      std::optional<rgw::hash::Checksum> cksum;
+      if (algorithm == "md5") {
+        hash.emplace(cct.get(), rgw::hash::Algorithm::MD5);
+      } else if (algorithm == "sha256") {
+        hash.emplace(cct.get(), rgw::hash::Algorithm::SHA256);
+      } else {
+        cksum.emplace(cct.get(), rgw::hash::Checksum::Type::CRC32C);
+      }
+      for (size_t ofs = 0; ofs < object_size; ofs += buffer_size) {
+        const size_t len = std::min(buffer_size, object_size - ofs);
+        if (hash) {
+          hash->Update(data, len);
+        } else {
+          cksum->update(data, len);
+        }
+        bytes += len;
+      }
+      if (hash) {
+        hash->Final(digest);
+      } else {
+        cksum->final();
+      }
+      ++objects;
+    }
+    total_bytes += bytes;
+    total_objects += objects;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (int i = 0; i < thread_count; i++) {
+    threads.emplace_back(upload);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(runtime));
+  stop = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+  const double elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+  std::cout << algorithm << ": " << thread_count << " uploads of "
+            << object_size << " bytes in updates of " << buffer_size
+            << " bytes: " << total_objects / elapsed << " objects/sec, "
+            << total_bytes / elapsed / (1 << 20) << " MiB/sec" << std::endl;
+  return EXIT_SUCCESS;
+}
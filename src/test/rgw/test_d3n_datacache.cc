@@ -0,0 +1,189 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_d3n_datacache.h"
+#include "global/global_context.h"
+#include "test_rgw_conf.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// the chunks are written through io_uring with a queue depth, or through
+// libaio without one
+class D3nDataCacheTest : public ::testing::TestWithParam<const char*> {
+protected:
+  static constexpr unsigned chunk_size = 64 * 1024;
+  string dir;
+  ConfSaver conf{g_ceph_context->_conf};
+
+  void SetUp() override {
+    char tmpl[] = "/tmp/test_d3n_datacache.XXXXXX";
+    ASSERT_TRUE(mkdtemp(tmpl));
+    dir = tmpl;
+    conf.set_val("rgw_d3n_l1_datacache_persistent_path", dir.c_str());
+    conf.set_val("rgw_d3n_l1_datacache_size", "1048576");
+    conf.set_val("rgw_d3n_io_uring_queue_depth", GetParam());
+  }
+
+  void TearDown() override {
+    fs::remove_all(dir);
+  }
+
+  void put(D3nDataCache& cache, string oid, uint64_t obj_size = 0) {
+    bufferlist bl;
+    bl.append(string(chunk_size, 'a'));
+    cache.put(bl, chunk_size, oid, obj_size);
+  }
+
+  // the writes complete asynchronously
+  bool wait_cached(D3nDataCache& cache, const string& oid) {
+    for (int i = 0; i < 1000; i++) {
+      if (cache.get(oid, chunk_size)) {
+        return true;
+      }
+      this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+  bool wait_removed(const string& oid) {
+    for (int i = 0; i < 1000; i++) {
+      if (!fs::exists(dir + "/" + oid)) {
+        return true;
+      }
+      this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+  void write_file(const string& path, size_t size) {
+    ofstream f(path);
+    f << string(size, 'a');
+  }
+};
+
+TEST_P(D3nDataCacheTest, PutGet)
+{
+  D3nDataCache cache;
+  cache.init(g_ceph_context);
+  put(cache, "chunk");
+  ASSERT_TRUE(wait_cached(cache, "chunk"));
+  ASSERT_EQ(chunk_size, fs::file_size(dir + "/chunk"));
+  // a read of another length misses and drops the chunk
+  ASSERT_FALSE(cache.get("chunk", chunk_size / 2));
+  ASSERT_FALSE(cache.get("chunk", chunk_size));
+}
+
+TEST_P(D3nDataCacheTest, Admission)
+{
+  conf.set_val("rgw_d3n_l1_admission_size_threshold", "1024");
+  conf.set_val("rgw_d3n_l1_admission_history", "3");
+  D3nDataCache cache;
+  cache.init(g_ceph_context);
+
+  // chunks of small objects are cached on their first read
+  put(cache, "small", 1024);
+  ASSERT_TRUE(wait_cached(cache, "small"));
+
+  // and those of large objects on their second one
+  put(cache, "large", 4096);
+  ASSERT_FALSE(cache.get("large", chunk_size));
+  put(cache, "large", 4096);
+  ASSERT_TRUE(wait_cached(cache, "large"));
+
+  // once the chunk is dropped, it's remembered again from its next read on,
+  // and not forgotten when its previous miss expires from the history
+  fs::remove(dir + "/large");
+  ASSERT_FALSE(cache.get("large", chunk_size));
+  put(cache, "large", 4096);
+  put(cache, "other1", 4096);
+  put(cache, "other2", 4096);
+  put(cache, "large", 4096);
+  ASSERT_TRUE(wait_cached(cache, "large"));
+
+  // but it is once more than admission_history misses came after it
+  put(cache, "old", 4096);
+  for (auto oid : {"other3", "other4", "other5"}) {
+    put(cache, oid, 4096);
+  }
+  put(cache, "old", 4096);
+  ASSERT_FALSE(cache.get("old", chunk_size));
+}
+
+TEST_P(D3nDataCacheTest, Evict)
+{
+  D3nDataCache cache;
+  cache.init(g_ceph_context);
+
+  // the 16th chunk fills the cache above its high watermark, and the
+  // oldest chunks are evicted in the background down to the low one
+  for (int i = 0; i < 16; i++) {
+    put(cache, "chunk" + to_string(i));
+    ASSERT_TRUE(wait_cached(cache, "chunk" + to_string(i)));
+  }
+  ASSERT_TRUE(wait_removed("chunk2"));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_FALSE(cache.get("chunk" + to_string(i), chunk_size));
+  }
+  for (int i = 3; i < 16; i++) {
+    ASSERT_TRUE(cache.get("chunk" + to_string(i), chunk_size));
+  }
+
+  // which leaves room for new ones
+  put(cache, "chunk16");
+  ASSERT_TRUE(wait_cached(cache, "chunk16"));
+}
+
+TEST_P(D3nDataCacheTest, LoadIndex)
+{
+  conf.set_val("rgw_d3n_l1_evict_cache_on_start", "false");
+  {
+    D3nDataCache cache;
+    cache.init(g_ceph_context);
+    put(cache, "chunk0");
+    put(cache, "chunk1");
+    ASSERT_TRUE(wait_cached(cache, "chunk0"));
+    ASSERT_TRUE(wait_cached(cache, "chunk1"));
+  }
+  ASSERT_TRUE(fs::exists(dir + "/chunk0"));
+
+  // leftovers of a crash: an empty file, a truncated one, and a write that
+  // never completed
+  write_file(dir + "/empty", 0);
+  write_file(dir + "/truncated", chunk_size / 2);
+  write_file(dir + "/.d3n_writes/partial", chunk_size / 2);
+
+  D3nDataCache cache;
+  cache.init(g_ceph_context);
+  ASSERT_TRUE(cache.get("chunk0", chunk_size));
+  ASSERT_TRUE(cache.get("chunk1", chunk_size));
+  ASSERT_FALSE(fs::exists(dir + "/empty"));
+  ASSERT_FALSE(fs::exists(dir + "/.d3n_writes/partial"));
+  ASSERT_FALSE(cache.get("truncated", chunk_size));
+  ASSERT_FALSE(fs::exists(dir + "/truncated"));
+}
+
+TEST_P(D3nDataCacheTest, EvictOnStart)
+{
+  {
+    D3nDataCache cache;
+    cache.init(g_ceph_context);
+    put(cache, "chunk");
+    ASSERT_TRUE(wait_cached(cache, "chunk"));
+  }
+  write_file(dir + "/stale", chunk_size);
+
+  D3nDataCache cache;
+  cache.init(g_ceph_context);
+  ASSERT_FALSE(cache.get("chunk", chunk_size));
+  ASSERT_FALSE(fs::exists(dir + "/stale"));
+}
+
+INSTANTIATE_TEST_SUITE_P(D3nDataCache, D3nDataCacheTest,
+                         ::testing::Values("0", "128"));
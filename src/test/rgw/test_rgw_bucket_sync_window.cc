@@ -0,0 +1,99 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_data_sync.h"
+#include "global/global_context.h"
+#include "test_rgw_conf.h"
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+class BucketSyncWindowTest : public ::testing::Test {
+protected:
+  ConfSaver conf{g_ceph_context->_conf};
+
+  void SetUp() override {
+    conf.set_val("rgw_bucket_sync_spawn_window", "4");
+    conf.set_val("rgw_bucket_sync_max_spawn_window", "8");
+  }
+
+  // completes a window's worth of fetches
+  void complete(RGWBucketSyncWindow& window, ceph::timespan latency,
+                uint64_t bytes, int r = 0) {
+    for (int64_t i = window.get(); i > 0; i--) {
+      window.complete(latency, bytes, r);
+    }
+  }
+};
+
+TEST_F(BucketSyncWindowTest, SizeClass)
+{
+  ASSERT_EQ(0u, RGWBucketSyncWindow::size_class(0));
+  ASSERT_EQ(0u, RGWBucketSyncWindow::size_class(64 * 1024));
+  ASSERT_EQ(1u, RGWBucketSyncWindow::size_class(64 * 1024 + 1));
+  ASSERT_EQ(1u, RGWBucketSyncWindow::size_class(1024 * 1024));
+  ASSERT_EQ(2u, RGWBucketSyncWindow::size_class(16 * 1024 * 1024));
+  ASSERT_EQ(3u, RGWBucketSyncWindow::size_class(1ull << 40));
+}
+
+TEST_F(BucketSyncWindowTest, Grow)
+{
+  RGWBucketSyncWindow window(g_ceph_context, nullptr);
+  ASSERT_EQ(4, window.get());
+  // the window grows by one per window's worth of fetches, up to the max
+  complete(window, 10ms, 4096);
+  ASSERT_EQ(5, window.get());
+  for (int i = 0; i < 10; i++) {
+    complete(window, 10ms, 4096);
+  }
+  ASSERT_EQ(8, window.get());
+}
+
+TEST_F(BucketSyncWindowTest, MixedSizes)
+{
+  RGWBucketSyncWindow window(g_ceph_context, nullptr);
+  // large objects take longer to fetch than small ones, which isn't
+  // congestion as long as the latency of each size class holds
+  for (int i = 0; i < 4; i++) {
+    for (int64_t j = window.get(); j > 0; j--) {
+      if (j % 2) {
+        window.complete(10ms, 4096, 0);
+      } else {
+        window.complete(500ms, 64 * 1024 * 1024, 0);
+      }
+    }
+  }
+  ASSERT_EQ(8, window.get());
+}
+
+TEST_F(BucketSyncWindowTest, Congestion)
+{
+  RGWBucketSyncWindow window(g_ceph_context, nullptr);
+  for (int i = 0; i < 4; i++) {
+    complete(window, 10ms, 4096);
+  }
+  ASSERT_EQ(8, window.get());
+
+  // the window is halved when the latency of a size class more than doubles,
+  // but not below rgw_bucket_sync_spawn_window
+  complete(window, 100ms, 4096);
+  ASSERT_EQ(4, window.get());
+  complete(window, 100ms, 4096);
+  ASSERT_EQ(4, window.get());
+}
+
+TEST_F(BucketSyncWindowTest, Errors)
+{
+  RGWBucketSyncWindow window(g_ceph_context, nullptr);
+  // errors of the source zone halve the window down to 1
+  complete(window, 10ms, 0, -EBUSY);
+  ASSERT_EQ(2, window.get());
+  complete(window, 10ms, 0, -EIO);
+  ASSERT_EQ(1, window.get());
+  complete(window, 10ms, 0, -ETIMEDOUT);
+  ASSERT_EQ(1, window.get());
+
+  // but not other errors, e.g. of objects that were removed meanwhile
+  complete(window, 10ms, 0, -ENOENT);
+  ASSERT_EQ(2, window.get());
+}
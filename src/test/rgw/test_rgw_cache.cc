@@ -0,0 +1,237 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_cache.h"
+#include "common/dout.h"
+#include "common/perf_counters_collection.h"
+#include "global/global_context.h"
+#include "test_rgw_conf.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+
+using namespace std;
+
+TEST(RGWCacheFrequencySketch, Estimate)
+{
+  RGWCacheFrequencySketch sketch;
+  sketch.init(1000);
+  ASSERT_EQ(0u, sketch.estimate(1));
+
+  for (int i = 0; i < 3; i++) {
+    sketch.increment(1);
+  }
+  // a count-min sketch never underestimates
+  ASSERT_GE(sketch.estimate(1), 3u);
+  ASSERT_LT(sketch.estimate(1), 15u);
+
+  // the counters saturate at 15
+  for (int i = 0; i < 100; i++) {
+    sketch.increment(2);
+  }
+  ASSERT_EQ(15u, sketch.estimate(2));
+}
+
+TEST(RGWCacheFrequencySketch, Aging)
+{
+  RGWCacheFrequencySketch sketch;
+  sketch.init(1000);
+  for (int i = 0; i < 10; i++) {
+    sketch.increment(1);
+  }
+  ASSERT_GE(sketch.estimate(1), 10u);
+
+  // the counters are halved after 10 increments per cache entry
+  for (uint64_t i = 0; i < 10000; i++) {
+    sketch.increment(1000 + i);
+  }
+  ASSERT_LT(sketch.estimate(1), 10u);
+}
+
+class TestChainedCache : public RGWChainedCache {
+public:
+  map<string, int> chained;
+  int invalidated = 0;
+  int invalidated_all = 0;
+
+  void chain_cb(const string& key, void *data) override {
+    chained[key]++;
+  }
+  void invalidate(const string& key) override {
+    chained.erase(key);
+    invalidated++;
+  }
+  void invalidate_all() override {
+    chained.clear();
+    invalidated_all++;
+  }
+};
+
+class ObjectCacheTest : public ::testing::Test {
+protected:
+  NoDoutPrefix dpp{g_ceph_context, ceph_subsys_rgw};
+  ConfSaver conf{g_ceph_context->_conf};
+
+  void SetUp() override {
+    conf.set_val("rgw_cache_shards", "1");
+    conf.set_val("rgw_cache_lru_size", "4");
+    conf.set_val("rgw_cache_admission_filter", "true");
+  }
+
+  void put(ObjectCache& cache, const string& name,
+           rgw_cache_entry_info *cache_info = nullptr) {
+    ObjectCacheInfo info;
+    info.status = 0;
+    info.flags = CACHE_FLAG_DATA;
+    info.data.append(name);
+    cache.put(&dpp, name, info, cache_info);
+  }
+
+  bool get(ObjectCache& cache, const string& name) {
+    return cache.get(&dpp, name).has_value();
+  }
+
+  // number of entries of each shard, from its perf counters
+  map<string, uint64_t> shard_entries() {
+    map<string, uint64_t> entries;
+    g_ceph_context->get_perfcounters_collection()->with_counters(
+      [&entries] (const PerfCountersCollectionImpl::CounterMap& by_path) {
+        for (auto& [path, ref] : by_path) {
+          const string prefix = "rgw_cache_shard.";
+          const string suffix = ".entries";
+          if (path.compare(0, prefix.size(), prefix) == 0 &&
+              path.size() > suffix.size() &&
+              path.compare(path.size() - suffix.size(), suffix.size(),
+                           suffix) == 0) {
+            entries[path] = ref.perf_counters->get(l_rgw_cache_shard_entries);
+          }
+        }
+      });
+    return entries;
+  }
+};
+
+TEST_F(ObjectCacheTest, AdmissionFilter)
+{
+  ObjectCache cache;
+  cache.set_ctx(g_ceph_context);
+  cache.set_enabled(true);
+
+  for (auto name : {"a", "b", "c", "d"}) {
+    put(cache, name);
+  }
+  for (int i = 0; i < 3; i++) {
+    for (auto name : {"a", "b", "c", "d"}) {
+      ASSERT_TRUE(get(cache, name));
+    }
+  }
+
+  // the cache is full, and a key that was never looked up doesn't get to
+  // evict one that was
+  put(cache, "scan");
+  ASSERT_FALSE(get(cache, "scan"));
+  for (auto name : {"a", "b", "c", "d"}) {
+    ASSERT_TRUE(get(cache, name));
+  }
+
+  // a key looked up more often than the LRU entry is admitted
+  for (int i = 0; i < 10; i++) {
+    ASSERT_FALSE(get(cache, "hot"));
+  }
+  put(cache, "hot");
+  ASSERT_TRUE(get(cache, "hot"));
+}
+
+TEST_F(ObjectCacheTest, AdmissionFilterDisabled)
+{
+  conf.set_val("rgw_cache_admission_filter", "false");
+  ObjectCache cache;
+  cache.set_ctx(g_ceph_context);
+  cache.set_enabled(true);
+
+  for (auto name : {"a", "b", "c", "d"}) {
+    put(cache, name);
+    ASSERT_TRUE(get(cache, name));
+  }
+  put(cache, "scan");
+  ASSERT_TRUE(get(cache, "scan"));
+}
+
+TEST_F(ObjectCacheTest, Shards)
+{
+  conf.set_val("rgw_cache_shards", "4");
+  conf.set_val("rgw_cache_lru_size", "400");
+  ObjectCache cache;
+  cache.set_ctx(g_ceph_context);
+  cache.set_enabled(true);
+
+  for (int i = 0; i < 100; i++) {
+    put(cache, "obj" + to_string(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(get(cache, "obj" + to_string(i)));
+  }
+
+  // the entries are spread over all of the shards
+  auto entries = shard_entries();
+  ASSERT_EQ(4u, entries.size());
+  uint64_t total = 0;
+  for (auto& [path, n] : entries) {
+    EXPECT_GT(n, 0u) << path;
+    total += n;
+  }
+  ASSERT_EQ(100u, total);
+
+  cache.invalidate_all();
+  for (auto& [path, n] : shard_entries()) {
+    EXPECT_EQ(0u, n) << path;
+  }
+  ASSERT_FALSE(get(cache, "obj0"));
+}
+
+TEST_F(ObjectCacheTest, ReconfigureShards)
+{
+  conf.set_val("rgw_cache_shards", "4");
+  ObjectCache cache;
+  cache.set_ctx(g_ceph_context);
+  ASSERT_EQ(4u, shard_entries().size());
+
+  // the perf counters of the old shards are unregistered
+  conf.set_val("rgw_cache_shards", "2");
+  cache.set_ctx(g_ceph_context);
+  ASSERT_EQ(2u, shard_entries().size());
+}
+
+TEST_F(ObjectCacheTest, ChainAcrossShards)
+{
+  conf.set_val("rgw_cache_shards", "4");
+  conf.set_val("rgw_cache_lru_size", "400");
+  TestChainedCache chained;
+  ObjectCache cache;
+  cache.set_ctx(g_ceph_context);
+  cache.set_enabled(true);
+  cache.chain_cache(&chained);
+
+  rgw_cache_entry_info info[4];
+  for (int i = 0; i < 4; i++) {
+    put(cache, "obj" + to_string(i), &info[i]);
+  }
+
+  string key = "chained";
+  RGWChainedCache::Entry entry(&chained, key, nullptr);
+  ASSERT_TRUE(cache.chain_cache_entry(&dpp, {&info[0], &info[1], &info[2],
+                                             &info[3]}, &entry));
+  ASSERT_EQ(1, chained.chained[key]);
+
+  // invalidating any of the entries invalidates the chained one
+  ASSERT_TRUE(cache.invalidate_remove(&dpp, "obj2"));
+  ASSERT_EQ(1, chained.invalidated);
+  ASSERT_EQ(0u, chained.chained.count(key));
+
+  // and a stale entry can't be chained anymore
+  ASSERT_FALSE(cache.chain_cache_entry(&dpp, {&info[0], &info[2]}, &entry));
+
+  cache.invalidate_all();
+  ASSERT_EQ(1, chained.invalidated_all);
+  cache.unchain_cache(&chained);
+}
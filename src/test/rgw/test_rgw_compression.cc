@@ -184,3 +184,93 @@ TEST(Compress, BillionZeros)
 
   ASSERT_EQ(d_sink.get_sink().length() , size*1000);
 }
+
+TEST(Compress, Parallel)
+{
+  CompressorRef plugin;
+  ut_put_sink c_sink;
+  plugin = Compressor::create(g_ceph_context, Compressor::COMP_ALG_ZLIB);
+  ASSERT_NE(plugin.get(), nullptr);
+  auto pool = rgw::putobj::TransformPool::get(g_ceph_context);
+  ASSERT_NE(pool, nullptr);
+  RGWPutObj_Compress compressor(g_ceph_context, plugin, &c_sink, pool);
+
+  // distinct chunks, so that reordering would show up in the output
+  constexpr size_t size = 1000000;
+  constexpr int count = 64;
+  bufferlist orig;
+  for (int i = 0; i < count; i++) {
+    bufferlist bl;
+    bl.append(std::string(size, 'a' + i % 26));
+    orig.append(bl);
+    ASSERT_EQ(0, compressor.process(std::move(bl), size*i));
+  }
+  ASSERT_EQ(0, compressor.process({}, size*count)); // flush
+
+  RGWCompressionInfo cs_info;
+  cs_info.compression_type = plugin->get_type_name();
+  cs_info.orig_size = size*count;
+  cs_info.compressor_message = compressor.get_compressor_message();
+  cs_info.blocks = move(compressor.get_compression_blocks());
+  ASSERT_EQ(cs_info.blocks.size(), (size_t)count);
+
+  ut_get_sink d_sink;
+  RGWGetObj_Decompress decompress(g_ceph_context, &cs_info, false, &d_sink);
+
+  off_t f_begin = 0;
+  off_t f_end = size*count - 1;
+  decompress.fixup_range(f_begin, f_end);
+
+  decompress.handle_data(c_sink.get_sink(), 0, c_sink.get_sink().length());
+  bufferlist empty;
+  decompress.handle_data(empty, 0, 0);
+
+  ASSERT_TRUE(d_sink.get_sink().contents_equal(orig));
+}
+
+// fails to compress anything, and counts how often it was asked to
+class ut_incompressible : public Compressor {
+public:
+  std::atomic<int> calls{0};
+  ut_incompressible() : Compressor(COMP_ALG_NONE, "none") {}
+  int compress(const bufferlist &in, bufferlist &out,
+               std::optional<int32_t> &compressor_message) override {
+    ++calls;
+    return -EINVAL;
+  }
+  int decompress(const bufferlist &in, bufferlist &out,
+                 std::optional<int32_t> compressor_message) override {
+    return -EINVAL;
+  }
+  int decompress(bufferlist::const_iterator &p, size_t compressed_len,
+                 bufferlist &out,
+                 std::optional<int32_t> compressor_message) override {
+    return -EINVAL;
+  }
+};
+
+TEST(Compress, ParallelIncompressible)
+{
+  auto plugin = std::make_shared<ut_incompressible>();
+  ut_put_sink c_sink;
+  auto pool = rgw::putobj::TransformPool::get(g_ceph_context);
+  ASSERT_NE(pool, nullptr);
+  RGWPutObj_Compress compressor(g_ceph_context, plugin, &c_sink, pool);
+
+  // once the first part fails to compress, the others are not even tried
+  constexpr size_t size = 100000;
+  constexpr int count = 16;
+  bufferlist orig;
+  for (int i = 0; i < count; i++) {
+    bufferlist bl;
+    bl.append(std::string(size, 'a' + i % 26));
+    orig.append(bl);
+    ASSERT_EQ(0, compressor.process(std::move(bl), size*i));
+  }
+  ASSERT_EQ(0, compressor.process({}, size*count)); // flush
+
+  ASSERT_EQ(1, plugin->calls);
+  ASSERT_FALSE(compressor.is_compressed());
+  ASSERT_TRUE(compressor.get_compression_blocks().empty());
+  ASSERT_TRUE(c_sink.get_sink().contents_equal(orig));
+}
@@ -0,0 +1,34 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <stack>
+#include <string>
+#include <utility>
+#include "common/config_proxy.h"
+
+/* overrides config values for the lifetime of a test fixture, and restores
+ * the previous values when it is destroyed */
+class ConfSaver {
+  ConfigProxy& conf;
+  std::stack<std::pair<std::string, std::string>> saved_settings;
+public:
+  explicit ConfSaver(ConfigProxy& conf) : conf(conf) {}
+  ~ConfSaver() {
+    while (!saved_settings.empty()) {
+      auto& e = saved_settings.top();
+      conf.set_val_or_die(e.first, e.second);
+      saved_settings.pop();
+    }
+    conf.apply_changes(nullptr);
+  }
+
+  void set_val(const std::string& key, const std::string& val) {
+    std::string prev_val;
+    conf.get_val(key, &prev_val);
+    conf.set_val_or_die(key, val);
+    saved_settings.emplace(key, prev_val);
+    conf.apply_changes(nullptr);
+  }
+};
@@ -758,6 +758,46 @@ TEST(TestRGWCrypto, verify_RGWPutObj_BlockEncrypt_chunks)
 }
 
 
+TEST(TestRGWCrypto, verify_RGWPutObj_BlockEncrypt_parallel)
+{
+  const NoDoutPrefix no_dpp(g_ceph_context, dout_subsys);
+  auto pool = rgw::putobj::TransformPool::get(g_ceph_context);
+  ASSERT_NE(pool, nullptr);
+
+  uint8_t key[32];
+  for(size_t i=0;i<sizeof(key);i++)
+    key[i]=i;
+
+  ut_put_sink put_sink;
+  RGWPutObj_BlockEncrypt encrypt(&no_dpp, g_ceph_context, &put_sink,
+                                 AES_256_CBC_create(&no_dpp, g_ceph_context, &key[0], 32),
+                                 pool);
+
+  // chunks of distinct content and sizes that aren't multiples of the
+  // block size, so that reordering or a lost remainder would show up
+  bufferlist input;
+  off_t pos = 0;
+  for (int i = 0; i < 64; i++) {
+    size_t size = 256*1024 + i*1111;
+    bufferlist bl;
+    bl.append(std::string(size, 'a' + i % 26));
+    input.append(bl);
+    ASSERT_EQ(0, encrypt.process(std::move(bl), pos));
+    pos += size;
+  }
+  ASSERT_EQ(0, encrypt.process({}, pos));
+  ASSERT_EQ(put_sink.get_sink().length(), static_cast<size_t>(pos));
+
+  auto cbc = AES_256_CBC_create(&no_dpp, g_ceph_context, &key[0], 32);
+  ASSERT_NE(cbc.get(), nullptr);
+  bufferlist encrypted;
+  bufferlist decrypted;
+  encrypted.append(put_sink.get_sink());
+  ASSERT_TRUE(cbc->decrypt(encrypted, 0, pos, decrypted, 0));
+  ASSERT_TRUE(decrypted.contents_equal(input));
+}
+
+
 TEST(TestRGWCrypto, verify_Encrypt_Decrypt)
 {
   const NoDoutPrefix no_dpp(g_ceph_context, dout_subsys);
@@ -0,0 +1,180 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_gc_batch.h"
+#include "include/rados.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+static const ceph::timespan target = 100ms;
+static const ceph::timespan fast = 10ms;
+static const ceph::timespan slow = 500ms;
+
+TEST(GCIOWindow, NoTargetLatency)
+{
+  RGWGCIOWindow window(8, ceph::timespan::zero());
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_FALSE(window.adjust(slow, true));
+  }
+  EXPECT_EQ(8u, window.size());
+}
+
+TEST(GCIOWindow, ShrinkOnSlowWaitedIO)
+{
+  RGWGCIOWindow window(16, target);
+  // a window's worth of ios has to complete before it shrinks
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_FALSE(window.adjust(slow, true));
+  }
+  EXPECT_TRUE(window.adjust(slow, true));
+  EXPECT_EQ(12u, window.size());
+
+  for (int i = 0; i < 11; ++i) {
+    EXPECT_FALSE(window.adjust(slow, true));
+  }
+  EXPECT_TRUE(window.adjust(slow, true));
+  EXPECT_EQ(9u, window.size());
+}
+
+TEST(GCIOWindow, SlowIOWithoutWait)
+{
+  RGWGCIOWindow window(16, target);
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_FALSE(window.adjust(slow, false));
+  }
+  EXPECT_EQ(16u, window.size());
+}
+
+TEST(GCIOWindow, ShrinkToOne)
+{
+  RGWGCIOWindow window(4, target);
+  for (int i = 0; i < 64; ++i) {
+    window.adjust(slow, true);
+  }
+  EXPECT_EQ(1u, window.size());
+  EXPECT_FALSE(window.adjust(slow, true));
+  EXPECT_EQ(1u, window.size());
+}
+
+TEST(GCIOWindow, GrowUpToMax)
+{
+  RGWGCIOWindow window(4, target);
+  for (int i = 0; i < 64; ++i) {
+    window.adjust(slow, true);
+  }
+  ASSERT_EQ(1u, window.size());
+
+  EXPECT_TRUE(window.adjust(fast, true));
+  EXPECT_EQ(2u, window.size());
+  EXPECT_FALSE(window.adjust(fast, true));
+  EXPECT_TRUE(window.adjust(fast, true));
+  EXPECT_EQ(3u, window.size());
+  for (int i = 0; i < 64; ++i) {
+    window.adjust(fast, true);
+  }
+  EXPECT_EQ(4u, window.size());
+}
+
+TEST(GCPGOrder, BitReversed)
+{
+  EXPECT_EQ(0u, gc_pg_order(0));
+  EXPECT_EQ(0x80000000u, gc_pg_order(1));
+  EXPECT_EQ(1u, gc_pg_order(0x80000000));
+  EXPECT_EQ(0xc0000000u, gc_pg_order(3));
+  EXPECT_EQ(0x48000000u, gc_pg_order(0x12));
+  EXPECT_EQ(0xffffffffu, gc_pg_order(0xffffffff));
+  for (uint32_t hash : {0x1u, 0x12345678u, 0xdeadbeefu, 0x80000001u}) {
+    EXPECT_EQ(hash, gc_pg_order(gc_pg_order(hash)));
+  }
+}
+
+// sorting by gc_pg_order() leaves the hashes of each pg adjacent
+TEST(GCPGOrder, GroupsPGs)
+{
+  std::vector<uint32_t> hashes;
+  uint32_t hash = 12345;
+  for (int i = 0; i < 4096; ++i) {
+    hash = hash * 1103515245 + 12345;
+    hashes.push_back(hash);
+  }
+  std::sort(hashes.begin(), hashes.end(), [] (uint32_t a, uint32_t b) {
+    return gc_pg_order(a) < gc_pg_order(b);
+  });
+
+  for (int pg_num : {1, 2, 8, 12, 32, 100, 256}) {
+    int pg_num_mask = 1;
+    while (pg_num_mask < pg_num) {
+      pg_num_mask <<= 1;
+    }
+    --pg_num_mask;
+
+    std::set<int> seen;
+    int last = -1;
+    for (auto h : hashes) {
+      int pg = ceph_stable_mod(h, pg_num, pg_num_mask);
+      if (pg != last) {
+        EXPECT_TRUE(seen.insert(pg).second) << "pg " << pg << " of "
+                                            << pg_num << " is split";
+        last = pg;
+      }
+    }
+  }
+}
+
+TEST(GCQueueBatch, TrimAtMax)
+{
+  RGWGCQueueBatch batch(250);
+  bool truncated = true;
+  EXPECT_FALSE(batch.add(100, 100, &truncated));
+  EXPECT_FALSE(batch.add(100, 100, &truncated));
+  EXPECT_TRUE(batch.add(100, 100, &truncated));
+  EXPECT_TRUE(truncated);
+  EXPECT_EQ(300u, batch.take());
+  EXPECT_EQ(0u, batch.take());
+}
+
+TEST(GCQueueBatch, TrimAtEndOfQueue)
+{
+  RGWGCQueueBatch batch(1000);
+  bool truncated = true;
+  EXPECT_FALSE(batch.add(100, 100, &truncated));
+  truncated = false;
+  EXPECT_TRUE(batch.add(40, 40, &truncated));
+  EXPECT_EQ(140u, batch.take());
+}
+
+// drive the batch like RGWGC::process() does, running out of time in the
+// middle of a listed page
+TEST(GCQueueBatch, TimeoutMidBatch)
+{
+  const uint32_t page = 100;
+  const uint32_t queue_size = 1000;
+  const uint32_t time_budget = 437; // entries processed before the timeout
+
+  for (uint32_t max_batch : {1u, 7u, 100u, 250u, 1000u, 5000u}) {
+    RGWGCQueueBatch batch(max_batch);
+    uint32_t processed = 0;
+    uint32_t trimmed = 0;
+    uint32_t listed = 0;
+    bool truncated;
+    do {
+      uint32_t num_listed = std::min(page, queue_size - listed);
+      listed += num_listed;
+      truncated = listed < queue_size;
+
+      uint32_t num_entries = std::min(num_listed, time_budget - processed);
+      processed += num_entries;
+
+      if (batch.add(num_entries, num_listed, &truncated)) {
+        trimmed += batch.take();
+      }
+    } while (truncated);
+
+    EXPECT_EQ(time_budget, processed);
+    EXPECT_EQ(processed, trimmed) << "max_batch " << max_batch;
+  }
+}
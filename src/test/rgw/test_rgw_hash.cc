@@ -0,0 +1,190 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab ft=cpp
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spawn/spawn.hpp>
+
+#include "global/global_context.h"
+#include "rgw/rgw_hash.h"
+
+namespace {
+
+template <typename Hash, typename Reference>
+void check_digest(const std::string& data, size_t update_size,
+                  optional_yield y = null_yield)
+{
+  auto in = reinterpret_cast<const unsigned char*>(data.data());
+  Hash hash{g_ceph_context, y};
+  Reference ref;
+  for (size_t ofs = 0; ofs < data.size(); ofs += update_size) {
+    const size_t len = std::min(update_size, data.size() - ofs);
+    hash.Update(in + ofs, len);
+    ref.Update(in + ofs, len);
+  }
+  unsigned char digest[Hash::digest_size];
+  unsigned char expected[Hash::digest_size];
+  hash.Final(digest);
+  ref.Final(expected);
+  ASSERT_EQ(0, memcmp(digest, expected, sizeof(digest)));
+}
+
+} // anonymous namespace
+
+TEST(RGWHash, MD5)
+{
+  for (size_t size : {0, 1, 55, 56, 63, 64, 65, 1000, 100000}) {
+    const std::string data(size, 'x');
+    check_digest<rgw::hash::MD5, ceph::crypto::MD5>(data, 7);
+    check_digest<rgw::hash::MD5, ceph::crypto::MD5>(data, 4096);
+  }
+}
+
+TEST(RGWHash, SHA256)
+{
+  for (size_t size : {0, 1, 55, 56, 63, 64, 65, 1000, 100000}) {
+    const std::string data(size, 'x');
+    check_digest<rgw::hash::SHA256, ceph::crypto::SHA256>(data, 7);
+    check_digest<rgw::hash::SHA256, ceph::crypto::SHA256>(data, 4096);
+  }
+}
+
+TEST(RGWHash, Concurrent)
+{
+  // concurrent streams of different lengths end up in the same batches, or
+  // are hashed alone rather than blocking their thread
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 32; i++) {
+    threads.emplace_back([i] {
+        const std::string data(1000 * i + i, 'a' + i % 26);
+        for (int j = 0; j < 10; j++) {
+          check_digest<rgw::hash::MD5, ceph::crypto::MD5>(data, 512 + i);
+          check_digest<rgw::hash::SHA256, ceph::crypto::SHA256>(data, 512 + i);
+        }
+      });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+TEST(RGWHash, Yielding)
+{
+  // coroutines suspend while their update waits for a batch, so that many
+  // of them share a few threads
+  boost::asio::io_context context;
+  for (int i = 0; i < 32; i++) {
+    spawn::spawn(context, [&context, i] (yield_context yield) {
+        const std::string data(1000 * i + i, 'a' + i % 26);
+        optional_yield y{context, yield};
+        for (int j = 0; j < 10; j++) {
+          check_digest<rgw::hash::MD5, ceph::crypto::MD5>(data, 512 + i, y);
+          check_digest<rgw::hash::SHA256, ceph::crypto::SHA256>(data, 512 + i, y);
+        }
+      });
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&context] { context.run(); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+TEST(RGWHash, Restart)
+{
+  const std::string data(1000, 'x');
+  auto in = reinterpret_cast<const unsigned char*>(data.data());
+  unsigned char digest[rgw::hash::MD5::digest_size];
+  unsigned char expected[rgw::hash::MD5::digest_size];
+
+  rgw::hash::MD5 hash{g_ceph_context};
+  hash.Update(in, 10);
+  hash.Restart();
+  hash.Update(in, data.size());
+  hash.Final(digest);
+
+  ceph::crypto::MD5 ref;
+  ref.Update(in, data.size());
+  ref.Final(expected);
+  ASSERT_EQ(0, memcmp(digest, expected, sizeof(digest)));
+
+  // Final() leaves the digest ready for reuse
+  hash.Update(in, data.size());
+  hash.Final(digest);
+  ASSERT_EQ(0, memcmp(digest, expected, sizeof(digest)));
+}
+
+TEST(RGWHash, Checksum)
+{
+  using rgw::hash::Checksum;
+  ASSERT_EQ(Checksum::Type::CRC32C, Checksum::parse("CRC32C"));
+  ASSERT_EQ(Checksum::Type::SHA256, Checksum::parse("sha256"));
+
+  const std::string data = "123456789";
+  auto in = reinterpret_cast<const unsigned char*>(data.data());
+
+  Checksum crc{g_ceph_context, Checksum::Type::CRC32C};
+  crc.update(in, 4);
+  crc.update(in + 4, data.size() - 4);
+  // crc32c("123456789") = 0xe3069283
+  ASSERT_EQ("4waSgw==", crc.final());
+
+  Checksum sha{g_ceph_context, Checksum::Type::SHA256};
+  sha.update(in, data.size());
+  ASSERT_EQ("FeKw08M4keuw8e9gnsQZQgwg4yDOlMZfvIwzEkSOsiU=", sha.final());
+}
+
+TEST(RGWHash, ChecksumHeaders)
+{
+  using rgw::hash::Checksum;
+  std::map<std::string, std::string, std::less<>> headers;
+  auto get_header = [&headers] (std::string_view name) -> const char* {
+    auto i = headers.find(name);
+    return i == headers.end() ? nullptr : i->second.c_str();
+  };
+  auto pick = [&] (const char *sdk_algorithm,
+                   std::optional<Checksum::Type>* type, const char **value) {
+    *type = std::nullopt;
+    *value = nullptr;
+    return Checksum::from_headers(sdk_algorithm, get_header, type, value);
+  };
+  std::optional<Checksum::Type> type;
+  const char *value;
+
+  ASSERT_TRUE(pick(nullptr, &type, &value));
+  ASSERT_FALSE(type);
+
+  // the checksum is computed, and verified if it's supplied
+  ASSERT_TRUE(pick("SHA256", &type, &value));
+  ASSERT_EQ(Checksum::Type::SHA256, type);
+  ASSERT_EQ(nullptr, value);
+  headers["crc32c"] = "4waSgw==";
+  ASSERT_TRUE(pick(nullptr, &type, &value));
+  ASSERT_EQ(Checksum::Type::CRC32C, type);
+  ASSERT_STREQ("4waSgw==", value);
+  ASSERT_TRUE(pick("crc32c", &type, &value));
+  ASSERT_EQ(Checksum::Type::CRC32C, type);
+
+  // algorithms that aren't supported are ignored rather than refused
+  headers.clear();
+  headers["crc32"] = "yZRlqg==";
+  for (auto alg : {"CRC32", "SHA1", "CRC64NVME"}) {
+    ASSERT_TRUE(pick(alg, &type, &value)) << alg;
+    ASSERT_FALSE(type) << alg;
+    ASSERT_EQ(nullptr, value) << alg;
+  }
+
+  // but the supported ones must agree
+  headers["crc32c"] = "4waSgw==";
+  ASSERT_FALSE(pick("SHA256", &type, &value));
+  headers["sha256"] = "FeKw08M4keuw8e9gnsQZQgwg4yDOlMZfvIwzEkSOsiU=";
+  ASSERT_FALSE(pick(nullptr, &type, &value));
+}
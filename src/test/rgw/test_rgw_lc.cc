@@ -4,8 +4,10 @@
 #include "rgw_xml.h"
 #include "rgw_lc.h"
 #include "rgw_lc_s3.h"
+#include "rgw_sal_store.h"
 #include <gtest/gtest.h>
 //#include <spawn/spawn.hpp>
+#include <map>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -107,3 +109,145 @@ TEST(TestLCFilterInvalidAnd, XMLDoc3)
   /* check our flags */
   ASSERT_EQ(filter.get_flags(), uint32_t(LCFlagType::none));
 }
+
+/* keeps the lc entries in memory */
+class TestLifecycle : public rgw::sal::StoreLifecycle {
+public:
+  std::map<std::string, std::map<std::string, StoreLCEntry>> objs;
+
+  struct Serializer : public rgw::sal::LCSerializer {
+    int try_lock(const DoutPrefixProvider*, utime_t, optional_yield) override {
+      return 0;
+    }
+    int unlock() override { return 0; }
+    void print(std::ostream& out) const override { out << "test"; }
+  };
+
+  using StoreLifecycle::get_entry;
+  int get_entry(const std::string& oid, const std::string& marker,
+		std::unique_ptr<LCEntry>* entry) override {
+    auto& entries = objs[oid];
+    auto i = entries.find(marker);
+    if (i == entries.end()) {
+      return -ENOENT;
+    }
+    *entry = std::make_unique<StoreLCEntry>(i->second);
+    return 0;
+  }
+  int get_next_entry(const std::string& oid, const std::string& marker,
+		     std::unique_ptr<LCEntry>* entry) override {
+    auto& entries = objs[oid];
+    auto i = entries.upper_bound(marker);
+    if (i == entries.end()) {
+      return -ENOENT;
+    }
+    *entry = std::make_unique<StoreLCEntry>(i->second);
+    return 0;
+  }
+  int set_entry(const std::string& oid, LCEntry& entry) override {
+    objs[oid][entry.get_bucket()] = entry;
+    return 0;
+  }
+  int list_entries(const std::string& oid, const std::string& marker,
+		   uint32_t max_entries,
+		   std::vector<std::unique_ptr<LCEntry>>& entries) override {
+    entries.clear();
+    auto& all = objs[oid];
+    for (auto i = all.upper_bound(marker);
+	 i != all.end() && entries.size() < max_entries; ++i) {
+      entries.push_back(std::make_unique<StoreLCEntry>(i->second));
+    }
+    return 0;
+  }
+  int rm_entry(const std::string& oid, LCEntry& entry) override {
+    return objs[oid].erase(entry.get_bucket()) ? 0 : -ENOENT;
+  }
+  int get_head(const std::string& oid, std::unique_ptr<LCHead>* head) override {
+    return -ENOENT;
+  }
+  int put_head(const std::string& oid, LCHead& head) override {
+    return 0;
+  }
+  std::unique_ptr<rgw::sal::LCSerializer> get_serializer(
+    const std::string& lock_name, const std::string& oid,
+    const std::string& cookie) override {
+    return std::make_unique<Serializer>();
+  }
+};
+
+TEST(TestLCShardClaims, Claim)
+{
+  TestLifecycle lc;
+  LCShardClaims worker1(nullptr, &lc, "lc.0", "marker", 100, 3600, "w1");
+  LCShardClaims worker2(nullptr, &lc, "lc.0", "marker", 100, 3600, "w2");
+
+  ASSERT_EQ(0, worker1.claim(0));
+  ASSERT_EQ(-EBUSY, worker2.claim(0));
+  ASSERT_EQ(0, worker2.claim(1));
+
+  int done, claimed;
+  ASSERT_EQ(0, worker1.count(&done, &claimed));
+  ASSERT_EQ(0, done);
+  ASSERT_EQ(2, claimed);
+
+  // a shard that is done isn't processed again in the same session
+  ASSERT_EQ(0, worker1.complete(0));
+  ASSERT_EQ(-EBUSY, worker2.claim(0));
+  ASSERT_EQ(0, worker1.count(&done, &claimed));
+  ASSERT_EQ(1, done);
+  ASSERT_EQ(1, claimed);
+
+  // a worker that stops early gives its shards back
+  ASSERT_EQ(0, worker2.release(1));
+  ASSERT_EQ(0, worker1.count(&done, &claimed));
+  ASSERT_EQ(1, done);
+  ASSERT_EQ(0, claimed);
+  ASSERT_EQ(0, worker1.claim(1));
+
+  // the claims of a session don't hold the next one back
+  LCShardClaims next(nullptr, &lc, "lc.0", "marker", 200, 3600, "w1");
+  ASSERT_EQ(0, next.claim(0));
+  ASSERT_EQ(0, next.claim(1));
+}
+
+TEST(TestLCShardClaims, Abandoned)
+{
+  TestLifecycle lc;
+  LCShardClaims worker1(nullptr, &lc, "lc.0", "marker", 100, 3600, "w1");
+  LCShardClaims worker2(nullptr, &lc, "lc.0", "marker", 100, 3600, "w2");
+  ASSERT_EQ(0, worker1.claim(0));
+  ASSERT_EQ(0, worker1.claim(1));
+  ASSERT_EQ(0, worker1.complete(1));
+
+  // the claims of a worker that went away expire, but not the shards it
+  // finished
+  for (auto& [key, entry] : lc.objs["lc.0.shards"]) {
+    entry.start_time = time(nullptr) - 7200;
+  }
+  int done, claimed;
+  ASSERT_EQ(0, worker2.count(&done, &claimed));
+  ASSERT_EQ(1, done);
+  ASSERT_EQ(0, claimed);
+  ASSERT_EQ(0, worker2.claim(0));
+  ASSERT_EQ(-EBUSY, worker2.claim(1));
+}
+
+TEST(TestLCShardClaims, Clear)
+{
+  TestLifecycle lc;
+  LCShardClaims session1(nullptr, &lc, "lc.0", "marker", 100, 3600, "w1");
+  LCShardClaims session2(nullptr, &lc, "lc.0", "marker", 200, 3600, "w1");
+  LCShardClaims other(nullptr, &lc, "lc.0", "marker2", 100, 3600, "w1");
+  for (int shard = 0; shard < 150; shard++) {
+    ASSERT_EQ(0, session1.complete(shard));
+  }
+  ASSERT_EQ(0, session2.claim(0));
+  ASSERT_EQ(0, other.claim(0));
+
+  // the claims of all the sessions of the bucket are removed, and only them
+  ASSERT_EQ(0, session2.clear());
+  ASSERT_EQ(1u, lc.objs["lc.0.shards"].size());
+  int done, claimed;
+  ASSERT_EQ(0, other.count(&done, &claimed));
+  ASSERT_EQ(1, claimed);
+}
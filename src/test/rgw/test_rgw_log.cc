@@ -0,0 +1,179 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_log.h"
+#include "global/global_context.h"
+#include "test_rgw_conf.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// an ops log sink whose appends are recorded by the test
+class TestOpsLogRados : public OpsLogRados {
+public:
+  struct Write {
+    string oid;
+    bufferlist bl;
+  };
+
+  explicit TestOpsLogRados(vector<Write>& writes)
+    : OpsLogRados(g_ceph_context,
+                  [&writes] (const DoutPrefixProvider *dpp, const string& oid,
+                             bufferlist& bl) {
+                    writes.push_back(Write{oid, bl});
+                    return 0;
+                  }) {}
+};
+
+class OpsLogRadosTest : public ::testing::Test {
+protected:
+  ConfSaver conf{g_ceph_context->_conf};
+  RGWEnv env;
+  req_state s{g_ceph_context, &env, 0};
+  const rgw_log_entry::Clock::time_point now = rgw_log_entry::Clock::now();
+  vector<TestOpsLogRados::Write> writes;
+
+  void SetUp() override {
+    conf.set_val("rgw_ops_log_rados", "true");
+    conf.set_val("rgw_ops_log_rados_batch_size", "1048576");
+    conf.set_val("rgw_ops_log_rados_batch_interval_ms", "3600000");
+  }
+
+  rgw_log_entry make_entry(const string& bucket, const string& uri) {
+    rgw_log_entry entry;
+    entry.bucket = bucket;
+    entry.bucket_id = bucket + ".id";
+    entry.time = now;
+    entry.op = "get_obj";
+    entry.uri = uri;
+    entry.http_status = "200";
+    entry.identity_type = 0;
+    return entry;
+  }
+
+  void log(OpsLogRados& sink, const string& bucket, const string& uri) {
+    auto entry = make_entry(bucket, uri);
+    ASSERT_EQ(0, sink.log(&s, entry));
+  }
+
+  // decodes the appended entries the way radosgw-admin log show does
+  vector<rgw_log_entry> decode_entries(const bufferlist& bl) {
+    vector<rgw_log_entry> entries;
+    auto p = bl.cbegin();
+    while (!p.end()) {
+      rgw_log_entry entry;
+      decode(entry, p);
+      entries.push_back(std::move(entry));
+    }
+    return entries;
+  }
+};
+
+TEST_F(OpsLogRadosTest, BatchReadsBackAsEntries)
+{
+  {
+    TestOpsLogRados sink(writes);
+    for (int i = 0; i < 5; i++) {
+      log(sink, "bucket", "/bucket/obj" + to_string(i));
+    }
+    ASSERT_TRUE(writes.empty());
+  }
+
+  ASSERT_EQ(1u, writes.size());
+  auto entries = decode_entries(writes[0].bl);
+  ASSERT_EQ(5u, entries.size());
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ("bucket", entries[i].bucket);
+    EXPECT_EQ("bucket.id", entries[i].bucket_id);
+    EXPECT_EQ("/bucket/obj" + to_string(i), entries[i].uri);
+    EXPECT_EQ("get_obj", entries[i].op);
+    EXPECT_EQ("200", entries[i].http_status);
+    EXPECT_EQ(now, entries[i].time);
+  }
+}
+
+TEST_F(OpsLogRadosTest, SizeTrigger)
+{
+  bufferlist bl;
+  encode(make_entry("bucket", "/bucket/obj0"), bl);
+  conf.set_val("rgw_ops_log_rados_batch_size", to_string(3 * bl.length()));
+
+  TestOpsLogRados sink(writes);
+  log(sink, "bucket", "/bucket/obj0");
+  log(sink, "bucket", "/bucket/obj1");
+  ASSERT_TRUE(writes.empty());
+  log(sink, "bucket", "/bucket/obj2");
+  ASSERT_EQ(1u, writes.size());
+  ASSERT_EQ(3u, decode_entries(writes[0].bl).size());
+
+  // the next batch starts empty
+  log(sink, "bucket", "/bucket/obj3");
+  ASSERT_EQ(1u, writes.size());
+}
+
+TEST_F(OpsLogRadosTest, IntervalTrigger)
+{
+  conf.set_val("rgw_ops_log_rados_batch_interval_ms", "50");
+
+  TestOpsLogRados sink(writes);
+  log(sink, "bucket", "/bucket/obj0");
+  ASSERT_TRUE(writes.empty());
+
+  // the batch is written by the first request after the interval
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_TRUE(writes.empty());
+  log(sink, "bucket", "/bucket/obj1");
+  ASSERT_EQ(1u, writes.size());
+  auto entries = decode_entries(writes[0].bl);
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ("/bucket/obj0", entries[0].uri);
+  EXPECT_EQ("/bucket/obj1", entries[1].uri);
+}
+
+TEST_F(OpsLogRadosTest, DestructorFlush)
+{
+  {
+    TestOpsLogRados sink(writes);
+    log(sink, "bucket1", "/bucket1/obj0");
+    log(sink, "bucket2", "/bucket2/obj0");
+    log(sink, "bucket1", "/bucket1/obj1");
+    ASSERT_TRUE(writes.empty());
+  }
+
+  // one append per log object
+  ASSERT_EQ(2u, writes.size());
+  map<string, vector<rgw_log_entry>> by_oid;
+  for (auto& w : writes) {
+    by_oid[w.oid] = decode_entries(w.bl);
+  }
+  ASSERT_EQ(2u, by_oid.size());
+  size_t total = 0;
+  for (auto& [oid, entries] : by_oid) {
+    ASSERT_FALSE(entries.empty());
+    for (auto& e : entries) {
+      EXPECT_EQ(entries[0].bucket, e.bucket);
+    }
+    total += entries.size();
+  }
+  EXPECT_EQ(3u, total);
+}
+
+TEST_F(OpsLogRadosTest, Unbatched)
+{
+  conf.set_val("rgw_ops_log_rados_batch_size", "0");
+
+  {
+    TestOpsLogRados sink(writes);
+    log(sink, "bucket", "/bucket/obj0");
+    ASSERT_EQ(1u, writes.size());
+    log(sink, "bucket", "/bucket/obj1");
+    ASSERT_EQ(2u, writes.size());
+  }
+  ASSERT_EQ(2u, writes.size());
+  ASSERT_EQ(1u, decode_entries(writes[0].bl).size());
+}
@@ -0,0 +1,219 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_quota_cache.h"
+#include "common/dout.h"
+#include "global/global_context.h"
+#include "test_rgw_conf.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace std;
+
+// a bucket stats cache whose refreshes are completed by the test
+class TestStatsCache : public RGWQuotaCache<rgw_bucket> {
+public:
+  class Handler : public AsyncRefreshHandler {
+    TestStatsCache *test_cache;
+  public:
+    rgw_bucket bucket;
+    Handler(TestStatsCache *cache, const rgw_bucket& bucket)
+      : AsyncRefreshHandler(nullptr, cache), test_cache(cache), bucket(bucket) {}
+
+    int init_fetch() override {
+      if (test_cache->init_fetch_ret < 0) {
+        return test_cache->init_fetch_ret;
+      }
+      test_cache->pending.push_back(this);
+      return 0;
+    }
+    void drop_reference() override { delete this; }
+  };
+
+  RGWStorageStats storage_stats;
+  int fetches = 0;
+  int init_fetch_ret = 0;
+  vector<Handler*> pending;
+
+  TestStatsCache() : RGWQuotaCache<rgw_bucket>(nullptr, g_ceph_context, 16) {}
+
+  ~TestStatsCache() override {
+    for (auto h : pending) {
+      fail(h);
+    }
+  }
+
+  void add(const rgw_bucket& bucket, uint64_t num_objects,
+           int expired_sec, int refresh_sec) {
+    RGWQuotaCacheStats qs;
+    qs.stats.num_objects = num_objects;
+    qs.expiration = ceph_clock_now();
+    qs.expiration -= expired_sec;
+    qs.async_refresh_time = ceph_clock_now();
+    qs.async_refresh_time -= refresh_sec;
+    map_add(rgw_user(), bucket, qs);
+  }
+
+  // the time the next async refresh is due
+  utime_t refresh_time(const rgw_bucket& bucket) {
+    RGWQuotaCacheStats qs;
+    EXPECT_TRUE(stats_map.find(bucket, qs));
+    return qs.async_refresh_time;
+  }
+
+  // makes the next async refresh due sec seconds earlier
+  void advance_refresh(const rgw_bucket& bucket, int sec) {
+    RGWQuotaCacheStats qs;
+    ASSERT_TRUE(stats_map.find(bucket, qs));
+    qs.async_refresh_time -= sec;
+    stats_map.add(bucket, qs);
+  }
+
+  uint64_t get(const rgw_bucket& bucket) {
+    NoDoutPrefix dpp{g_ceph_context, ceph_subsys_rgw};
+    RGWStorageStats stats;
+    EXPECT_EQ(0, get_stats(rgw_user(), bucket, stats, null_yield, &dpp));
+    return stats.num_objects;
+  }
+
+  Handler *take() {
+    if (pending.empty()) {
+      return nullptr;
+    }
+    auto h = pending.front();
+    pending.erase(pending.begin());
+    return h;
+  }
+
+  void complete(Handler *h, uint64_t num_objects) {
+    RGWStorageStats stats;
+    stats.num_objects = num_objects;
+    async_refresh_response(rgw_user(), h->bucket, stats);
+    h->drop_reference();
+  }
+
+  void fail(Handler *h) {
+    async_refresh_fail(rgw_user(), h->bucket);
+    h->drop_reference();
+  }
+
+protected:
+  bool map_find(const rgw_user& user, const rgw_bucket& bucket, RGWQuotaCacheStats& qs) override {
+    return stats_map.find(bucket, qs);
+  }
+  bool map_find_and_update(const rgw_user& user, const rgw_bucket& bucket, lru_map<rgw_bucket, RGWQuotaCacheStats>::UpdateContext *ctx) override {
+    return stats_map.find_and_update(bucket, NULL, ctx);
+  }
+  void map_add(const rgw_user& user, const rgw_bucket& bucket, RGWQuotaCacheStats& qs) override {
+    stats_map.add(bucket, qs);
+  }
+  int fetch_stats_from_storage(const rgw_user& user, const rgw_bucket& bucket, RGWStorageStats& stats, optional_yield y, const DoutPrefixProvider *dpp) override {
+    fetches++;
+    stats = storage_stats;
+    return 0;
+  }
+  AsyncRefreshHandler *allocate_refresh_handler(const rgw_user& user, const rgw_bucket& bucket) override {
+    return new Handler(this, bucket);
+  }
+};
+
+class QuotaCacheTest : public ::testing::Test {
+protected:
+  rgw_bucket bucket{"", "bucket", "id"};
+  ConfSaver conf{g_ceph_context->_conf};
+
+  void SetUp() override {
+    conf.set_val("rgw_bucket_quota_ttl", "600");
+    conf.set_val("rgw_bucket_quota_stale_ttl", "60");
+  }
+};
+
+TEST_F(QuotaCacheTest, Fresh)
+{
+  TestStatsCache cache;
+  cache.add(bucket, 5, -600, -300);
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_EQ(0, cache.fetches);
+  ASSERT_TRUE(cache.pending.empty());
+}
+
+TEST_F(QuotaCacheTest, StaleServedWhileRefreshed)
+{
+  TestStatsCache cache;
+  cache.add(bucket, 5, 10, 310);
+
+  // the expired stats are served, and refreshed once in the background
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_EQ(0, cache.fetches);
+  ASSERT_EQ(1u, cache.pending.size());
+
+  cache.complete(cache.take(), 7);
+  ASSERT_EQ(7u, cache.get(bucket));
+  ASSERT_EQ(0, cache.fetches);
+  ASSERT_TRUE(cache.pending.empty());
+}
+
+TEST_F(QuotaCacheTest, FailedRefreshRetried)
+{
+  TestStatsCache cache;
+  cache.add(bucket, 5, 10, 310);
+  ASSERT_EQ(5u, cache.get(bucket));
+  utime_t failed = ceph_clock_now();
+  cache.fail(cache.take());
+
+  // the refresh is retried after a quarter of rgw_bucket_quota_ttl
+  utime_t retry = cache.refresh_time(bucket);
+  ASSERT_GE(retry.sec(), failed.sec() + 150);
+  ASSERT_LE(retry.sec(), ceph_clock_now().sec() + 150);
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_TRUE(cache.pending.empty());
+
+  // the first check after the backoff starts another refresh, while still
+  // serving the stats
+  cache.advance_refresh(bucket, 150);
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_EQ(1u, cache.pending.size());
+  cache.complete(cache.take(), 7);
+  ASSERT_EQ(7u, cache.get(bucket));
+  ASSERT_EQ(0, cache.fetches);
+}
+
+TEST_F(QuotaCacheTest, FailedRefreshStartRetried)
+{
+  TestStatsCache cache;
+  cache.add(bucket, 5, 10, 310);
+  cache.init_fetch_ret = -EIO;
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_TRUE(cache.pending.empty());
+
+  cache.init_fetch_ret = 0;
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_TRUE(cache.pending.empty());
+
+  cache.advance_refresh(bucket, 150);
+  ASSERT_EQ(5u, cache.get(bucket));
+  ASSERT_EQ(1u, cache.pending.size());
+  ASSERT_EQ(0, cache.fetches);
+}
+
+TEST_F(QuotaCacheTest, StaleTTLElapsed)
+{
+  TestStatsCache cache;
+  cache.storage_stats.num_objects = 7;
+  cache.add(bucket, 5, 120, 420);
+
+  // the stats are read on the request path past rgw_bucket_quota_stale_ttl
+  ASSERT_EQ(7u, cache.get(bucket));
+  ASSERT_EQ(1, cache.fetches);
+}
+
+TEST_F(QuotaCacheTest, StaleDisabled)
+{
+  conf.set_val("rgw_bucket_quota_stale_ttl", "0");
+  TestStatsCache cache;
+  cache.storage_stats.num_objects = 7;
+  cache.add(bucket, 5, 10, 310);
+  ASSERT_EQ(7u, cache.get(bucket));
+  ASSERT_EQ(1, cache.fetches);
+}
@@ -0,0 +1,131 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_aio.h"
+#include "rgw_aio_throttle.h"
+#include <spawn/spawn.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace std;
+
+namespace rgw {
+
+// a coalescer whose reads are completed by the test
+class TestReadCoalescer : public ReadCoalescer {
+public:
+  using ReadCoalescer::Key;
+  using ReadCoalescer::finish;
+
+  vector<Key> sent;
+  int send_ret = 0;
+
+protected:
+  int send_read(RGWSI_RADOS::Obj& obj, const Key& key) override {
+    if (send_ret < 0) {
+      return send_ret;
+    }
+    sent.push_back(key);
+    return 0;
+  }
+};
+
+class ReadCoalescerTest : public ::testing::Test {
+protected:
+  RGWSI_RADOS::Obj obj;
+  rgw_raw_obj raw_obj{rgw_pool{"pool"}, "tail"};
+  TestReadCoalescer coalescer;
+
+  bufferlist data(const char *s) {
+    bufferlist bl;
+    bl.append(s);
+    return bl;
+  }
+};
+
+TEST_F(ReadCoalescerTest, Coalesce)
+{
+  BlockingAioThrottle t1(4), t2(4), t3(4);
+  ASSERT_TRUE(t1.get(obj, coalescer.read_op(raw_obj, 0, 4, null_yield), 1, 1).empty());
+  ASSERT_TRUE(t2.get(obj, coalescer.read_op(raw_obj, 0, 4, null_yield), 1, 2).empty());
+  // another range is read separately
+  ASSERT_TRUE(t3.get(obj, coalescer.read_op(raw_obj, 4, 4, null_yield), 1, 3).empty());
+  ASSERT_EQ(2u, coalescer.sent.size());
+
+  coalescer.finish({raw_obj, 0, 4}, 0, data("abcd"));
+  for (auto t : {&t1, &t2}) {
+    auto completed = t->drain();
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_EQ(0, completed.front().result);
+    EXPECT_EQ("abcd", completed.front().data.to_str());
+  }
+
+  // the data isn't kept once the read finished
+  ASSERT_TRUE(t1.get(obj, coalescer.read_op(raw_obj, 0, 4, null_yield), 1, 1).empty());
+  ASSERT_EQ(3u, coalescer.sent.size());
+  coalescer.finish({raw_obj, 0, 4}, 0, data("efgh"));
+  coalescer.finish({raw_obj, 4, 4}, 0, data("ijkl"));
+  EXPECT_EQ("efgh", t1.drain().front().data.to_str());
+  EXPECT_EQ("ijkl", t3.drain().front().data.to_str());
+}
+
+TEST_F(ReadCoalescerTest, ShareError)
+{
+  BlockingAioThrottle t1(4), t2(4);
+  t1.get(obj, coalescer.read_op(raw_obj, 0, 4, null_yield), 1, 1);
+  t2.get(obj, coalescer.read_op(raw_obj, 0, 4, null_yield), 1, 2);
+  ASSERT_EQ(1u, coalescer.sent.size());
+
+  coalescer.finish({raw_obj, 0, 4}, -EIO, {});
+  for (auto t : {&t1, &t2}) {
+    auto completed = t->drain();
+    ASSERT_EQ(1u, completed.size());
+    EXPECT_EQ(-EIO, completed.front().result);
+  }
+}
+
+TEST_F(ReadCoalescerTest, SendError)
+{
+  BlockingAioThrottle t1(4), t2(4);
+  coalescer.send_ret = -ENOENT;
+  auto completed = t1.get(obj, coalescer.read_op(raw_obj, 0, 4, null_yield), 1, 1);
+  completed.splice(completed.end(), t1.drain());
+  ASSERT_EQ(1u, completed.size());
+  EXPECT_EQ(-ENOENT, completed.front().result);
+
+  // the failed read doesn't hold up the next one
+  coalescer.send_ret = 0;
+  t2.get(obj, coalescer.read_op(raw_obj, 0, 4, null_yield), 1, 2);
+  ASSERT_EQ(1u, coalescer.sent.size());
+  coalescer.finish({raw_obj, 0, 4}, 0, data("abcd"));
+  EXPECT_EQ("abcd", t2.drain().front().data.to_str());
+}
+
+TEST_F(ReadCoalescerTest, Yield)
+{
+  boost::asio::io_context context;
+  vector<string> results;
+  for (int i = 0; i < 2; i++) {
+    spawn::spawn(context,
+      [&] (yield_context yield) {
+        YieldingAioThrottle throttle(4, context, yield);
+        optional_yield y{context, yield};
+        throttle.get(obj, coalescer.read_op(raw_obj, 0, 4, y), 1, 0);
+        auto completed = throttle.drain();
+        ASSERT_EQ(1u, completed.size());
+        EXPECT_EQ(0, completed.front().result);
+        results.push_back(completed.front().data.to_str());
+      });
+  }
+  context.poll(); // run until both coroutines wait on the read
+  ASSERT_EQ(1u, coalescer.sent.size());
+  ASSERT_TRUE(results.empty());
+
+  // the results are posted to the coroutines
+  coalescer.finish({raw_obj, 0, 4}, 0, data("abcd"));
+  ASSERT_TRUE(results.empty());
+  context.run();
+  EXPECT_EQ((vector<string>{"abcd", "abcd"}), results);
+}
+
+} // namespace rgw
@@ -0,0 +1,51 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "rgw_s3select.h"
+#include <gtest/gtest.h>
+
+using rgw::s3select::parquet_read_extent;
+using extent = std::pair<int64_t, int64_t>;
+
+static constexpr int64_t min_read = 128 * 1024;
+static constexpr int64_t obj_size = 1024 * 1024;
+
+TEST(ParquetReadExtent, Forward)
+{
+  // the magic at the start of the object
+  ASSERT_EQ(extent(0, min_read), parquet_read_extent(0, 4, obj_size, min_read));
+  ASSERT_EQ(extent(4096, min_read),
+            parquet_read_extent(4096, 100, obj_size, min_read));
+  // long reads are not extended
+  ASSERT_EQ(extent(4096, min_read * 2),
+            parquet_read_extent(4096, min_read * 2, obj_size, min_read));
+  ASSERT_EQ(extent(4096, 100), parquet_read_extent(4096, 100, obj_size, 0));
+}
+
+TEST(ParquetReadExtent, Tail)
+{
+  // the footer length and the magic are the last 8 bytes, and the fetched
+  // extent ends at the end of the object
+  const auto [ofs, len] = parquet_read_extent(obj_size - 8, 8, obj_size,
+                                              min_read);
+  ASSERT_EQ(obj_size - min_read, ofs);
+  ASSERT_EQ(min_read, len);
+
+  // so that the footer before them is within it
+  const int64_t footer_len = 16 * 1024;
+  const int64_t footer_ofs = obj_size - 8 - footer_len;
+  ASSERT_GE(footer_ofs, ofs);
+  ASSERT_LE(footer_ofs + footer_len, ofs + len);
+
+  // a read that would run past the end is moved back as well
+  ASSERT_EQ(extent(obj_size - min_read, min_read),
+            parquet_read_extent(obj_size - min_read / 2, 100, obj_size,
+                                min_read));
+}
+
+TEST(ParquetReadExtent, SmallObject)
+{
+  // objects smaller than min_read are fetched whole
+  ASSERT_EQ(extent(0, 1000), parquet_read_extent(992, 8, 1000, min_read));
+  ASSERT_EQ(extent(0, 1000), parquet_read_extent(0, 4, 1000, min_read));
+}
@@ -1,3 +1,5 @@
+#include <sys/uio.h>
+
 #include "gtest/gtest.h"
 #include "global/global_context.h"
 
@@ -54,6 +56,31 @@ TEST(Striper, EmptyPartialResult)
   ASSERT_EQ(65536u, outbl.length());
 }
 
+TEST(Striper, AssembleResultIovec)
+{
+  Striper::StripedReadResult r;
+
+  // 0~4: data, 4~4: short read (hole at the end), 8~4: no data
+  bufferlist bl1;
+  bl1.append("abcd");
+  r.add_partial_result(g_ceph_context, std::move(bl1), {{0, 4}});
+  bufferlist bl2;
+  bl2.append("ef");
+  r.add_partial_result(g_ceph_context, std::move(bl2), {{4, 4}});
+  bufferlist bl3;
+  r.add_partial_result(g_ceph_context, std::move(bl3), {{8, 4}});
+
+  char buf1[3], buf2[9];
+  memset(buf1, 'x', sizeof(buf1));
+  memset(buf2, 'x', sizeof(buf2));
+  struct iovec iov[3] = {{buf1, sizeof(buf1)}, {nullptr, 0},
+                         {buf2, sizeof(buf2)}};
+  r.assemble_result(g_ceph_context, iov, 3);
+
+  ASSERT_EQ(0, memcmp(buf1, "abc", 3));
+  ASSERT_EQ(0, memcmp(buf2, "def\0\0\0\0\0\0", 9));
+}
+
 TEST(Striper, GetNumObj)
 {
   file_layout_t l;